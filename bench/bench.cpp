@@ -0,0 +1,300 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file bench.cpp
+ *
+ * @brief Contains the implementation of the BenchRecord class and the
+ * benchmark helpers.
+ *
+ * This file contains the implementation of the BenchRecord class and the
+ * helpers shared by the benchmarks.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+#include "bench.hpp"
+
+using std::string;
+
+/**
+ * This function returns the time of the monotonic clock in nanoseconds.
+ *
+ * @return The current time in nanoseconds.
+ */
+std::uint64_t bench_now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+/**
+ * This function reads a file into a string.
+ *
+ * @param[in] path The path of the file.
+ *
+ * @param[out] content The content of the file.
+ *
+ * @return @c true on success, @c false if the file cannot be read.
+ */
+bool bench_read_file(const char *path, string &content)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		fprintf(stderr, "Could not read %s\n", path);
+		return false;
+	}
+	std::ostringstream oss;
+	oss << file.rdbuf();
+	content = oss.str();
+	return true;
+}
+
+/**
+ * This function splits text into lines. The newlines are removed, empty lines
+ * are skipped.
+ *
+ * @param[in] text The text.
+ *
+ * @return The lines.
+ */
+std::vector<string> bench_split_lines(const string &text)
+{
+	std::vector<string> lines;
+	std::istringstream iss(text);
+	string line;
+	while (std::getline(iss, line))
+	{
+		if (!line.empty())
+		{
+			lines.push_back(line);
+		}
+	}
+	return lines;
+}
+
+/**
+ * This function returns the name of a file without directory and extension,
+ * which is used to name the results of a transcript.
+ *
+ * @param[in] path The path of the file.
+ *
+ * @return The name of the file.
+ */
+string bench_basename(const char *path)
+{
+	string name = path;
+	const size_t slash = name.rfind('/');
+	if (string::npos != slash)
+	{
+		name.erase(0, slash + 1);
+	}
+	const size_t dot = name.rfind('.');
+	if (string::npos != dot && 0 != dot)
+	{
+		name.erase(dot);
+	}
+	return name;
+}
+
+/**
+ * This function appends a list of parsed results as text to a string.
+ *
+ * @param[in] result The first result.
+ *
+ * @param[out] dump The string.
+ */
+static void dump_results(const mi_results *result, string &dump)
+{
+	for (; nullptr != result; result = result->next)
+	{
+		dump += nullptr != result->var ? result->var : "-";
+		dump += '=';
+		if (t_const == result->type)
+		{
+			dump += '"';
+			dump += result->v.cstr;
+			dump += '"';
+		}
+		else
+		{
+			dump += t_tuple == result->type ? '{' : '[';
+			dump_results(result->v.rs, dump);
+			dump += t_tuple == result->type ? '}' : ']';
+		}
+		dump += ',';
+	}
+}
+
+/**
+ * This function appends a list of parsed outputs as text to a string, one
+ * line per output, so the parse trees of different parser configurations can
+ * be compared.
+ *
+ * @param[in] output The first output.
+ *
+ * @param[out] dump The string.
+ */
+void bench_dump_output(const mi_output *output, string &dump)
+{
+	for (; nullptr != output; output = output->next)
+	{
+		dump += std::to_string(output->type) + "," +
+				std::to_string(output->stype) + "," +
+				std::to_string(output->sstype) + "," +
+				std::to_string(output->tclass) + ":";
+		dump_results(output->c, dump);
+		dump += '\n';
+	}
+}
+
+/**
+ * This function allocates a handle in one of the configurations: malloc,
+ * arena, views, or views with only the results and stops subscribed.
+ *
+ * @param config The configuration.
+ *
+ * @return The handle.
+ */
+mi_h *bench_open_handle(const int config)
+{
+	mi_h *handle = mi_alloc_h();
+	if (1 == config)
+	{
+		mi_use_arena(handle);
+	}
+	else if (2 <= config)
+	{
+		mi_use_views(handle);
+	}
+	if (3 == config)
+	{
+		mi_subscribe(handle, MI_REC_RESULT | MI_REC_STOPPED);
+	}
+	return handle;
+}
+
+/**
+ * This function changes a few random bytes of a text to the bytes the parsers
+ * branch on.
+ *
+ * @param[in] text The text.
+ *
+ * @param random The random number generator.
+ *
+ * @return The mutated text.
+ */
+string bench_mutate(const string &text, std::mt19937 &random)
+{
+	static const char special[] = "\"\\,=[]{}\r\n~^*(a1 ";
+	string mutated = text;
+	const int edits = 1 + random() % BENCH_MAX_EDITS;
+	for (int i = 0; i < edits && !mutated.empty(); ++i)
+	{
+		const size_t pos = random() % mutated.size();
+		const char c = special[random() % (sizeof(special) - 1)];
+		switch (random() % 3)
+		{
+		case 0:
+			mutated[pos] = c;
+			break;
+		case 1:
+			mutated.insert(pos, 1, c);
+			break;
+		default:
+			mutated.erase(pos, 1);
+			break;
+		}
+	}
+	return mutated;
+}
+
+/**
+ * This is the default constructor for the BenchRecord class.
+ *
+ * @param[in] bench The name of the benchmark program.
+ *
+ * @param[in] name The name of the measurement.
+ */
+BenchRecord::BenchRecord(const string &bench, const string &name)
+	: m_json("{")
+{
+	const char *commit = getenv("BENCH_COMMIT");
+	add("bench", bench);
+	add("name", name);
+	add("commit", commit ? commit : "unknown");
+	add("time", (double)time(nullptr));
+}
+
+/**
+ * This function adds a string value to the record. The value must not need
+ * escaping, which holds for the names used by the benchmarks.
+ *
+ * @param[in] key The key.
+ *
+ * @param[in] value The value.
+ *
+ * @return The record.
+ */
+BenchRecord &BenchRecord::add(const string &key, const string &value)
+{
+	if (1 != m_json.size())
+	{
+		m_json += ",";
+	}
+	m_json += "\"" + key + "\":\"" + value + "\"";
+	return *this;
+}
+
+/**
+ * This function adds a numeric value to the record.
+ *
+ * @param[in] key The key.
+ *
+ * @param value The value.
+ *
+ * @return The record.
+ */
+BenchRecord &BenchRecord::add(const string &key, const double value)
+{
+	char number[32];
+	snprintf(number, sizeof(number), "%.10g", value);
+	if (1 != m_json.size())
+	{
+		m_json += ",";
+	}
+	m_json += "\"" + key + "\":" + number;
+	return *this;
+}
+
+/**
+ * This function prints the record as a single line to stdout.
+ */
+void BenchRecord::print() const
+{
+	printf("%s}\n", m_json.c_str());
+	fflush(stdout);
+}
@@ -0,0 +1,83 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file bench.hpp
+ *
+ * @brief Header file for the BenchRecord class and the benchmark helpers.
+ *
+ * This is the header file for the BenchRecord class and the helpers shared by
+ * the benchmarks.
+ */
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mi_gdb.h"
+
+/// The number of handle configurations, see bench_open_handle.
+#define BENCH_HANDLE_CONFIGS 4
+/// The maximum number of bytes changed by bench_mutate.
+#define BENCH_MAX_EDITS 8
+
+/// Returns the time of the monotonic clock in nanoseconds.
+std::uint64_t bench_now();
+/// Reads a file into a string.
+bool bench_read_file(const char *path, std::string &content);
+/// Splits text into lines.
+std::vector<std::string> bench_split_lines(const std::string &text);
+/// Returns the name of a file without directory and extension.
+std::string bench_basename(const char *path);
+/// Appends a list of parsed outputs as text to a string.
+void bench_dump_output(const mi_output *output, std::string &dump);
+/// Allocates a libmigdb handle in one of the configurations.
+mi_h *bench_open_handle(const int config);
+/// Changes a few random bytes of a text.
+std::string bench_mutate(const std::string &text, std::mt19937 &random);
+
+/// A single benchmark result, printed as one line of JSON.
+/**
+ * This class collects the values of a benchmark result and prints them as a
+ * JSON object on a single line, together with the commit the benchmark was
+ * built from (environment variable BENCH_COMMIT) and a timestamp. Appending
+ * the lines of every run to one file gives a history which can be compared
+ * across commits.
+ */
+class BenchRecord
+{
+	std::string m_json;
+
+public:
+	/// Default constructor.
+	BenchRecord(const std::string &bench, const std::string &name);
+
+	/// Adds a string value.
+	BenchRecord &add(const std::string &key, const std::string &value);
+	/// Adds a numeric value.
+	BenchRecord &add(const std::string &key, const double value);
+	/// Prints the record to stdout.
+	void print() const;
+};
+
+#endif /* BENCH_HPP */
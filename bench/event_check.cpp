@@ -0,0 +1,129 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file event_check.cpp
+ *
+ * @brief Differential check of the stream event parser.
+ *
+ * This file contains a check of MiEventParser against parse_mi_event. The
+ * transcripts, mutated copies of them and a synthetic long console line are
+ * split into lines for parse_mi_event and into random chunks, down to single
+ * bytes, for MiEventParser. The events of both must be equal, the text of
+ * consecutive stream events being compared as a whole.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <variant>
+
+#include "bench.hpp"
+#include "event_dump.hpp"
+
+using std::string;
+using std::vector;
+
+/// The number of mutated copies of every transcript.
+#define EVENT_CHECK_MUTATIONS 200
+
+/**
+ * This function compares the events of both parsers on a text, in chunks of
+ * single bytes, of a few bytes and of the size the master receives.
+ *
+ * @param[in] text The text.
+ *
+ * @param random The random number generator.
+ *
+ * @param[out] events The number of events of the line parser.
+ *
+ * @return The number of mismatching splits.
+ */
+static int check_text(const string &text, std::mt19937 &random,
+					  size_t &events)
+{
+	static const size_t max_chunks[] = {1, 16, 8192};
+	const string expected = bench_parse_events(text);
+	int mismatches = 0;
+	for (const size_t max_chunk : max_chunks)
+	{
+		if (bench_parse_event_stream(text, max_chunk, random) != expected)
+		{
+			++mismatches;
+		}
+	}
+	for (const char c : expected)
+	{
+		events += '\n' == c;
+	}
+	return mismatches;
+}
+
+/// Entry point for the event parser check.
+/**
+ * This program compares the stream event parser with the line parser on the
+ * given transcripts and prints the result to stderr.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments.
+ *
+ * @return @c EXIT_SUCCESS if all events match, @c EXIT_FAILURE otherwise.
+ */
+int main(const int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: event_check transcript...\n");
+		return EXIT_FAILURE;
+	}
+	std::mt19937 random(42);
+	size_t events = 0;
+	int texts = 0;
+	int mismatches = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		string text;
+		if (!bench_read_file(argv[i], text))
+		{
+			return EXIT_FAILURE;
+		}
+		mismatches += check_text(text, random, events);
+		++texts;
+		for (int j = 0; j < EVENT_CHECK_MUTATIONS; ++j)
+		{
+			mismatches += check_text(bench_mutate(text, random), random, events);
+			++texts;
+		}
+	}
+
+	// a console line several times longer than a stream event
+	string text = "^done\n~\"";
+	while (text.size() < 4 * MI_EVENT_MAX_TEXT)
+	{
+		text += "0123456789\\\"\\\\\\n";
+	}
+	text += "\"\r\n(gdb)\n";
+	mismatches += check_text(text, random, events);
+	++texts;
+
+	fprintf(stderr, "event_check: %d texts, %zu events, %d mismatches\n",
+			texts, events, mismatches);
+	return 0 == mismatches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
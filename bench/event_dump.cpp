@@ -0,0 +1,99 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file event_dump.cpp
+ *
+ * @brief Contains the implementation of the event parser helpers.
+ *
+ * This file contains the implementation of the helpers shared by the checks
+ * of the event parsers of the master.
+ */
+
+#include "event_dump.hpp"
+
+using std::size_t;
+using std::string;
+
+/**
+ * This function parses a text line by line with parse_mi_event, framed like
+ * the parse pool did: without the line break and a trailing carriage return,
+ * skipping empty lines and an incomplete last line.
+ *
+ * @param[in] text The text.
+ *
+ * @return The events as text.
+ */
+string bench_parse_events(const string &text)
+{
+	EventDump dump;
+	size_t start = 0;
+	for (size_t end; string::npos != (end = text.find('\n', start));
+		 start = end + 1)
+	{
+		string line = text.substr(start, end - start);
+		if (!line.empty() && '\r' == line.back())
+		{
+			line.pop_back();
+		}
+		if (line.empty())
+		{
+			continue;
+		}
+		const MiEvent event = parse_mi_event(&line[0]);
+		if (0 != event.index())
+		{
+			dump.add(event);
+		}
+	}
+	return dump.text();
+}
+
+/**
+ * This function parses a text with MiEventParser in random chunks.
+ *
+ * @param[in] text The text.
+ *
+ * @param max_chunk The maximum size of a chunk in bytes.
+ *
+ * @param random The random number generator.
+ *
+ * @return The events as text.
+ */
+string bench_parse_event_stream(const string &text, const size_t max_chunk,
+								std::mt19937 &random)
+{
+	EventDump dump;
+	MiEventParser parser;
+	MiEvent event;
+	for (size_t pos = 0; pos < text.size();)
+	{
+		size_t length = 1 + random() % max_chunk;
+		length = std::min(length, text.size() - pos);
+		// a chunk of its own, so reading past its end is noticed by ASan
+		const string chunk = text.substr(pos, length);
+		parser.feed(chunk.data(), chunk.size());
+		while (parser.next(event))
+		{
+			dump.add(event);
+		}
+		pos += length;
+	}
+	return dump.text();
+}
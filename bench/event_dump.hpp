@@ -0,0 +1,142 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file event_dump.hpp
+ *
+ * @brief Header file for the EventDump class and the event parser helpers.
+ *
+ * This is the header file for the EventDump class and the helpers shared by
+ * the checks of the event parsers of the master.
+ */
+
+#ifndef EVENT_DUMP_HPP
+#define EVENT_DUMP_HPP
+
+#include <random>
+#include <string>
+#include <variant>
+
+#include "mi_event.hpp"
+
+/// Dumps events as text.
+/**
+ * This class appends the events to a text. The text of consecutive stream
+ * events of the same stream is joined, as the stream parser splits long
+ * stream records into several events.
+ */
+class EventDump
+{
+	std::string m_dump;
+	std::string m_text;
+	int m_stream = -1;
+
+	/// Appends the pending stream text.
+	void flush()
+	{
+		if (0 <= m_stream)
+		{
+			m_dump += "stream " + std::to_string(m_stream) + " " + m_text +
+					  "\n";
+			m_text.clear();
+			m_stream = -1;
+		}
+	}
+
+public:
+	/// Appends an event.
+	void add(const MiEvent &event)
+	{
+		if (const MiStreamText *stream = std::get_if<MiStreamText>(&event))
+		{
+			if (stream->stream != m_stream)
+			{
+				flush();
+				m_stream = stream->stream;
+			}
+			m_text.append(stream->text);
+			return;
+		}
+		flush();
+		if (const MiResult *result = std::get_if<MiResult>(&event))
+		{
+			m_dump += "result " + std::to_string(result->tclass) + " " +
+					  (nullptr != result->value.data()
+						   ? "\"" + std::string(result->value) + "\""
+						   : "-") +
+					  " " + std::to_string(result->bkpt_number);
+		}
+		else if (const MiStopped *stopped = std::get_if<MiStopped>(&event))
+		{
+			// the frames of both parsers differ in their arguments
+			std::string frame(stopped->frame);
+			MiFrame location{std::string_view(), 0, std::string_view()};
+			if (!frame.empty())
+			{
+				parse_mi_frame(&frame[0], location);
+			}
+			m_dump += "stopped " + std::to_string(stopped->reason) + " " +
+					  std::to_string(stopped->bkptno) + " " +
+					  std::string(location.fullname) + ":" +
+					  std::to_string(location.line) + " " +
+					  std::string(location.func);
+		}
+		else if (const MiExited *exited = std::get_if<MiExited>(&event))
+		{
+			m_dump += "exited " + std::to_string(exited->reason) + " " +
+					  std::to_string(exited->exit_code);
+		}
+		else if (const MiBreakpointCreated *created =
+					 std::get_if<MiBreakpointCreated>(&event))
+		{
+			m_dump += "created " + std::to_string(created->number);
+		}
+		else if (const MiBreakpointModified *modified =
+					 std::get_if<MiBreakpointModified>(&event))
+		{
+			m_dump += "modified " + std::to_string(modified->number);
+		}
+		else if (const MiBreakpointDeleted *deleted =
+					 std::get_if<MiBreakpointDeleted>(&event))
+		{
+			m_dump += "deleted " + std::to_string(deleted->number);
+		}
+		else
+		{
+			m_dump += "event " + std::to_string(event.index());
+		}
+		m_dump += "\n";
+	}
+
+	/// Returns the dump.
+	const std::string &text()
+	{
+		flush();
+		return m_dump;
+	}
+};
+
+/// Parses a text line by line with parse_mi_event.
+std::string bench_parse_events(const std::string &text);
+/// Parses a text with MiEventParser in random chunks.
+std::string bench_parse_event_stream(const std::string &text,
+									 const std::size_t max_chunk,
+									 std::mt19937 &random);
+
+#endif /* EVENT_DUMP_HPP */
@@ -0,0 +1,242 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file fake_tools.cpp
+ *
+ * @brief Minimal stand-ins for socat and GDB.
+ *
+ * This file contains minimal stand-ins for the socat and GDB instances
+ * started by the slave, so the startup of the slave can be measured without
+ * the time GDB needs to load a target. The program acts as socat or GDB
+ * depending on the name it is called by.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <string>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+using std::string;
+
+/// The number of attempts to connect to the master.
+#define FAKE_CONNECT_ATTEMPTS 500
+/// The size of the relay buffer in bytes.
+#define FAKE_BUFFER_SIZE 8192
+
+/// The output of GDB stopping at the breakpoint at main.
+static const char *const s_startup =
+	"=thread-group-added,id=\"i1\"\n"
+	"=breakpoint-created,bkpt={number=\"1\",type=\"breakpoint\",disp=\"keep\","
+	"enabled=\"y\",addr=\"0x0000000000401136\",func=\"main\",file=\"fake.c\","
+	"fullname=\"/tmp/fake.c\",line=\"5\",thread-groups=[\"i1\"],times=\"0\","
+	"original-location=\"main\"}\n"
+	"=thread-group-started,id=\"i1\",pid=\"4242\"\n"
+	"=thread-created,id=\"1\",group-id=\"i1\"\n"
+	"^running\n"
+	"*running,thread-id=\"all\"\n"
+	"(gdb)\n"
+	"*stopped,reason=\"breakpoint-hit\",disp=\"keep\",bkptno=\"1\","
+	"frame={addr=\"0x0000000000401136\",func=\"main\",args=[],file=\"fake.c\","
+	"fullname=\"/tmp/fake.c\",line=\"5\",arch=\"i386:x86-64\"},"
+	"thread-id=\"1\",stopped-threads=\"all\",core=\"0\"\n"
+	"(gdb)\n";
+
+/**
+ * This function writes a buffer completely.
+ *
+ * @param fd The file descriptor.
+ *
+ * @param[in] data The data.
+ *
+ * @param length The length of the data in bytes.
+ *
+ * @return @c true on success, @c false on error.
+ */
+static bool write_all(const int fd, const char *data, size_t length)
+{
+	while (length > 0)
+	{
+		const ssize_t written = write(fd, data, length);
+		if (written <= 0)
+		{
+			return false;
+		}
+		data += written;
+		length -= written;
+	}
+	return true;
+}
+
+/**
+ * This function emulates socat with the arguments used by the slave,
+ * "TCP:<addr>:<port>" and "PTY,echo=0,link=<path>". It connects to the master,
+ * creates the PTY with the link and relays data in both directions until the
+ * master closes the connection.
+ *
+ * @param[in] tcp_arg The TCP address.
+ *
+ * @param[in] pty_arg The PTY address.
+ *
+ * @return The exit state of the program.
+ */
+static int fake_socat(const char *tcp_arg, const char *pty_arg)
+{
+	const string tcp = tcp_arg;
+	const string pty = pty_arg;
+	const size_t colon = tcp.rfind(':');
+	const size_t link_pos = pty.find("link=");
+	if (0 != tcp.compare(0, 4, "TCP:") || string::npos == colon ||
+		string::npos == link_pos)
+	{
+		fprintf(stderr, "fake socat: unsupported addresses\n");
+		return EXIT_FAILURE;
+	}
+	const string link = pty.substr(link_pos + 5);
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(atoi(tcp.c_str() + colon + 1));
+	inet_pton(AF_INET, tcp.substr(4, colon - 4).c_str(), &addr.sin_addr);
+	int sock = -1;
+	for (int attempt = 0; attempt < FAKE_CONNECT_ATTEMPTS; ++attempt)
+	{
+		sock = socket(AF_INET, SOCK_STREAM, 0);
+		if (0 == connect(sock, (sockaddr *)&addr, sizeof(addr)))
+		{
+			break;
+		}
+		close(sock);
+		sock = -1;
+		usleep(10000);
+	}
+	if (sock < 0)
+	{
+		perror("fake socat: connect");
+		return EXIT_FAILURE;
+	}
+
+	const int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || 0 != grantpt(master) || 0 != unlockpt(master))
+	{
+		perror("fake socat: pty");
+		return EXIT_FAILURE;
+	}
+	const char *name = ptsname(master);
+	// keep the slave side open, so reading the master never fails with EIO
+	const int slave = open(name, O_RDWR | O_NOCTTY);
+	termios attributes;
+	tcgetattr(slave, &attributes);
+	attributes.c_lflag &= ~ECHO;
+	tcsetattr(slave, TCSANOW, &attributes);
+	unlink(link.c_str());
+	if (0 != symlink(name, link.c_str()))
+	{
+		perror("fake socat: symlink");
+		return EXIT_FAILURE;
+	}
+
+	pollfd fds[2] = {{sock, POLLIN, 0}, {master, POLLIN, 0}};
+	char buffer[FAKE_BUFFER_SIZE];
+	for (;;)
+	{
+		if (poll(fds, 2, -1) < 0)
+		{
+			break;
+		}
+		if (0 != fds[0].revents)
+		{
+			const ssize_t length = read(sock, buffer, sizeof(buffer));
+			if (length <= 0 || !write_all(master, buffer, length))
+			{
+				break;
+			}
+		}
+		if (0 != fds[1].revents)
+		{
+			const ssize_t length = read(master, buffer, sizeof(buffer));
+			if (length <= 0 || !write_all(sock, buffer, length))
+			{
+				break;
+			}
+		}
+	}
+	close(sock);
+	close(slave);
+	close(master);
+	unlink(link.c_str());
+	return EXIT_SUCCESS;
+}
+
+/**
+ * This function emulates GDB: it prints the output of stopping at main and
+ * acknowledges every command until its input is closed.
+ *
+ * @return The exit state of the program.
+ */
+static int fake_gdb()
+{
+	if (!write_all(STDOUT_FILENO, s_startup, strlen(s_startup)))
+	{
+		return EXIT_FAILURE;
+	}
+	const char *const reply = "^done\n(gdb)\n";
+	char line[FAKE_BUFFER_SIZE];
+	while (nullptr != fgets(line, sizeof(line), stdin))
+	{
+		if (!write_all(STDOUT_FILENO, reply, strlen(reply)))
+		{
+			break;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+/// Entry point for the fake tools.
+/**
+ * This program acts as socat or GDB, depending on the name it is called by.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments.
+ *
+ * @return The exit state of the program.
+ */
+int main(const int argc, char **argv)
+{
+	const char *name = strrchr(argv[0], '/');
+	name = name ? name + 1 : argv[0];
+	if (0 == strcmp(name, "socat") && 3 == argc)
+	{
+		return fake_socat(argv[1], argv[2]);
+	}
+	if (0 == strcmp(name, "gdb"))
+	{
+		return fake_gdb();
+	}
+	fprintf(stderr, "Call this program as socat or gdb.\n");
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,282 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ingest_bench.cpp
+ *
+ * @brief End-to-end benchmark of the ingest pipeline of the master.
+ *
+ * This file contains a benchmark of the path GDB output takes through the
+ * master: receive buffers, ingest budget, parse pool and the state update of
+ * the processes. It uses the headless receiver, so no GTK is needed.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+#include "buffer_pool.hpp"
+#include "headless.hpp"
+
+using std::string;
+
+/// The base port the emulated slaves are assigned to.
+#define INGEST_BENCH_BASE_PORT 32768
+/// The exit code marking the end of the output of a process.
+#define INGEST_BENCH_EXIT_CODE 77
+/// The ingest budget of a single process in bytes.
+#define INGEST_BENCH_RANK_BUDGET (1 << 20)
+/// The ingest budget of all processes in bytes.
+#define INGEST_BENCH_TOTAL_BUDGET (256 << 20)
+
+/// Protects the event counters.
+static std::mutex s_mutex;
+/// Signals that a process has finished.
+static std::condition_variable s_cond;
+/// The number of processes whose output has been applied completely.
+static int s_num_finished = 0;
+/// The number of events printed by the master.
+static std::uint64_t s_num_events = 0;
+
+/**
+ * This function reads the JSON lines printed by the master and counts the
+ * processes which exited with the end marker.
+ *
+ * @param fd The reading end of the pipe stdout is redirected to.
+ */
+static void count_events(const int fd)
+{
+	const string marker = "\"code\":" + std::to_string(INGEST_BENCH_EXIT_CODE);
+	FILE *input = fdopen(fd, "r");
+	char *line = nullptr;
+	size_t capacity = 0;
+	while (getline(&line, &capacity, input) > 0)
+	{
+		const bool finished = nullptr != strstr(line, "\"event\":\"exited\"") &&
+							  nullptr != strstr(line, marker.c_str());
+		std::lock_guard<std::mutex> lock(s_mutex);
+		++s_num_events;
+		if (finished)
+		{
+			++s_num_finished;
+			s_cond.notify_all();
+		}
+	}
+	free(line);
+	fclose(input);
+}
+
+/**
+ * This function emulates the GDB connections of a subset of the processes.
+ * The output of the processes is sent round-robin in chunks, so the chunks of
+ * different processes interleave like on the network and lines are split at
+ * chunk boundaries.
+ *
+ * @param[in] master The master.
+ *
+ * @param[in] output The output of every process.
+ *
+ * @param first The first rank of this feeder.
+ *
+ * @param step The distance between the ranks of this feeder.
+ *
+ * @param num_processes The number of processes.
+ *
+ * @param chunk_size The maximum size of a chunk in bytes.
+ */
+static void feed(Headless *master, const string *output, const int first,
+				 const int step, const int num_processes,
+				 const size_t chunk_size)
+{
+	std::vector<size_t> offsets(num_processes, 0);
+	bool remaining = true;
+	while (remaining)
+	{
+		remaining = false;
+		for (int rank = first; rank < num_processes; rank += step)
+		{
+			if (offsets[rank] == output->size())
+			{
+				continue;
+			}
+			const int port = INGEST_BENCH_BASE_PORT + rank;
+			const size_t length =
+				std::min(chunk_size, output->size() - offsets[rank]);
+			char *data = master->acquire_buffer(port);
+			memcpy(data, output->data() + offsets[rank], length);
+			data[length] = '\0';
+			master->push_data(data, length, port);
+			offsets[rank] += length;
+			remaining = true;
+		}
+	}
+}
+
+/**
+ * This function prints the help text.
+ */
+static void print_help()
+{
+	fprintf(stderr,
+			"Usage: ./ingest_bench [OPTIONS] <transcript>...\n"
+			"  -n <num>\t number of processes (default 256)\n"
+			"  -r <num>\t repetitions of the transcripts per process (default 20)\n"
+			"  -c <bytes>\t maximum chunk size (default %d)\n"
+			"  -f <num>\t number of feeder threads (default 4)\n"
+			"  -h\t\t print this help\n",
+			MAX_LENGTH);
+}
+
+/// Entry point for the ingest benchmark.
+/**
+ * This program feeds the concatenated transcripts as the GDB output of every
+ * process into the master and measures the time until the output of all
+ * processes has been applied. The events printed by the master are counted and
+ * discarded.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments.
+ *
+ * @return The exit state of the program.
+ */
+int main(const int argc, char **argv)
+{
+	int num_processes = 256;
+	int repetitions = 20;
+	int chunk_size = MAX_LENGTH;
+	int num_feeders = 4;
+	int c;
+	opterr = 0;
+	while ((c = getopt(argc, argv, "hn:r:c:f:")) != -1)
+	{
+		switch (c)
+		{
+		case 'n': // number of processes
+			num_processes = atoi(optarg);
+			break;
+		case 'r': // repetitions
+			repetitions = atoi(optarg);
+			break;
+		case 'c': // chunk size
+			chunk_size = atoi(optarg);
+			break;
+		case 'f': // feeder threads
+			num_feeders = atoi(optarg);
+			break;
+		case 'h': // help
+			print_help();
+			return EXIT_SUCCESS;
+		default:
+			print_help();
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind == argc || num_processes <= 0 || repetitions <= 0 ||
+		chunk_size <= 0 || chunk_size > MAX_LENGTH || num_feeders <= 0)
+	{
+		print_help();
+		return EXIT_FAILURE;
+	}
+
+	string transcripts;
+	for (int i = optind; i < argc; ++i)
+	{
+		string text;
+		if (!bench_read_file(argv[i], text))
+		{
+			return EXIT_FAILURE;
+		}
+		transcripts += text;
+	}
+	string output;
+	for (int i = 0; i < repetitions; ++i)
+	{
+		output += transcripts;
+	}
+	output += "*stopped,reason=\"exited\",exit-code=\"" +
+			  std::to_string(INGEST_BENCH_EXIT_CODE) + "\"\n(gdb)\n";
+	size_t num_responses = 0;
+	for (size_t pos = 0; string::npos != (pos = output.find("(gdb)", pos));
+		 pos += 5)
+	{
+		++num_responses;
+	}
+
+	// the events of the master go to stdout, count them in a pipe instead
+	fflush(stdout);
+	const int stdout_fd = dup(STDOUT_FILENO);
+	int fds[2];
+	if (0 != pipe(fds))
+	{
+		perror("pipe");
+		return EXIT_FAILURE;
+	}
+	dup2(fds[1], STDOUT_FILENO);
+	close(fds[1]);
+	std::thread counter(count_events, fds[0]);
+
+	Headless *master =
+		new Headless(num_processes, INGEST_BENCH_BASE_PORT,
+					 INGEST_BENCH_RANK_BUDGET, INGEST_BENCH_TOTAL_BUDGET, 1);
+	num_feeders = std::min(num_feeders, num_processes);
+	const std::uint64_t start = bench_now();
+	std::vector<std::thread> feeders;
+	for (int i = 0; i < num_feeders; ++i)
+	{
+		feeders.emplace_back(feed, master, &output, i, num_feeders,
+							 num_processes, (size_t)chunk_size);
+	}
+	{
+		std::unique_lock<std::mutex> lock(s_mutex);
+		s_cond.wait(lock, [num_processes]
+					{ return s_num_finished == num_processes; });
+	}
+	const double seconds = (bench_now() - start) / 1e9;
+	for (std::thread &feeder : feeders)
+	{
+		feeder.join();
+	}
+	delete master;
+
+	fflush(stdout);
+	dup2(stdout_fd, STDOUT_FILENO);
+	close(stdout_fd);
+	counter.join();
+
+	const double bytes = (double)output.size() * num_processes;
+	BenchRecord("ingest", "headless")
+		.add("processes", num_processes)
+		.add("chunk_size", chunk_size)
+		.add("bytes", bytes)
+		.add("responses", (double)num_responses * num_processes)
+		.add("events", (double)s_num_events)
+		.add("seconds", seconds)
+		.add("mib_per_s", bytes / seconds / (1 << 20))
+		.add("responses_per_s", num_responses * num_processes / seconds)
+		.print();
+	return EXIT_SUCCESS;
+}
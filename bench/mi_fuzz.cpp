@@ -0,0 +1,537 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file mi_fuzz.cpp
+ *
+ * @brief Fuzz target for the GDB/MI parsers.
+ *
+ * This file contains a fuzz target for libmigdb and the event parsers of the
+ * master. An input is a piece of GDB output. Every line is parsed by
+ * mi_parse_gdb_output and passed to the extractors of stops, breakpoints,
+ * frames and thread IDs, every response is read through a handle by one of the
+ * mi_res_* extractors, in turn. Crashes, overflows and leaks are reported by
+ * the sanitizers the target is built with.
+ *
+ * In differential mode, the faster parsers are compared with the reference
+ * ones on every input: the vectorised scanning with the scalar one, handles
+ * parsing into an arena or into views of the line with handles using malloc,
+ * and the stream event parser with the line one. A difference aborts, so it is
+ * reported like a crash.
+ *
+ * Built with MI_FUZZ_LIBFUZZER defined and -fsanitize=fuzzer, this is a
+ * libFuzzer target, whose differential mode is enabled by the environment
+ * variable MI_FUZZ_DIFFERENTIAL. Otherwise it is a standalone program, which
+ * runs the given corpus and random mutations of it.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <unistd.h>
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+#include "bench.hpp"
+#include "event_dump.hpp"
+
+using std::string;
+using std::vector;
+
+/// The default number of mutated inputs of the standalone program.
+#define MI_FUZZ_ITERATIONS 5000
+/// The number of mi_res_* extractors, see extract_response.
+#define MI_FUZZ_EXTRACTORS 14
+
+/// Whether the faster parsers are compared with the reference ones.
+static bool s_differential = false;
+/// The input being run.
+static string s_input;
+/// The file the input is written to when it fails, or nullptr.
+static const char *s_failure_path = nullptr;
+
+/**
+ * This function writes the input being run to the failure file, if any, so
+ * a crash or mismatch of the standalone program can be reproduced.
+ */
+static void save_input()
+{
+	if (nullptr == s_failure_path)
+	{
+		return;
+	}
+	FILE *file = fopen(s_failure_path, "wb");
+	if (nullptr != file)
+	{
+		fwrite(s_input.data(), 1, s_input.size(), file);
+		fclose(file);
+		fprintf(stderr, "mi_fuzz: input written to %s\n", s_failure_path);
+	}
+}
+
+/**
+ * This function reports a difference between a parser and its reference and
+ * aborts.
+ *
+ * @param[in] what The parsers compared.
+ *
+ * @param[in] expected The result of the reference parser.
+ *
+ * @param[in] actual The result of the faster parser.
+ */
+static void mismatch(const char *const what, const string &expected,
+					 const string &actual)
+{
+	fprintf(stderr, "mi_fuzz: %s mismatch\n--- expected\n%s--- actual\n%s",
+			what, expected.c_str(), actual.c_str());
+	save_input();
+	abort();
+}
+
+/**
+ * This function passes a parsed line to the extractors which work on parsed
+ * output and appends their results to a dump.
+ *
+ * @param[in] output The parsed line, may be nullptr.
+ *
+ * @param[out] dump The string.
+ */
+static void extract_output(mi_output *output, string &dump)
+{
+	char *reason;
+	const int stopped = mi_get_async_stop_reason(output, &reason);
+	dump += "reason:" + std::to_string(stopped) + "," +
+			(nullptr != reason ? reason : "-") + "\n";
+	mi_stop *stop = mi_res_stop(output);
+	if (nullptr != stop)
+	{
+		dump += "stop:" + std::to_string(stop->reason) + "," +
+				std::to_string(stop->bkptno) + "," +
+				std::to_string(nullptr != stop->frame ? stop->frame->line : 0) +
+				"\n";
+		mi_free_stop(stop);
+	}
+	mi_frames *frame = mi_get_async_frame(output);
+	if (nullptr != frame)
+	{
+		dump += "frame:" + std::to_string(frame->line) + "\n";
+		mi_free_frames(frame);
+	}
+	mi_bkpt *bkpt = mi_res_bkpt(output);
+	if (nullptr != bkpt)
+	{
+		dump += "bkpt:" + std::to_string(bkpt->number) + "\n";
+		mi_free_bkpt(bkpt);
+	}
+	mi_output *record = mi_get_rrecord(output);
+	if (nullptr != record)
+	{
+		int *list;
+		const int ids = mi_get_thread_ids(record, &list);
+		dump += "ids:" + std::to_string(ids) + "\n";
+		free(list);
+	}
+}
+
+/**
+ * This function parses lines one by one with mi_parse_gdb_output.
+ *
+ * @param[in] lines The lines.
+ *
+ * @param simd The string scanning implementation, see mi_set_simd.
+ *
+ * @return The parsed lines and the results of their extractors as text.
+ */
+static string parse_lines(const vector<string> &lines, const int simd)
+{
+	mi_set_simd(simd);
+	string dump;
+	for (const string &line : lines)
+	{
+		mi_output *output = mi_parse_gdb_output(line.c_str());
+		bench_dump_output(output, dump);
+		extract_output(output, dump);
+		mi_free_output(output);
+	}
+	return dump;
+}
+
+/**
+ * This function reads the lines as responses through a handle.
+ *
+ * @param[in] lines The lines.
+ *
+ * @param config The configuration of the handle, see bench_open_handle.
+ *
+ * @return The responses and the error state of the handle as text.
+ */
+static string parse_handle(const vector<string> &lines, const int config)
+{
+	mi_h *handle = bench_open_handle(config);
+	string dump;
+	for (const string &line : lines)
+	{
+		// the handle does not modify the line, views parse a copy
+		handle->line = const_cast<char *>(line.c_str());
+		const int complete = mi_get_response(handle);
+		handle->line = nullptr;
+		if (0 == complete)
+		{
+			continue;
+		}
+		mi_output *response = mi_retire_response(handle);
+		bench_dump_output(response, dump);
+		mi_release_response(handle, response);
+		dump += "error:" + std::to_string(handle->error) + "," +
+				mi_get_error_str(handle) + "," +
+				(nullptr != handle->error_from_gdb ? handle->error_from_gdb
+												   : "") +
+				"\n";
+	}
+	mi_release_response(handle, mi_retire_response(handle));
+	mi_free_h(&handle);
+	return dump;
+}
+
+/**
+ * This function reads the response completed by the current line of a handle
+ * with one of the mi_res_* extractors.
+ *
+ * @param[in] handle The handle, using malloc.
+ *
+ * @param extractor The index of the extractor.
+ *
+ * @param longest The length of the longest line of the response in bytes.
+ */
+static void extract_response(mi_h *handle, const int extractor,
+							 const size_t longest)
+{
+	switch (extractor)
+	{
+	case 0:
+		mi_res_simple_done(handle);
+		break;
+	case 1:
+		mi_free_frames(mi_res_frame(handle));
+		break;
+	case 2:
+		mi_free_frames(mi_res_frames_array(handle, "stack"));
+		break;
+	case 3:
+		mi_free_frames(mi_res_frames_list(handle));
+		break;
+	case 4:
+	{
+		int *list;
+		mi_res_thread_ids(handle, &list);
+		free(list);
+		break;
+	}
+	case 5:
+		mi_free_gvar(mi_res_gvar(handle, nullptr, "expression"));
+		break;
+	case 6:
+	{
+		mi_gvar_chg *changed;
+		mi_res_changelist(handle, &changed);
+		mi_free_gvar_chg(changed);
+		break;
+	}
+	case 7:
+	{
+		mi_gvar *gvar = mi_alloc_gvar();
+		mi_res_children(handle, gvar);
+		mi_free_gvar(gvar);
+		break;
+	}
+	case 8:
+		mi_free_wp(mi_res_wp(handle));
+		break;
+	case 9:
+		free(mi_res_value(handle));
+		break;
+	case 10:
+		mi_free_asm_insns(mi_get_asm_insns(handle));
+		break;
+	case 11:
+	{
+		int how_many;
+		mi_free_chg_reg(mi_get_list_registers(handle, &how_many));
+		break;
+	}
+	case 12:
+		mi_free_chg_reg(mi_get_list_changed_regs(handle));
+		break;
+	default:
+	{
+		// every element of the memory takes at least three bytes of a line
+		vector<unsigned char> memory(longest / 3 + 1);
+		int na;
+		unsigned long addr;
+		mi_get_read_memory(handle, memory.data(), 1, &na, &addr);
+		break;
+	}
+	}
+}
+
+/**
+ * This function reads every response of the lines with every mi_res_*
+ * extractor. The lines of a response are passed to the handle again for each
+ * of them, as an extractor takes the response.
+ *
+ * @param[in] lines The lines.
+ */
+static void extract_responses(const vector<string> &lines)
+{
+	mi_h *handle = mi_alloc_h();
+	size_t first = 0;
+	size_t longest = 0;
+	for (size_t idx = 0; idx < lines.size(); ++idx)
+	{
+		const string &prompt = lines[idx];
+		if (0 != strncmp(prompt.c_str(), "(gdb)", 5))
+		{
+			longest = std::max(longest, prompt.size());
+			continue;
+		}
+		for (int extractor = 0; extractor < MI_FUZZ_EXTRACTORS; ++extractor)
+		{
+			for (size_t line = first; line < idx; ++line)
+			{
+				handle->line = const_cast<char *>(lines[line].c_str());
+				if (0 != mi_get_response(handle))
+				{
+					// GDB exited, there is no prompt
+					mi_free_output(mi_retire_response(handle));
+				}
+			}
+			handle->line = const_cast<char *>(prompt.c_str());
+			extract_response(handle, extractor, longest);
+			handle->line = nullptr;
+		}
+		first = idx + 1;
+		longest = 0;
+	}
+	mi_free_h(&handle);
+}
+
+/**
+ * This function compares the stream event parser with the line one. Inputs
+ * with lines longer than the values of an event or nested deeper than the
+ * stream parser allows are skipped, their events differ by design.
+ *
+ * @param[in] text The input.
+ *
+ * @param[in] lines The lines of the input.
+ */
+static void check_events(const string &text, const vector<string> &lines)
+{
+	for (const string &line : lines)
+	{
+		size_t open = 0;
+		for (const char c : line)
+		{
+			open += '{' == c || '[' == c;
+		}
+		if (MI_EVENT_MAX_TEXT <= line.size() || MI_EVENT_MAX_DEPTH <= open)
+		{
+			return;
+		}
+	}
+	const string expected = bench_parse_events(text);
+	// the chunks depend on the input only, so failures are reproducible
+	std::mt19937 random(std::hash<string>()(text));
+	const string actual = bench_parse_event_stream(text, 1 + random() % 64,
+												   random);
+	if (actual != expected)
+	{
+		mismatch("event parser", expected, actual);
+	}
+}
+
+/**
+ * This function reads the fuzz target options from the environment.
+ *
+ * @return 0.
+ */
+extern "C" int LLVMFuzzerInitialize(int *, char ***)
+{
+	s_differential = nullptr != getenv("MI_FUZZ_DIFFERENTIAL");
+	return 0;
+}
+
+/**
+ * This function runs an input through the parsers and extractors and, in
+ * differential mode, compares the faster parsers with the reference ones.
+ * GDB never prints NUL bytes, so the input is cut at the first one.
+ *
+ * @param[in] data The input.
+ *
+ * @param size The size of the input in bytes.
+ *
+ * @return 0.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data,
+									  const size_t size)
+{
+	s_input.assign((const char *)data, size);
+	const string text(s_input.c_str());
+	const vector<string> lines = bench_split_lines(text);
+
+	const int best = mi_set_simd(-1);
+	const string reference = parse_lines(lines, MI_SIMD_NONE);
+	const string vectorised = parse_lines(lines, best);
+	extract_responses(lines);
+	const string handle = parse_handle(lines, 0);
+	const string arena = parse_handle(lines, 1);
+	const string views = parse_handle(lines, 2);
+	parse_handle(lines, 3);
+	if (s_differential)
+	{
+		if (vectorised != reference)
+		{
+			mismatch("vectorised scanning", reference, vectorised);
+		}
+		if (arena != handle)
+		{
+			mismatch("arena handle", handle, arena);
+		}
+		if (views != handle)
+		{
+			mismatch("views handle", handle, views);
+		}
+		check_events(text, lines);
+	}
+	return 0;
+}
+
+#ifndef MI_FUZZ_LIBFUZZER
+/**
+ * This function prints the help text.
+ */
+static void print_help()
+{
+	fprintf(stderr,
+			"usage: mi_fuzz [-d] [-n iterations] [-s seed] [-o file] "
+			"input...\n"
+			"  -d            compare the faster parsers with the reference "
+			"ones\n"
+			"  -n iterations number of mutated inputs (default %d)\n"
+			"  -s seed       seed of the mutations (default 1)\n"
+			"  -o file       write the input which failed to file\n",
+			MI_FUZZ_ITERATIONS);
+}
+
+/// Entry point for the standalone fuzzer.
+/**
+ * This program runs the given inputs and random mutations of them, a few
+ * bytes changed, cut off or two inputs spliced, through the fuzz target. A
+ * failure aborts the program. The mutations depend on the seed only, so a run
+ * can be repeated.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments.
+ *
+ * @return @c EXIT_SUCCESS if no input failed.
+ */
+int main(const int argc, char **argv)
+{
+	int iterations = MI_FUZZ_ITERATIONS;
+	unsigned seed = 1;
+	int opt;
+	while (-1 != (opt = getopt(argc, argv, "dn:s:o:h")))
+	{
+		switch (opt)
+		{
+		case 'd':
+			s_differential = true;
+			break;
+		case 'n':
+			iterations = atoi(optarg);
+			break;
+		case 's':
+			seed = strtoul(optarg, nullptr, 0);
+			break;
+		case 'o':
+			s_failure_path = optarg;
+			break;
+		default:
+			print_help();
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind >= argc || 0 > iterations)
+	{
+		print_help();
+		return EXIT_FAILURE;
+	}
+#if defined(__SANITIZE_ADDRESS__)
+	__sanitizer_set_death_callback(save_input);
+#endif
+	vector<string> corpus;
+	for (int i = optind; i < argc; ++i)
+	{
+		string text;
+		if (!bench_read_file(argv[i], text))
+		{
+			return EXIT_FAILURE;
+		}
+		corpus.push_back(text);
+	}
+
+	const std::uint64_t start = bench_now();
+	for (const string &text : corpus)
+	{
+		LLVMFuzzerTestOneInput((const std::uint8_t *)text.data(), text.size());
+	}
+	std::mt19937 random(seed);
+	for (int i = 0; i < iterations; ++i)
+	{
+		string text = bench_mutate(corpus[random() % corpus.size()], random);
+		switch (random() % 4)
+		{
+		case 0:
+			// cut off, like a response which is still being received
+			text.resize(random() % (text.size() + 1));
+			break;
+		case 1:
+		{
+			// the end of another input
+			const string &other = corpus[random() % corpus.size()];
+			text.resize(random() % (text.size() + 1));
+			text += other.substr(random() % (other.size() + 1));
+			break;
+		}
+		default:
+			break;
+		}
+		LLVMFuzzerTestOneInput((const std::uint8_t *)text.data(), text.size());
+	}
+	fprintf(stderr, "mi_fuzz: %zu inputs and %d mutations in %.0f ms%s\n",
+			corpus.size(), iterations, (bench_now() - start) / 1e6,
+			s_differential ? ", no differences" : "");
+	return EXIT_SUCCESS;
+}
+#endif
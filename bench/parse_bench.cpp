@@ -0,0 +1,426 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file parse_bench.cpp
+ *
+ * @brief Microbenchmarks of the libmigdb parser and the event parser.
+ *
+ * This file contains microbenchmarks of the libmigdb functions used on every
+ * GDB response: parsing a line of output, extracting a stop record and
+ * extracting a breakpoint, and of the event parsers the master uses instead.
+ * They run on recorded GDB transcripts and on a synthetic megabyte-long line.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.hpp"
+#include "buffer_pool.hpp"
+#include "mi_event.hpp"
+#include "mi_gdb.h"
+
+using std::string;
+using std::vector;
+
+/// The number of measurement rounds of a benchmark.
+#define PARSE_BENCH_ROUNDS 5
+/// The default minimum duration of a measurement round in milliseconds.
+#define PARSE_BENCH_DEFAULT_MS 50
+
+/// Keeps the results of measured functions without side effects alive.
+static volatile size_t s_sink;
+
+/// The minimum duration of a measurement round in nanoseconds.
+static std::uint64_t s_min_round_ns =
+	PARSE_BENCH_DEFAULT_MS * (std::uint64_t)1000000;
+
+/**
+ * This function measures a function in several rounds. Every round calls the
+ * function until the minimum round duration has passed. The fastest and the
+ * median round are reported, as the fastest is the least disturbed by other
+ * processes.
+ *
+ * @param[in] transcript The name of the transcript.
+ *
+ * @param[in] name The name of the measured function.
+ *
+ * @param items The number of items processed by a single call.
+ *
+ * @param bytes The number of bytes processed by a single call, or 0.
+ *
+ * @param[in] function The measured function.
+ */
+template <typename Function>
+static void measure(const string &transcript, const string &name,
+					const size_t items, const size_t bytes,
+					const Function &function)
+{
+	if (0 == items)
+	{
+		return;
+	}
+	function(); // warm up
+	double ns_per_item[PARSE_BENCH_ROUNDS];
+	for (int round = 0; round < PARSE_BENCH_ROUNDS; ++round)
+	{
+		std::uint64_t calls = 0;
+		const std::uint64_t start = bench_now();
+		std::uint64_t elapsed;
+		do
+		{
+			function();
+			++calls;
+			elapsed = bench_now() - start;
+		} while (elapsed < s_min_round_ns);
+		ns_per_item[round] = (double)elapsed / (calls * items);
+	}
+	std::sort(ns_per_item, ns_per_item + PARSE_BENCH_ROUNDS);
+	BenchRecord record("parse", transcript + "/" + name);
+	record.add("items", (double)items)
+		.add("ns_per_item", ns_per_item[0])
+		.add("ns_per_item_median", ns_per_item[PARSE_BENCH_ROUNDS / 2]);
+	if (0 != bytes)
+	{
+		record.add("mib_per_s", bytes / (ns_per_item[0] * items) * 1e9 /
+									(1 << 20));
+	}
+	record.print();
+}
+
+/**
+ * This function collects the bkpt tuples of a list of results, descending
+ * into the body of a breakpoint table.
+ *
+ * @param[in] result The first result.
+ *
+ * @param[out] tuples The bkpt tuples.
+ */
+static void collect_bkpts(mi_results *result, vector<mi_results *> &tuples)
+{
+	for (; nullptr != result; result = result->next)
+	{
+		if (t_const == result->type || nullptr == result->var)
+		{
+			continue;
+		}
+		if (0 == strcmp(result->var, "bkpt"))
+		{
+			tuples.push_back(result->v.rs);
+		}
+		else if (0 == strcmp(result->var, "BreakpointTable") ||
+				 0 == strcmp(result->var, "body"))
+		{
+			collect_bkpts(result->v.rs, tuples);
+		}
+	}
+}
+
+/**
+ * This function collects the bkpt tuples of a list of outputs, from result
+ * records, breakpoint tables and breakpoint notifications.
+ *
+ * @param[in] output The first output.
+ *
+ * @param[out] tuples The bkpt tuples.
+ */
+static void collect_bkpts(mi_output *output, vector<mi_results *> &tuples)
+{
+	for (; nullptr != output; output = output->next)
+	{
+		collect_bkpts(output->c, tuples);
+	}
+}
+
+/**
+ * This function runs the benchmarks on a transcript.
+ *
+ * @param[in] path The path of the transcript.
+ *
+ * @return @c true on success, @c false if the transcript cannot be read.
+ */
+static bool bench_transcript(const char *path)
+{
+	string text;
+	if (!bench_read_file(path, text))
+	{
+		return false;
+	}
+	const string transcript = bench_basename(path);
+	const vector<string> lines = bench_split_lines(text);
+
+	// mi_parse_gdb_output: every line except the prompts
+	vector<const char *> records;
+	size_t bytes = 0;
+	for (const string &line : lines)
+	{
+		if (0 != line.compare(0, 5, "(gdb)"))
+		{
+			records.push_back(line.c_str());
+			bytes += line.size() + 1;
+		}
+	}
+	measure(transcript, "mi_parse_gdb_output", records.size(), bytes,
+			[&records]()
+			{
+				for (const char *record : records)
+				{
+					mi_free_output(mi_parse_gdb_output(record));
+				}
+			});
+
+	// mi_get_response: whole responses like the parse pool handles them, with
+	// the output allocated by malloc, in an arena and as views of the line,
+	// the latter also with the scalar scan for comparison with the vectorised
+	// one and with only the records the parse pool subscribes to parsed
+	vector<string> buffers = lines;
+	size_t num_responses = 0;
+	for (const string &line : lines)
+	{
+		num_responses += 0 == line.compare(0, 5, "(gdb)");
+	}
+	const char *const modes[] = {"response_malloc", "response_arena",
+								 "response_views", "response_views_scalar",
+								 "response_selective"};
+	const int simd = mi_set_simd(-1);
+	for (int mode = 0; mode < 5; ++mode)
+	{
+		mi_h *handle = mi_alloc_h();
+		if (1 == mode)
+		{
+			mi_use_arena(handle);
+		}
+		else if (2 <= mode)
+		{
+			mi_use_views(handle);
+		}
+		if (4 == mode)
+		{
+			mi_subscribe(handle,
+						 MI_REC_RESULT | MI_REC_STOPPED | MI_REC_STREAM);
+		}
+		mi_set_simd(3 == mode ? MI_SIMD_NONE : simd);
+		measure(transcript, modes[mode], num_responses, bytes,
+				[&buffers, handle]()
+				{
+					for (string &line : buffers)
+					{
+						handle->line = &line[0];
+						if (0 != mi_get_response(handle))
+						{
+							mi_release_response(handle,
+												mi_retire_response(handle));
+						}
+					}
+				});
+		handle->line = nullptr;
+		mi_free_h(&handle);
+	}
+	mi_set_simd(simd);
+
+	// parse_mi_event: the typed events the parse pool uses instead of trees,
+	// on a copy of every line like the views, as it is unescaped in place
+	size_t max_length = 0;
+	for (const string &line : lines)
+	{
+		max_length = std::max(max_length, line.size());
+	}
+	vector<char> scratch(max_length + 1);
+	size_t events = 0;
+	measure(transcript, "events", num_responses, bytes,
+			[&lines, &scratch, &events]()
+			{
+				for (const string &line : lines)
+				{
+					memcpy(scratch.data(), line.c_str(), line.size() + 1);
+					events += parse_mi_event(scratch.data()).index();
+				}
+			});
+	s_sink = events;
+
+	// MiEventParser: the whole transcript in chunks of the size the master
+	// receives, parsed in place without framing lines
+	measure(transcript, "event_stream", num_responses, bytes,
+			[&text, &events]()
+			{
+				MiEventParser parser;
+				MiEvent event;
+				for (size_t pos = 0; pos < text.size(); pos += MAX_LENGTH)
+				{
+					parser.feed(text.data() + pos,
+								std::min((size_t)MAX_LENGTH, text.size() - pos));
+					while (parser.next(event))
+					{
+						events += event.index();
+					}
+				}
+			});
+	s_sink = events;
+
+	// keep all responses in the arena like the parse pool, the extraction
+	// copies from it and leaves the responses intact for the next call
+	mi_h *handle = mi_alloc_h();
+	mi_use_views(handle);
+	vector<mi_output *> responses;
+	for (string &line : buffers)
+	{
+		handle->line = &line[0];
+		if (0 != mi_get_response(handle))
+		{
+			responses.push_back(mi_retire_response(handle));
+		}
+	}
+	handle->line = nullptr;
+
+	vector<mi_output *> stops;
+	vector<mi_results *> tuples;
+	for (mi_output *response : responses)
+	{
+		for (mi_output *output = response; nullptr != output;
+			 output = output->next)
+		{
+			if (MI_CL_STOPPED == output->tclass)
+			{
+				stops.push_back(response);
+				break;
+			}
+		}
+		collect_bkpts(response, tuples);
+	}
+	measure(transcript, "mi_res_stop", stops.size(), 0,
+			[&stops]()
+			{
+				for (mi_output *response : stops)
+				{
+					mi_free_stop(mi_res_stop(response));
+				}
+			});
+	measure(transcript, "mi_get_bkpt", tuples.size(), 0,
+			[&tuples]()
+			{
+				for (mi_results *tuple : tuples)
+				{
+					mi_free_bkpt(mi_get_bkpt(tuple));
+				}
+			});
+
+	mi_free_h(&handle);
+	return true;
+}
+
+/**
+ * This function measures the event parsers on a single console line of a
+ * megabyte, like the output of printing a large array. The line parser needs
+ * it framed and copied as a whole, the stream parser splits its text into
+ * events of at most @ref MI_EVENT_MAX_TEXT bytes.
+ */
+static void bench_long_line()
+{
+	string text = "~\"";
+	for (int i = 0; text.size() < (1 << 20); ++i)
+	{
+		text += "{a = " + std::to_string(i) + ", b = \\\"x\\\"}, ";
+	}
+	text += "\"\n(gdb)\n";
+	size_t events = 0;
+	measure("synthetic", "long_line_events", 1, text.size(),
+			[&text, &events]()
+			{
+				// the copy the line framer made
+				string line = text.substr(0, text.find('\n'));
+				events += parse_mi_event(&line[0]).index();
+			});
+	measure("synthetic", "long_line_event_stream", 1, text.size(),
+			[&text, &events]()
+			{
+				MiEventParser parser;
+				MiEvent event;
+				for (size_t pos = 0; pos < text.size(); pos += MAX_LENGTH)
+				{
+					parser.feed(text.data() + pos,
+								std::min((size_t)MAX_LENGTH, text.size() - pos));
+					while (parser.next(event))
+					{
+						events += event.index();
+					}
+				}
+			});
+	s_sink = events;
+}
+
+/**
+ * This function prints the help text.
+ */
+static void print_help()
+{
+	fprintf(stderr,
+			"Usage: ./parse_bench [OPTIONS] <transcript>...\n"
+			"  -t <ms>\t minimum duration of a measurement round (default %d)\n"
+			"  -h\t\t print this help\n",
+			PARSE_BENCH_DEFAULT_MS);
+}
+
+/// Entry point for the parser benchmark.
+/**
+ * This program measures the libmigdb parser on the given transcripts and
+ * prints one JSON line per measurement.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments.
+ *
+ * @return The exit state of the program.
+ */
+int main(const int argc, char **argv)
+{
+	int c;
+	opterr = 0;
+	while ((c = getopt(argc, argv, "ht:")) != -1)
+	{
+		switch (c)
+		{
+		case 't': // round duration
+			s_min_round_ns = strtoull(optarg, nullptr, 10) * 1000000;
+			break;
+		case 'h': // help
+			print_help();
+			return EXIT_SUCCESS;
+		default:
+			print_help();
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind == argc)
+	{
+		print_help();
+		return EXIT_FAILURE;
+	}
+	for (int i = optind; i < argc; ++i)
+	{
+		if (!bench_transcript(argv[i]))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	bench_long_line();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,277 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file simd_check.cpp
+ *
+ * @brief Differential check of the vectorised scanning of libmigdb.
+ *
+ * This file contains a check of the SSE2 and AVX2 implementations of
+ * mi_scan_cstr and mi_scan_chunk against the scalar ones. The scans are
+ * compared on generated strings at every alignment, whole responses of the
+ * transcripts and of generated stream records are parsed with every
+ * implementation and the resulting trees are compared.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "bench.hpp"
+#include "mi_gdb.h"
+
+using std::string;
+using std::vector;
+
+/// The maximum length of the generated strings.
+#define SIMD_CHECK_MAX_LENGTH 160
+/// The number of generated stream records.
+#define SIMD_CHECK_RECORDS 4000
+
+/// The implementations checked against the scalar one.
+static const int s_levels[] = {MI_SIMD_SSE2, MI_SIMD_AVX2};
+/// The names of the implementations.
+static const char *const s_level_names[] = {"scalar", "sse2", "avx2"};
+
+/**
+ * This function returns a random character, mostly plain text with the bytes
+ * the parser stops at mixed in.
+ *
+ * @param random The random number generator.
+ *
+ * @return The character, never 0.
+ */
+static char random_char(std::mt19937 &random)
+{
+	static const char special[] = "\"\\,]}n\n";
+	const unsigned value = random() % 100;
+	if (value < 9)
+	{
+		return special[value % (sizeof(special) - 1)];
+	}
+	if (value < 10)
+	{
+		return (char)(0x80 + random() % 0x80);
+	}
+	return (char)(' ' + random() % ('~' - ' '));
+}
+
+/**
+ * This function parses lines with the selected implementation and returns
+ * the parsed trees as text.
+ *
+ * @param[in] lines The lines.
+ *
+ * @param views Whether the handle parses in views mode.
+ *
+ * @return The parsed trees, one line per output.
+ */
+static string parse_all(const vector<string> &lines, const bool views)
+{
+	string dump;
+	mi_h *handle = mi_alloc_h();
+	if (views)
+	{
+		mi_use_views(handle);
+	}
+	for (string line : lines)
+	{
+		handle->line = &line[0];
+		if (0 == mi_get_response(handle))
+		{
+			if (0 == line.compare(0, 5, "(gdb)"))
+			{
+				dump += "error\n";
+			}
+			continue;
+		}
+		mi_output *response = mi_retire_response(handle);
+		bench_dump_output(response, dump);
+		mi_release_response(handle, response);
+	}
+	handle->line = nullptr;
+	mi_free_h(&handle);
+	return dump;
+}
+
+/**
+ * This function compares the scan of every implementation with the scalar
+ * one on generated strings, starting at every offset of an aligned buffer.
+ *
+ * @param level The checked implementation.
+ *
+ * @return The number of mismatches.
+ */
+static int check_scan(const int level)
+{
+	std::mt19937 random(level);
+	int mismatches = 0;
+	alignas(64) char buffer[SIMD_CHECK_MAX_LENGTH + 128];
+	for (int length = 0; length <= SIMD_CHECK_MAX_LENGTH; ++length)
+	{
+		for (int offset = 0; offset < 64; ++offset)
+		{
+			char *str = buffer + offset;
+			for (int i = 0; i < length; ++i)
+			{
+				str[i] = random_char(random);
+			}
+			str[length] = 0;
+			for (int start = 0; start <= length; ++start)
+			{
+				mi_set_simd(MI_SIMD_NONE);
+				const char *expected = mi_scan_cstr(str + start);
+				mi_set_simd(level);
+				if (mi_scan_cstr(str + start) != expected)
+				{
+					++mismatches;
+				}
+			}
+		}
+	}
+	return mismatches;
+}
+
+/**
+ * This function compares the chunk scan of every implementation with the
+ * scalar one on generated chunks, starting at every offset of an aligned
+ * buffer. The bytes behind a chunk are random, they must not be found.
+ *
+ * @param level The checked implementation.
+ *
+ * @return The number of mismatches.
+ */
+static int check_chunk(const int level)
+{
+	std::mt19937 random(level + 16);
+	int mismatches = 0;
+	alignas(64) char buffer[SIMD_CHECK_MAX_LENGTH + 128];
+	for (int length = 0; length <= SIMD_CHECK_MAX_LENGTH; ++length)
+	{
+		for (int offset = 0; offset < 64; ++offset)
+		{
+			char *str = buffer + offset;
+			for (int i = 0; i < length + 64; ++i)
+			{
+				str[i] = random_char(random);
+			}
+			for (int start = 0; start <= length; ++start)
+			{
+				mi_set_simd(MI_SIMD_NONE);
+				const char *expected = mi_scan_chunk(str + start, str + length);
+				mi_set_simd(level);
+				if (mi_scan_chunk(str + start, str + length) != expected)
+				{
+					++mismatches;
+				}
+			}
+		}
+	}
+	return mismatches;
+}
+
+/**
+ * This function generates console, target and log stream records with long
+ * strings full of escapes, quotes and delimiters.
+ *
+ * @return The records, each followed by a prompt.
+ */
+static vector<string> generate_records()
+{
+	std::mt19937 random(0);
+	vector<string> lines;
+	const char streams[] = "~@&";
+	for (int i = 0; i < SIMD_CHECK_RECORDS; ++i)
+	{
+		string line(1, streams[i % 3]);
+		line += '"';
+		const int length = random() % (4 * SIMD_CHECK_MAX_LENGTH);
+		for (int j = 0; j < length; ++j)
+		{
+			const char c = random_char(random);
+			if ('"' == c || '\\' == c)
+			{
+				line += '\\';
+			}
+			line += '\n' == c ? 'n' : c;
+		}
+		line += '"';
+		lines.push_back(line);
+		lines.push_back("(gdb)");
+	}
+	return lines;
+}
+
+/// Entry point for the differential check.
+/**
+ * This program checks every vectorised implementation supported by the CPU
+ * against the scalar one and prints the result to stderr.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments, the transcripts.
+ *
+ * @return @c EXIT_SUCCESS if all implementations match, @c EXIT_FAILURE
+ * otherwise.
+ */
+int main(const int argc, char **argv)
+{
+	vector<string> lines = generate_records();
+	for (int i = 1; i < argc; ++i)
+	{
+		string text;
+		if (!bench_read_file(argv[i], text))
+		{
+			return EXIT_FAILURE;
+		}
+		for (string &line : bench_split_lines(text))
+		{
+			lines.push_back(line);
+		}
+	}
+
+	const int best = mi_set_simd(-1);
+	mi_set_simd(MI_SIMD_NONE);
+	const string expected = parse_all(lines, false);
+	const string expected_views = parse_all(lines, true);
+	bool success = expected == expected_views;
+	if (!success)
+	{
+		fprintf(stderr, "simd_check: scalar views differ from copies\n");
+	}
+	for (const int level : s_levels)
+	{
+		if (level > best)
+		{
+			fprintf(stderr, "simd_check: %s not supported, skipped\n",
+					s_level_names[level]);
+			continue;
+		}
+		const int mismatches = check_scan(level) + check_chunk(level);
+		mi_set_simd(level);
+		const bool parse_ok = expected == parse_all(lines, false) &&
+							  expected_views == parse_all(lines, true);
+		fprintf(stderr, "simd_check: %s: %d scan mismatches, parse %s\n",
+				s_level_names[level], mismatches,
+				parse_ok ? "identical" : "DIFFERS");
+		success = success && 0 == mismatches && parse_ok;
+	}
+	mi_set_simd(best);
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
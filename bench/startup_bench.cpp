@@ -0,0 +1,363 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file startup_bench.cpp
+ *
+ * @brief Startup latency benchmark of the slave.
+ *
+ * This file contains a benchmark of the time from launching the slaves until
+ * their GDB instances report the stop at main to the master. socat and GDB are
+ * replaced by the fake tools, so the measurement covers the slave itself: the
+ * forks, the connections and the polling for the PTYs.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+
+using std::string;
+using std::vector;
+
+/// The time to wait for the slaves of a round in nanoseconds.
+#define STARTUP_BENCH_TIMEOUT (10 * (std::uint64_t)1000000000)
+/// The number of attempts to bind a port.
+#define STARTUP_BENCH_BIND_ATTEMPTS 300
+/// The size of the receive buffer in bytes.
+#define STARTUP_BENCH_BUFFER_SIZE 8192
+
+/**
+ * This function opens a listening socket on a port of the loopback device.
+ * The connections of the previous round may still be closing, so binding is
+ * retried for a while.
+ *
+ * @param port The TCP port.
+ *
+ * @return The socket, or @c -1 on error.
+ */
+static int listen_on(const int port)
+{
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	for (int attempt = 0; attempt < STARTUP_BENCH_BIND_ATTEMPTS; ++attempt)
+	{
+		const int sock = socket(AF_INET, SOCK_STREAM, 0);
+		const int enable = 1;
+		setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+		if (0 == bind(sock, (sockaddr *)&addr, sizeof(addr)) &&
+			0 == listen(sock, 1))
+		{
+			return sock;
+		}
+		close(sock);
+		usleep(10000);
+	}
+	perror("listen");
+	return -1;
+}
+
+/**
+ * This function starts a slave with the fake tools in front of the PATH.
+ *
+ * @param[in] slave_path The path of the slave executable.
+ *
+ * @param[in] path The PATH for the slave.
+ *
+ * @param rank The rank of the slave.
+ *
+ * @param num_processes The number of slaves.
+ *
+ * @param base_port The base port.
+ *
+ * @return The PID of the slave.
+ */
+static pid_t start_slave(const char *slave_path, const string &path,
+						 const int rank, const int num_processes,
+						 const int base_port)
+{
+	const pid_t pid = fork();
+	if (0 == pid)
+	{
+		const string rank_str = std::to_string(rank);
+		const string size_str = std::to_string(num_processes);
+		const string port_str = std::to_string(base_port);
+		setenv("PATH", path.c_str(), 1);
+		execl(slave_path, "pgdbslave", "-i", "127.0.0.1", "-p",
+			  port_str.c_str(), "-r", rank_str.c_str(), "-s", size_str.c_str(),
+			  "/bin/true", (char *)nullptr);
+		perror("exec pgdbslave");
+		_exit(127);
+	}
+	return pid;
+}
+
+/**
+ * This function runs a single round: it starts the slaves and waits until all
+ * of them have reported the stop at main.
+ *
+ * @param[in] slave_path The path of the slave executable.
+ *
+ * @param[in] path The PATH for the slaves.
+ *
+ * @param num_processes The number of slaves.
+ *
+ * @param base_port The base port.
+ *
+ * @param[out] latencies The time until each slave reported the stop, in
+ * milliseconds.
+ *
+ * @return The time until all slaves reported the stop in milliseconds, or a
+ * negative value on error.
+ */
+static double run_round(const char *slave_path, const string &path,
+						const int num_processes, const int base_port,
+						vector<double> &latencies)
+{
+	const int num_ports = 2 * num_processes;
+	vector<pollfd> fds(2 * num_ports);
+	for (int idx = 0; idx < num_ports; ++idx)
+	{
+		fds[idx] = {listen_on(base_port + idx), POLLIN, 0};
+		fds[num_ports + idx] = {-1, POLLIN, 0};
+		if (fds[idx].fd < 0)
+		{
+			return -1.0;
+		}
+	}
+
+	const std::uint64_t start = bench_now();
+	vector<pid_t> pids;
+	for (int rank = 0; rank < num_processes; ++rank)
+	{
+		pids.push_back(start_slave(slave_path, path, rank, num_processes,
+								   base_port));
+	}
+
+	vector<string> received(num_processes);
+	int num_ready = 0;
+	double all_ready = -1.0;
+	char buffer[STARTUP_BENCH_BUFFER_SIZE];
+	while (num_ready < num_processes)
+	{
+		const std::uint64_t elapsed = bench_now() - start;
+		if (elapsed >= STARTUP_BENCH_TIMEOUT ||
+			poll(fds.data(), fds.size(),
+				 (STARTUP_BENCH_TIMEOUT - elapsed) / 1000000 + 1) < 0)
+		{
+			fprintf(stderr, "Only %d of %d slaves started.\n", num_ready,
+					num_processes);
+			break;
+		}
+		for (int idx = 0; idx < num_ports; ++idx)
+		{
+			if (0 != fds[idx].revents)
+			{
+				fds[num_ports + idx].fd = accept(fds[idx].fd, nullptr, nullptr);
+				close(fds[idx].fd);
+				fds[idx].fd = -1;
+			}
+			pollfd &conn = fds[num_ports + idx];
+			if (conn.fd < 0 || 0 == conn.revents)
+			{
+				continue;
+			}
+			const ssize_t length = read(conn.fd, buffer, sizeof(buffer));
+			if (length <= 0)
+			{
+				close(conn.fd);
+				conn.fd = -1;
+				continue;
+			}
+			if (idx >= num_processes)
+			{
+				continue; // target output
+			}
+			string &text = received[idx];
+			const bool was_ready = string::npos != text.find("*stopped");
+			text.append(buffer, length);
+			const size_t stopped = text.find("*stopped");
+			if (!was_ready && string::npos != stopped &&
+				string::npos != text.find("(gdb)", stopped))
+			{
+				latencies.push_back((bench_now() - start) / 1e6);
+				if (++num_ready == num_processes)
+				{
+					all_ready = latencies.back();
+				}
+			}
+		}
+	}
+
+	// closing the connections ends the fake tools
+	for (pollfd &fd : fds)
+	{
+		if (fd.fd >= 0)
+		{
+			close(fd.fd);
+		}
+	}
+	for (const pid_t pid : pids)
+	{
+		kill(pid, SIGKILL);
+		waitpid(pid, nullptr, 0);
+	}
+	// the next round must not find the PTY links of this one
+	for (int rank = 0; rank < num_processes; ++rank)
+	{
+		char links[2][32];
+		snprintf(links[0], sizeof(links[0]), "/tmp/ttyGDB%04d", rank);
+		snprintf(links[1], sizeof(links[1]), "/tmp/ttyTRGT%04d", rank);
+		for (const char *link : links)
+		{
+			for (int i = 0; i < 1000 && std::filesystem::is_symlink(link); ++i)
+			{
+				usleep(1000);
+			}
+			unlink(link);
+		}
+	}
+	return all_ready;
+}
+
+/**
+ * This function returns a percentile of sorted values.
+ *
+ * @param[in] values The sorted values.
+ *
+ * @param fraction The percentile as fraction.
+ *
+ * @return The percentile.
+ */
+static double percentile(const vector<double> &values, const double fraction)
+{
+	return values[(size_t)(fraction * (values.size() - 1) + 0.5)];
+}
+
+/**
+ * This function prints the help text.
+ */
+static void print_help()
+{
+	fprintf(stderr,
+			"Usage: ./startup_bench [OPTIONS]\n"
+			"  -n <num>\t number of slaves (default 8)\n"
+			"  -r <num>\t number of rounds (default 5)\n"
+			"  -p <port>\t the base port (default 45000)\n"
+			"  -s <path>\t path of pgdbslave (default ../bin/pgdbslave)\n"
+			"  -d <dir>\t directory of the fake socat and gdb\n"
+			"  -h\t\t print this help\n");
+}
+
+/// Entry point for the startup benchmark.
+/**
+ * This program starts the slaves several times and prints the distribution of
+ * their startup latencies as JSON line.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments.
+ *
+ * @return The exit state of the program.
+ */
+int main(const int argc, char **argv)
+{
+	int num_processes = 8;
+	int rounds = 5;
+	int base_port = 45000;
+	const char *slave_path = "../bin/pgdbslave";
+	string tools_dir = "../bin/bench/fake";
+	int c;
+	opterr = 0;
+	while ((c = getopt(argc, argv, "hn:r:p:s:d:")) != -1)
+	{
+		switch (c)
+		{
+		case 'n': // number of slaves
+			num_processes = atoi(optarg);
+			break;
+		case 'r': // rounds
+			rounds = atoi(optarg);
+			break;
+		case 'p': // port
+			base_port = atoi(optarg);
+			break;
+		case 's': // slave
+			slave_path = optarg;
+			break;
+		case 'd': // fake tools
+			tools_dir = optarg;
+			break;
+		case 'h': // help
+			print_help();
+			return EXIT_SUCCESS;
+		default:
+			print_help();
+			return EXIT_FAILURE;
+		}
+	}
+	if (num_processes <= 0 || rounds <= 0 || base_port <= 0 ||
+		base_port + 2 * num_processes > 0x10000)
+	{
+		print_help();
+		return EXIT_FAILURE;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	const char *env_path = getenv("PATH");
+	const string path = std::filesystem::absolute(tools_dir).string() + ":" +
+						(env_path ? env_path : "/usr/bin:/bin");
+	vector<double> latencies;
+	vector<double> all_ready;
+	for (int round = 0; round < rounds; ++round)
+	{
+		const double time =
+			run_round(slave_path, path, num_processes, base_port, latencies);
+		if (time < 0.0)
+		{
+			return EXIT_FAILURE;
+		}
+		all_ready.push_back(time);
+	}
+	std::sort(latencies.begin(), latencies.end());
+	std::sort(all_ready.begin(), all_ready.end());
+	BenchRecord("startup", "pgdbslave")
+		.add("processes", num_processes)
+		.add("rounds", rounds)
+		.add("ready_ms_min", latencies.front())
+		.add("ready_ms_median", percentile(latencies, 0.5))
+		.add("ready_ms_p90", percentile(latencies, 0.9))
+		.add("ready_ms_max", latencies.back())
+		.add("all_ready_ms_median", percentile(all_ready, 0.5))
+		.print();
+	return EXIT_SUCCESS;
+}
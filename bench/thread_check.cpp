@@ -0,0 +1,267 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file thread_check.cpp
+ *
+ * @brief Concurrent stress check of libmigdb.
+ *
+ * This file contains a check that libmigdb handles can be used on different
+ * threads at the same time. Thousands of emulated ranks, each with its own
+ * handle and transcript, are parsed by several threads, interleaving the
+ * lines of their ranks like the parse pool does, while another thread
+ * switches the string scanning implementation. The parse trees, extracted
+ * stops and breakpoints and the error state of every handle must equal those
+ * of a single-threaded run. Built with ThreadSanitizer (make tsan), the check
+ * must not report any race.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+
+#include "bench.hpp"
+#include "mi_gdb.h"
+
+using std::string;
+using std::vector;
+
+/// The default number of emulated ranks.
+#define THREAD_CHECK_RANKS 2048
+
+/// An emulated rank.
+struct Rank
+{
+	/** The handle of the rank. */
+	mi_h *handle;
+	/** The lines of the transcript of the rank. */
+	const vector<string> *lines;
+	/** The parsed responses and the handle state as text. */
+	string dump;
+};
+
+/**
+ * This function passes a line to the handle of a rank and appends the parsed
+ * response, its stop and breakpoint and the error state of the handle to the
+ * dump of the rank once the response is complete.
+ *
+ * @param[in] rank The rank.
+ *
+ * @param[in] line The line.
+ */
+static void feed(Rank &rank, const string &line)
+{
+	mi_h *handle = rank.handle;
+	// the handle does not modify the line, views parse a copy
+	handle->line = const_cast<char *>(line.c_str());
+	const int complete = mi_get_response(handle);
+	handle->line = nullptr;
+	if (0 == complete)
+	{
+		return;
+	}
+	mi_output *response = mi_retire_response(handle);
+	bench_dump_output(response, rank.dump);
+	mi_stop *stop = mi_res_stop(response);
+	if (nullptr != stop)
+	{
+		rank.dump += "stop:" + std::to_string(stop->reason) + "," +
+					 std::to_string(stop->bkptno) + "," +
+					 std::to_string(nullptr != stop->frame
+										? stop->frame->line
+										: 0) +
+					 "\n";
+		mi_free_stop(stop);
+	}
+	mi_bkpt *bkpt = mi_res_bkpt(response);
+	if (nullptr != bkpt)
+	{
+		rank.dump += "bkpt:" + std::to_string(bkpt->number) + "\n";
+		mi_free_bkpt(bkpt);
+	}
+	mi_release_response(handle, response);
+	rank.dump += "error:" + std::to_string(handle->error) + "," +
+				 mi_get_error_str(handle) + "," +
+				 (nullptr != handle->error_from_gdb ? handle->error_from_gdb
+													: "") +
+				 "\n";
+}
+
+/**
+ * This function parses the transcripts of a set of ranks, one line of every
+ * rank after the other.
+ *
+ * @param[in] ranks The ranks.
+ *
+ * @param first The first rank of the thread.
+ *
+ * @param step The distance between the ranks of the thread.
+ */
+static void parse_ranks(vector<Rank> &ranks, const size_t first,
+						const size_t step)
+{
+	for (size_t line = 0;; ++line)
+	{
+		bool pending = false;
+		for (size_t i = first; i < ranks.size(); i += step)
+		{
+			Rank &rank = ranks[i];
+			if (line < rank.lines->size())
+			{
+				feed(rank, (*rank.lines)[line]);
+				pending = true;
+			}
+		}
+		if (!pending)
+		{
+			return;
+		}
+	}
+}
+
+/**
+ * This function prints the help text.
+ */
+static void print_help()
+{
+	fprintf(stderr,
+			"usage: thread_check [-r ranks] [-w workers] transcript...\n"
+			"  -r ranks    number of emulated ranks (default %d)\n"
+			"  -w workers  number of parsing threads (default: cores, "
+			"at least 4)\n",
+			THREAD_CHECK_RANKS);
+}
+
+/// Entry point for the concurrent check.
+/**
+ * This program parses the transcripts of the emulated ranks on several
+ * threads, compares the result of every rank with a single-threaded run and
+ * prints the result to stderr.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments.
+ *
+ * @return @c EXIT_SUCCESS if every rank matches, @c EXIT_FAILURE otherwise.
+ */
+int main(const int argc, char **argv)
+{
+	int num_ranks = THREAD_CHECK_RANKS;
+	int num_workers = std::thread::hardware_concurrency();
+	num_workers = num_workers < 4 ? 4 : num_workers;
+	int opt;
+	while (-1 != (opt = getopt(argc, argv, "r:w:h")))
+	{
+		switch (opt)
+		{
+		case 'r':
+			num_ranks = atoi(optarg);
+			break;
+		case 'w':
+			num_workers = atoi(optarg);
+			break;
+		default:
+			print_help();
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind >= argc || 0 >= num_ranks || 0 >= num_workers)
+	{
+		print_help();
+		return EXIT_FAILURE;
+	}
+	vector<vector<string>> transcripts;
+	for (int i = optind; i < argc; ++i)
+	{
+		string text;
+		if (!bench_read_file(argv[i], text))
+		{
+			return EXIT_FAILURE;
+		}
+		transcripts.push_back(bench_split_lines(text));
+	}
+
+	// rank i parses transcript i % T in configuration i / T % CONFIGS, so
+	// the result of rank i is that of reference[i % reference.size()]
+	const size_t num_transcripts = transcripts.size();
+	vector<Rank> reference;
+	for (int config = 0; config < BENCH_HANDLE_CONFIGS; ++config)
+	{
+		for (const vector<string> &lines : transcripts)
+		{
+			reference.push_back(Rank{bench_open_handle(config), &lines, ""});
+		}
+	}
+	parse_ranks(reference, 0, 1);
+
+	vector<Rank> ranks;
+	for (int i = 0; i < num_ranks; ++i)
+	{
+		const int config = i / num_transcripts % BENCH_HANDLE_CONFIGS;
+		ranks.push_back(Rank{bench_open_handle(config),
+							 &transcripts[i % num_transcripts], ""});
+	}
+	const int best = mi_set_simd(-1);
+	std::atomic<bool> done(false);
+	std::thread switcher(
+		[&done, best]()
+		{
+			for (int level = MI_SIMD_NONE; !done.load();
+				 level = MI_SIMD_NONE == level ? best : MI_SIMD_NONE)
+			{
+				mi_set_simd(level);
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+		});
+	const std::uint64_t start = bench_now();
+	vector<std::thread> workers;
+	for (int worker = 0; worker < num_workers; ++worker)
+	{
+		workers.emplace_back(parse_ranks, std::ref(ranks), worker, num_workers);
+	}
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+	const std::uint64_t elapsed = bench_now() - start;
+	done = true;
+	switcher.join();
+	mi_set_simd(best);
+
+	int mismatches = 0;
+	for (size_t i = 0; i < ranks.size(); ++i)
+	{
+		if (ranks[i].dump != reference[i % reference.size()].dump)
+		{
+			++mismatches;
+		}
+		mi_free_h(&ranks[i].handle);
+	}
+	for (Rank &rank : reference)
+	{
+		mi_free_h(&rank.handle);
+	}
+	fprintf(stderr,
+			"thread_check: %d ranks on %d threads in %.0f ms, %d mismatches\n",
+			num_ranks, num_workers, elapsed / 1e6, mismatches);
+	return 0 == mismatches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -26,23 +26,114 @@
 	Module: Allocator.
 	Comments:
 	Most alloc/free routines are here. Free routines must accept NULL
-	pointers. Alloc functions must set mi_error.@p
+	pointers. Alloc functions of a parser must set its error.@p
 
 ***************************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "mi_gdb.h"
 
-void *mi_calloc(size_t count, size_t sz)
+/* Size of the arena blocks, enough for most responses. */
+#define MI_ARENA_BLOCK_SIZE 8192
+/* Alignment of the arena allocations. */
+#define MI_ARENA_ALIGN sizeof(void *)
+
+/*****************************************************************************
+  Arena
+  The output of a response is allocated with a bump allocator. Freeing the
+  output is a no-op, the memory is reclaimed at once by resetting the arena.
+  The blocks are kept, so in the steady state no memory is allocated at all.
+*****************************************************************************/
+
+static mi_arena_block *mi_arena_new_block(size_t sz)
 {
-	void *res = calloc(count, sz);
-	if (!res)
-		mi_error = MI_OUT_OF_MEMORY;
+	size_t size = sz > MI_ARENA_BLOCK_SIZE ? sz : MI_ARENA_BLOCK_SIZE;
+	mi_arena_block *b = (mi_arena_block *)malloc(sizeof(mi_arena_block) + size);
+	if (!b)
+		return NULL;
+	b->next = NULL;
+	b->size = size;
+	return b;
+}
+
+static void mi_arena_enter(mi_arena *a, mi_arena_block *b)
+{
+	a->cur = b;
+	a->pos = (char *)(b + 1);
+	a->end = a->pos + b->size;
+}
+
+void *mi_arena_alloc(mi_arena *a, size_t sz)
+{
+	sz = (sz + MI_ARENA_ALIGN - 1) & ~(MI_ARENA_ALIGN - 1);
+	if ((size_t)(a->end - a->pos) < sz)
+	{
+		/* Continue in the next kept block which is large enough. */
+		mi_arena_block *b = a->cur ? a->cur->next : a->first;
+		while (b && b->size < sz)
+			b = b->next;
+		if (!b)
+		{
+			b = mi_arena_new_block(sz);
+			if (!b)
+				return NULL;
+			if (a->first)
+			{
+				mi_arena_block *last = a->cur ? a->cur : a->first;
+				while (last->next)
+					last = last->next;
+				last->next = b;
+			}
+			else
+				a->first = b;
+		}
+		mi_arena_enter(a, b);
+	}
+	void *res = a->pos;
+	a->pos += sz;
 	return res;
 }
 
+void mi_arena_reset(mi_arena *a)
+{
+	a->cur = NULL;
+	a->pos = a->end = NULL;
+}
+
+int mi_use_arena(mi_h *h)
+{
+	if (h->arena)
+		return 1;
+	/* The first block is allocated with the first output. */
+	h->arena = (mi_arena *)calloc(1, sizeof(mi_arena));
+	if (!h->arena)
+	{
+		h->error = MI_OUT_OF_MEMORY;
+		return 0;
+	}
+	return 1;
+}
+
+int mi_use_views(mi_h *h)
+{
+	if (!mi_use_arena(h))
+		return 0;
+	h->views = 1;
+	return 1;
+}
+
+/*****************************************************************************
+  Alloc functions
+*****************************************************************************/
+
+void *mi_calloc(size_t count, size_t sz)
+{
+	return calloc(count, sz);
+}
+
 void *mi_calloc1(size_t sz)
 {
 	return mi_calloc(1, sz);
@@ -50,21 +141,40 @@ void *mi_calloc1(size_t sz)
 
 char *mi_malloc(size_t sz)
 {
-	char *res = (char *)malloc(sz);
+	return (char *)malloc(sz);
+}
+
+void *mi_parser_calloc(mi_parser *p, size_t sz)
+{
+	void *res;
+	if (p->arena)
+	{
+		res = mi_arena_alloc(p->arena, sz);
+		if (res)
+			memset(res, 0, sz);
+	}
+	else
+		res = calloc(1, sz);
+	if (!res)
+		p->error = MI_OUT_OF_MEMORY;
+	return res;
+}
+
+char *mi_parser_malloc(mi_parser *p, size_t sz)
+{
+	char *res;
+	if (p->arena)
+		res = (char *)mi_arena_alloc(p->arena, sz);
+	else
+		res = (char *)malloc(sz);
 	if (!res)
-		mi_error = MI_OUT_OF_MEMORY;
+		p->error = MI_OUT_OF_MEMORY;
 	return res;
 }
 
 mi_h *mi_alloc_h()
 {
-	mi_h *h = (mi_h *)calloc(1, sizeof(mi_h));
-	if (!h)
-	{
-		mi_error = MI_OUT_OF_MEMORY;
-		return NULL;
-	}
-	return h;
+	return (mi_h *)calloc(1, sizeof(mi_h));
 }
 
 mi_results *mi_alloc_results(void)
@@ -77,6 +187,22 @@ mi_output *mi_alloc_output(void)
 	return (mi_output *)mi_calloc1(sizeof(mi_output));
 }
 
+mi_results *mi_parser_alloc_results(mi_parser *p)
+{
+	mi_results *r = (mi_results *)mi_parser_calloc(p, sizeof(mi_results));
+	if (r)
+		r->arena = p->arena != NULL;
+	return r;
+}
+
+mi_output *mi_parser_alloc_output(mi_parser *p)
+{
+	mi_output *o = (mi_output *)mi_parser_calloc(p, sizeof(mi_output));
+	if (o)
+		o->arena = p->arena != NULL;
+	return o;
+}
+
 mi_frames *mi_alloc_frames(void)
 {
 	return (mi_frames *)mi_calloc1(sizeof(mi_frames));
@@ -136,11 +262,27 @@ void mi_free_h(mi_h **handle)
 {
 	mi_h *h = *handle;
 	free(h->line);
+	free(h->error_from_gdb);
 	mi_free_output(h->po);
+	mi_free_arena(h->arena);
 	free(h);
 	*handle = NULL;
 }
 
+void mi_free_arena(mi_arena *a)
+{
+	if (!a)
+		return;
+	mi_arena_block *b = a->first;
+	while (b)
+	{
+		mi_arena_block *aux = b->next;
+		free(b);
+		b = aux;
+	}
+	free(a);
+}
+
 void mi_free_frames(mi_frames *f)
 {
 	mi_frames *aux;
@@ -219,6 +361,11 @@ void mi_free_results_but(mi_results *r, mi_results *no)
 			r->next = NULL;
 			r = aux;
 		}
+		else if (r->arena)
+		{
+			/* Reclaimed by resetting the arena. */
+			r = r->next;
+		}
 		else
 		{
 			free(r->var);
@@ -256,6 +403,11 @@ void mi_free_output_but(mi_output *r, mi_output *no, mi_results *no_r)
 			r->next = NULL;
 			r = aux;
 		}
+		else if (r->arena)
+		{
+			/* Reclaimed by resetting the arena. */
+			r = r->next;
+		}
 		else
 		{
 			if (r->c)
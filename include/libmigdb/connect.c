@@ -42,9 +42,6 @@ in a row.
 
 #include "mi_gdb.h"
 
-int mi_error = MI_OK;
-char *mi_error_from_gdb = NULL;
-
 char *get_cstr(mi_output *o)
 {
 	if (!o->c || o->c->type != t_const)
@@ -52,6 +49,11 @@ char *get_cstr(mi_output *o)
 	return o->c->v.cstr;
 }
 
+void mi_subscribe(mi_h *h, int records)
+{
+	h->skip = MI_REC_ALL & ~records;
+}
+
 int mi_get_response(mi_h *h)
 {
 	if (strncmp(h->line, "(gdb)", 5) == 0)
@@ -62,18 +64,37 @@ int mi_get_response(mi_h *h)
 	{
 		/* Add to the response. */
 		mi_output *o;
-		o = mi_parse_gdb_output(h->line);
+		mi_parser p = {h->arena, h->views, MI_OK};
+		const char *line = h->line;
+		if (h->views)
+		{
+			/* Parse a copy in the arena, the strings reference it. */
+			size_t len = strlen(line) + 1;
+			char *copy = (char *)mi_arena_alloc(h->arena, len);
+			if (!copy)
+			{
+				h->error = MI_OUT_OF_MEMORY;
+				return 0;
+			}
+			memcpy(copy, line, len);
+			line = copy;
+		}
+		o = mi_parse_gdb_output_skip(&p, line, h->skip);
 
 		if (!o)
+		{
+			h->error = p.error;
 			return 0;
+		}
 		if (o->type == MI_T_RESULT_RECORD && o->tclass == MI_CL_ERROR)
 		{
 			/* Error from gdb, record it. */
-			mi_error = MI_FROM_GDB;
-			free(mi_error_from_gdb);
-			mi_error_from_gdb = NULL;
-			if (o->c && strcmp(o->c->var, "msg") == 0 && o->c->type == t_const)
-				mi_error_from_gdb = strdup(o->c->v.cstr);
+			h->error = MI_FROM_GDB;
+			free(h->error_from_gdb);
+			h->error_from_gdb = NULL;
+			if (o->c && o->c->var && strcmp(o->c->var, "msg") == 0 &&
+				o->c->type == t_const)
+				h->error_from_gdb = strdup(o->c->v.cstr);
 		}
 		int is_exit = (o->type == MI_T_RESULT_RECORD && o->tclass == MI_CL_EXIT);
 		/* Add to the list of responses. */
@@ -97,6 +118,17 @@ mi_output *mi_retire_response(mi_h *h)
 	return ret;
 }
 
+void mi_release_response(mi_h *h, mi_output *r)
+{
+	if (h->arena)
+	{
+		/* The whole response is in the arena, so is nothing else. */
+		mi_arena_reset(h->arena);
+		return;
+	}
+	mi_free_output(r);
+}
+
 mi_output *mi_get_response_blk(mi_h *h)
 {
 	// non-blocking now ...
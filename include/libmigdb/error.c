@@ -31,7 +31,7 @@
 
 #include "mi_gdb.h"
 
-static const char *error_strs[] = {
+static const char *const error_strs[] = {
 	"Ok",
 	"Out of memory",
 	"Pipe creation",
@@ -47,9 +47,9 @@ static const char *error_strs[] = {
 	"Failed to create temporal",
 	"Can't execute the debugger"};
 
-const char *mi_get_error_str()
+const char *mi_get_error_str(const mi_h *h)
 {
-	if (mi_error < 0 || mi_error > MI_LAST_ERROR)
+	if (h->error < 0 || h->error > MI_LAST_ERROR)
 		return "Unknown";
-	return error_strs[mi_error];
+	return error_strs[h->error];
 }
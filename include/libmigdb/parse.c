@@ -30,14 +30,14 @@
 
 ***************************************************************************/
 
-#include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include "mi_gdb.h"
 
-mi_results *mi_get_result(const char *str, const char **end);
-int mi_get_value(mi_results *r, const char *str, const char **end);
+mi_results *mi_get_result(mi_parser *p, const char *str, const char **end);
+int mi_get_value(mi_parser *p, mi_results *r, const char *str,
+				 const char **end);
 
 /* GDB BUG!!!! I got:
 ^error,msg="Problem parsing arguments: data-evaluate-expression ""1+2"""
@@ -54,39 +54,89 @@ static inline int EndOfStr(const char *s)
 	return 0;
 }
 
-int mi_get_cstring_r(mi_results *r, const char *str, const char **end)
+/* Find the closing quote of a c-string, scanning the runs between quotes
+   and escapes at once. Returns NULL for unterminated strings. */
+static const char *mi_cstring_end(const char *s, int *escaped)
 {
-	const char *s;
+	for (;;)
+	{
+		s = mi_scan_cstr(s);
+		if (*s == '\\')
+		{
+			if (!s[1])
+				return NULL;
+			*escaped = 1;
+			s += 2;
+		}
+		else if (!*s)
+			return NULL;
+		else if (EndOfStr(s))
+			return s;
+		else
+			s++;
+	}
+}
+
+int mi_get_cstring_r(mi_parser *p, mi_results *r, const char *str,
+					 const char **end)
+{
+	const char *s, *e, *q;
 	char *d;
 	int len;
+	int escaped = 0;
 
 	if (*str != '"')
 	{
-		mi_error = MI_PARSER;
+		p->error = MI_PARSER;
 		return 0;
 	}
 	str++;
-	/* Meassure. */
-	for (s = str, len = 0; *s && !EndOfStr(s); s++)
+	q = mi_cstring_end(str, &escaped);
+	if (!q)
 	{
-		if (*s == '\\')
+		p->error = MI_PARSER;
+		return 0;
+	}
+	/* The unescaped string is never longer. */
+	len = q - str;
+	r->type = t_const;
+	if (p->views)
+	{
+		/* Reference the line. The closing quote becomes the terminator, escaped
+		   strings shrink, so they are unescaped in place. */
+		d = r->v.cstr = (char *)str;
+		if (!escaped)
 		{
-			if (!*s)
-			{
-				mi_error = MI_PARSER;
-				return 0;
-			}
-			s++;
+			d[len] = 0;
+			if (end)
+				*end = q + 1;
+			return 1;
 		}
-		len++;
 	}
-	/* Copy. */
-	r->type = t_const;
-	d = r->v.cstr = mi_malloc(len + 1);
-	if (!r->v.cstr)
-		return 0;
-	for (s = str; *s && !EndOfStr(s); s++, d++)
+	else
 	{
+		/* Copy. */
+		d = r->v.cstr = mi_parser_malloc(p, len + 1);
+		if (!r->v.cstr)
+			return 0;
+		if (!escaped)
+		{
+			memcpy(d, str, len);
+			d[len] = 0;
+			if (end)
+				*end = q + 1;
+			return 1;
+		}
+	}
+	/* Unescape, copying the runs in between. */
+	for (s = str; s < q;)
+	{
+		e = mi_scan_cstr(s);
+		memmove(d, s, e - s);
+		d += e - s;
+		s = e;
+		if (s == q)
+			break;
 		if (*s == '\\')
 		{
 			s++;
@@ -104,10 +154,12 @@ int mi_get_cstring_r(mi_results *r, const char *str, const char **end)
 		}
 		else
 			*d = *s;
+		s++;
+		d++;
 	}
 	*d = 0;
 	if (end)
-		*end = s + 1;
+		*end = q + 1;
 
 	return 1;
 }
@@ -116,10 +168,12 @@ int mi_get_cstring_r(mi_results *r, const char *str, const char **end)
    I'll assume a-zA-Z0-9_- */
 inline int mi_is_var_name_char(char c)
 {
-	return isalnum(c) || c == '-' || c == '_';
+	/* Not isalnum, it depends on the locale. */
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+		   (c >= '0' && c <= '9') || c == '-' || c == '_';
 }
 
-char *mi_get_var_name(const char *str, const char **end)
+char *mi_get_var_name(mi_parser *p, const char *str, const char **end)
 {
 	const char *s;
 	char *r;
@@ -130,6 +184,12 @@ char *mi_get_var_name(const char *str, const char **end)
 	if (*start == '"')
 	{
 		for (start++; *start && *start != '"'; start++) {}
+		/* Skip the closing quote and the comma, not the terminator. */
+		if (!*start || !start[1])
+		{
+			p->error = MI_PARSER;
+			return NULL;
+		}
 		start += 2;
 	}
 	/* Meassure. */
@@ -137,12 +197,21 @@ char *mi_get_var_name(const char *str, const char **end)
 		;
 	if (*s != '=')
 	{
-		mi_error = MI_PARSER;
+		p->error = MI_PARSER;
 		return NULL;
 	}
-	/* Allocate. */
 	l = s - str;
-	r = mi_malloc(l + 1);
+	if (p->views)
+	{
+		/* Reference the line, the '=' becomes the terminator. */
+		r = (char *)str;
+		r[l] = 0;
+		if (end)
+			*end = s + 1;
+		return r;
+	}
+	/* Allocate. */
+	r = mi_parser_malloc(p, l + 1);
 	/* Copy. */
 	memcpy(r, str, l);
 	r[l] = 0;
@@ -151,14 +220,18 @@ char *mi_get_var_name(const char *str, const char **end)
 	return r;
 }
 
-int mi_get_list_res(mi_results *r, const char *str, const char **end, char closeC)
+int mi_get_list_res(mi_parser *p, mi_results *r, const char *str,
+					const char **end, char closeC)
 {
 	mi_results *last_r, *rs;
 
 	last_r = NULL;
 	do
 	{
-		rs = mi_get_result(str, &str);
+		rs = mi_get_result(p, str, &str);
+		/* Don't lose the results parsed so far. */
+		if (!rs)
+			return 0;
 		if (last_r)
 			last_r->next = rs;
 		else
@@ -174,20 +247,21 @@ int mi_get_list_res(mi_results *r, const char *str, const char **end, char close
 		str++;
 	} while (1);
 
-	mi_error = MI_PARSER;
+	p->error = MI_PARSER;
 	return 0;
 }
 
 #ifdef __APPLE__
-int mi_get_tuple_val(mi_results *r, const char *str, const char **end)
+int mi_get_tuple_val(mi_parser *p, mi_results *r, const char *str,
+					 const char **end)
 {
 	mi_results *last_r, *rs;
 
 	last_r = NULL;
 	do
 	{
-		rs = mi_alloc_results();
-		if (!rs || !mi_get_value(rs, str, &str))
+		rs = mi_parser_alloc_results(p);
+		if (!rs || !mi_get_value(p, rs, str, &str))
 		{
 			mi_free_results(rs);
 			return 0;
@@ -209,16 +283,16 @@ int mi_get_tuple_val(mi_results *r, const char *str, const char **end)
 		str++;
 	} while (1);
 
-	mi_error = MI_PARSER;
+	p->error = MI_PARSER;
 	return 0;
 }
 #endif /* __APPLE__ */
 
-int mi_get_tuple(mi_results *r, const char *str, const char **end)
+int mi_get_tuple(mi_parser *p, mi_results *r, const char *str, const char **end)
 {
 	if (*str != '{')
 	{
-		mi_error = MI_PARSER;
+		p->error = MI_PARSER;
 		return 0;
 	}
 	r->type = t_tuple;
@@ -230,22 +304,23 @@ int mi_get_tuple(mi_results *r, const char *str, const char **end)
 	}
 #ifdef __APPLE__
 	if (mi_is_var_name_char(*str))
-		return mi_get_list_res(r, str, end, '}');
-	return mi_get_tuple_val(r, str, end);
+		return mi_get_list_res(p, r, str, end, '}');
+	return mi_get_tuple_val(p, r, str, end);
 #else  /* __APPLE__ */
-	return mi_get_list_res(r, str, end, '}');
+	return mi_get_list_res(p, r, str, end, '}');
 #endif /* __APPLE__ */
 }
 
-int mi_get_list_val(mi_results *r, const char *str, const char **end)
+int mi_get_list_val(mi_parser *p, mi_results *r, const char *str,
+					 const char **end)
 {
 	mi_results *last_r, *rs;
 
 	last_r = NULL;
 	do
 	{
-		rs = mi_alloc_results();
-		if (!rs || !mi_get_value(rs, str, &str))
+		rs = mi_parser_alloc_results(p);
+		if (!rs || !mi_get_value(p, rs, str, &str))
 		{
 			mi_free_results(rs);
 			return 0;
@@ -267,15 +342,15 @@ int mi_get_list_val(mi_results *r, const char *str, const char **end)
 		str++;
 	} while (1);
 
-	mi_error = MI_PARSER;
+	p->error = MI_PARSER;
 	return 0;
 }
 
-int mi_get_list(mi_results *r, const char *str, const char **end)
+int mi_get_list(mi_parser *p, mi_results *r, const char *str, const char **end)
 {
 	if (*str != '[')
 	{
-		mi_error = MI_PARSER;
+		p->error = MI_PARSER;
 		return 0;
 	}
 	r->type = t_list;
@@ -287,43 +362,45 @@ int mi_get_list(mi_results *r, const char *str, const char **end)
 	}
 	/* Comment: I think they could choose () for values. Is confusing in this way. */
 	if (mi_is_var_name_char(*str))
-		return mi_get_list_res(r, str, end, ']');
-	return mi_get_list_val(r, str, end);
+		return mi_get_list_res(p, r, str, end, ']');
+	return mi_get_list_val(p, r, str, end);
 }
 
-int mi_get_value(mi_results *r, const char *str, const char **end)
+int mi_get_value(mi_parser *p, mi_results *r, const char *str, const char **end)
 {
 	switch (str[0])
 	{
 	case '"':
-		return mi_get_cstring_r(r, str, end);
+		return mi_get_cstring_r(p, r, str, end);
 	case '{':
-		return mi_get_tuple(r, str, end);
+		return mi_get_tuple(p, r, str, end);
 	case '[':
-		return mi_get_list(r, str, end);
+		return mi_get_list(p, r, str, end);
 	}
-	mi_error = MI_PARSER;
+	p->error = MI_PARSER;
 	return 0;
 }
 
-mi_results *mi_get_result(const char *str, const char **end)
+mi_results *mi_get_result(mi_parser *p, const char *str, const char **end)
 {
 	char *var;
 	mi_results *r;
 
-	var = mi_get_var_name(str, &str);
+	var = mi_get_var_name(p, str, &str);
 	if (!var)
 		return NULL;
 
-	r = mi_alloc_results();
+	r = mi_parser_alloc_results(p);
 	if (!r)
 	{
-		free(var);
+		if (!p->arena)
+			free(var);
 		return NULL;
 	}
 	r->var = var;
+	r->hash = mi_hash_var(var);
 
-	if (!mi_get_value(r, str, end))
+	if (!mi_get_value(p, r, str, end))
 	{
 		mi_free_results(r);
 		return NULL;
@@ -332,7 +409,50 @@ mi_results *mi_get_result(const char *str, const char **end)
 	return r;
 }
 
-mi_output *mi_get_results_alone(mi_output *r, const char *str)
+/* Classes of result and async records, shared by the parser and the
+   classifier. */
+struct mi_class_name
+{
+	const char *name;
+	int len;
+	int tclass;
+};
+
+static const mi_class_name mi_result_classes[] = {
+	{"done", 4, MI_CL_DONE},
+	{"running", 7, MI_CL_RUNNING},
+	{"connected", 9, MI_CL_CONNECTED},
+	{"error", 5, MI_CL_ERROR},
+	{"exit", 4, MI_CL_EXIT},
+	{NULL, 0, MI_CL_UNKNOWN}};
+
+static const mi_class_name mi_async_classes[] = {
+	{"stopped", 7, MI_CL_STOPPED},
+	{"running", 7, MI_CL_RUNNING},
+	{"download", 8, MI_CL_DOWNLOAD},
+	{"breakpoint-created", 18, MI_CL_BREAKPOINT_CREATED},
+	{"breakpoint-modified", 19, MI_CL_BREAKPOINT_MODIFIED},
+	{"breakpoint-deleted", 18, MI_CL_BREAKPOINT_DELETED},
+	{NULL, 0, MI_CL_UNKNOWN}};
+
+/* Look up the class at the start of str, it must be followed by the results
+   or the end of the record. The length of the name is stored in len. */
+static int mi_get_class(const mi_class_name *classes, const char *str, int *len)
+{
+	for (; classes->name; classes++)
+	{
+		if (strncmp(str, classes->name, classes->len) == 0 &&
+			(!str[classes->len] || str[classes->len] == ','))
+		{
+			*len = classes->len;
+			return classes->tclass;
+		}
+	}
+	*len = 0;
+	return MI_CL_UNKNOWN;
+}
+
+mi_output *mi_get_results_alone(mi_parser *p, mi_output *r, const char *str)
 {
 	mi_results *last_r, *rs;
 
@@ -344,11 +464,11 @@ mi_output *mi_get_results_alone(mi_output *r, const char *str)
 			return r;
 		if (*str != ',')
 		{
-			mi_error = MI_PARSER;
+			p->error = MI_PARSER;
 			break;
 		}
 		str++;
-		rs = mi_get_result(str, &str);
+		rs = mi_get_result(p, str, &str);
 		if (!rs)
 			break;
 		if (!last_r)
@@ -361,91 +481,63 @@ mi_output *mi_get_results_alone(mi_output *r, const char *str)
 	return NULL;
 }
 
-mi_output *mi_parse_result_record(mi_output *r, const char *str)
+mi_output *mi_parse_result_record(mi_parser *p, mi_output *r, const char *str)
 {
+	int len;
+
 	r->type = MI_T_RESULT_RECORD;
 
 	/* Solve the result-class. */
-	if (strncmp(str, "done", 4) == 0)
+	r->tclass = mi_get_class(mi_result_classes, str, &len);
+	if (r->tclass == MI_CL_UNKNOWN)
 	{
-		str += 4;
-		r->tclass = MI_CL_DONE;
-	}
-	else if (strncmp(str, "running", 7) == 0)
-	{
-		str += 7;
-		r->tclass = MI_CL_RUNNING;
-	}
-	else if (strncmp(str, "connected", 9) == 0)
-	{
-		str += 9;
-		r->tclass = MI_CL_CONNECTED;
-	}
-	else if (strncmp(str, "error", 5) == 0)
-	{
-		str += 5;
-		r->tclass = MI_CL_ERROR;
-	}
-	else if (strncmp(str, "exit", 4) == 0)
-	{
-		str += 4;
-		r->tclass = MI_CL_EXIT;
-	}
-	else
-	{
-		mi_error = MI_UNKNOWN_RESULT;
+		p->error = MI_UNKNOWN_RESULT;
+		mi_free_output(r);
 		return NULL;
 	}
 
-	return mi_get_results_alone(r, str);
+	return mi_get_results_alone(p, r, str + len);
 }
 
-mi_output *mi_parse_asyn(mi_output *r, const char *str)
+mi_output *mi_parse_asyn(mi_parser *p, mi_output *r, const char *str)
 {
+	int len;
+
 	r->type = MI_T_OUT_OF_BAND;
 	r->stype = MI_ST_ASYNC;
 	/* async-class. */
-	if (strncmp(str, "stopped", 7) == 0)
-	{
-		r->tclass = MI_CL_STOPPED;
-		str += 7;
-		return mi_get_results_alone(r, str);
-	}
-	if (strncmp(str, "download", 8) == 0)
-	{
-		r->tclass = MI_CL_DOWNLOAD;
-		str += 8;
-		return mi_get_results_alone(r, str);
-	}
-	mi_error = MI_UNKNOWN_ASYNC;
+	r->tclass = mi_get_class(mi_async_classes, str, &len);
+	if (r->tclass != MI_CL_UNKNOWN)
+		return mi_get_results_alone(p, r, str + len);
+	p->error = MI_UNKNOWN_ASYNC;
 	mi_free_output(r);
 	return NULL;
 }
 
-mi_output *mi_parse_exec_asyn(mi_output *r, const char *str)
+mi_output *mi_parse_exec_asyn(mi_parser *p, mi_output *r, const char *str)
 {
 	r->sstype = MI_SST_EXEC;
-	return mi_parse_asyn(r, str);
+	return mi_parse_asyn(p, r, str);
 }
 
-mi_output *mi_parse_status_asyn(mi_output *r, const char *str)
+mi_output *mi_parse_status_asyn(mi_parser *p, mi_output *r, const char *str)
 {
 	r->sstype = MI_SST_STATUS;
-	return mi_parse_asyn(r, str);
+	return mi_parse_asyn(p, r, str);
 }
 
-mi_output *mi_parse_notify_asyn(mi_output *r, const char *str)
+mi_output *mi_parse_notify_asyn(mi_parser *p, mi_output *r, const char *str)
 {
 	r->sstype = MI_SST_NOTIFY;
-	return mi_parse_asyn(r, str);
+	return mi_parse_asyn(p, r, str);
 }
 
-mi_output *mi_console(mi_output *r, const char *str)
+mi_output *mi_console(mi_parser *p, mi_output *r, const char *str)
 {
 	r->type = MI_T_OUT_OF_BAND;
 	r->stype = MI_ST_STREAM;
-	r->c = mi_alloc_results();
-	if (!r->c || !mi_get_cstring_r(r->c, str, NULL))
+	r->c = mi_parser_alloc_results(p);
+	if (!r->c || !mi_get_cstring_r(p, r->c, str, NULL))
 	{
 		mi_free_output(r);
 		return NULL;
@@ -453,56 +545,156 @@ mi_output *mi_console(mi_output *r, const char *str)
 	return r;
 }
 
-mi_output *mi_console_stream(mi_output *r, const char *str)
+mi_output *mi_console_stream(mi_parser *p, mi_output *r, const char *str)
 {
 	r->sstype = MI_SST_CONSOLE;
-	return mi_console(r, str);
+	return mi_console(p, r, str);
 }
 
-mi_output *mi_target_stream(mi_output *r, const char *str)
+mi_output *mi_target_stream(mi_parser *p, mi_output *r, const char *str)
 {
 	r->sstype = MI_SST_TARGET;
-	return mi_console(r, str);
+	return mi_console(p, r, str);
 }
 
-mi_output *mi_log_stream(mi_output *r, const char *str)
+mi_output *mi_log_stream(mi_parser *p, mi_output *r, const char *str)
 {
 	r->sstype = MI_SST_LOG;
-	return mi_console(r, str);
+	return mi_console(p, r, str);
 }
 
-mi_output *mi_parse_gdb_output(const char *str)
+static mi_output *mi_parse_output(mi_parser *p, const char *str)
 {
 	char type = str[0];
 
-	mi_output *r = mi_alloc_output();
+	mi_output *r = mi_parser_alloc_output(p);
 	if (!r)
-	{
-		mi_error = MI_OUT_OF_MEMORY;
 		return NULL;
-	}
 	str++;
 	switch (type)
 	{
 	case '^':
-		return mi_parse_result_record(r, str);
+		return mi_parse_result_record(p, r, str);
 	case '*':
-		return mi_parse_exec_asyn(r, str);
+		return mi_parse_exec_asyn(p, r, str);
 	case '+':
-		return mi_parse_status_asyn(r, str);
+		return mi_parse_status_asyn(p, r, str);
 	case '=':
-		return mi_parse_notify_asyn(r, str);
+		return mi_parse_notify_asyn(p, r, str);
 	case '~':
-		return mi_console_stream(r, str);
+		return mi_console_stream(p, r, str);
 	case '@':
-		return mi_target_stream(r, str);
+		return mi_target_stream(p, r, str);
 	case '&':
-		return mi_log_stream(r, str);
+		return mi_log_stream(p, r, str);
 	}
-	mi_error = MI_PARSER;
+	p->error = MI_PARSER;
+	mi_free_output(r);
 	return NULL;
 }
 
+/* Parse a line with malloc, without a handle. */
+mi_output *mi_parse_gdb_output(const char *str)
+{
+	mi_parser p = {NULL, 0, MI_OK};
+	return mi_parse_output(&p, str);
+}
+
+/* Classify a line of gdb output by its prefix and class, without parsing
+   the results. Returns the MI_REC_* kind of the record, 0 if it isn't one. */
+int mi_classify_output(mi_output *r, const char *str)
+{
+	int len;
+
+	r->type = MI_T_OUT_OF_BAND;
+	r->stype = MI_ST_ASYNC;
+	r->tclass = MI_CL_UNKNOWN;
+	switch (*str++)
+	{
+	case '^':
+		r->type = MI_T_RESULT_RECORD;
+		r->tclass = mi_get_class(mi_result_classes, str, &len);
+		return MI_REC_RESULT;
+	case '*':
+		r->sstype = MI_SST_EXEC;
+		break;
+	case '+':
+		r->sstype = MI_SST_STATUS;
+		break;
+	case '=':
+		r->sstype = MI_SST_NOTIFY;
+		break;
+	case '~':
+		r->stype = MI_ST_STREAM;
+		r->sstype = MI_SST_CONSOLE;
+		return MI_REC_STREAM;
+	case '@':
+		r->stype = MI_ST_STREAM;
+		r->sstype = MI_SST_TARGET;
+		return MI_REC_STREAM;
+	case '&':
+		r->stype = MI_ST_STREAM;
+		r->sstype = MI_SST_LOG;
+		return MI_REC_STREAM;
+	default:
+		return 0;
+	}
+	r->tclass = mi_get_class(mi_async_classes, str, &len);
+	switch (r->tclass)
+	{
+	case MI_CL_STOPPED:
+		return MI_REC_STOPPED;
+	case MI_CL_RUNNING:
+		return MI_REC_RUNNING;
+	case MI_CL_BREAKPOINT_CREATED:
+	case MI_CL_BREAKPOINT_MODIFIED:
+	case MI_CL_BREAKPOINT_DELETED:
+		return MI_REC_BREAKPOINT;
+	}
+	return MI_REC_ASYNC;
+}
+
+/* Parse gdb output, but only classify the records of the kinds in skip and
+   keep their text raw. */
+mi_output *mi_parse_gdb_output_skip(mi_parser *p, const char *str, int skip)
+{
+	mi_output cls;
+	mi_output *r;
+	int len;
+
+	if (!skip || !(mi_classify_output(&cls, str) & skip))
+		return mi_parse_output(p, str);
+	r = mi_parser_alloc_output(p);
+	if (r)
+		r->c = mi_parser_alloc_results(p);
+	if (!r || !r->c)
+	{
+		mi_free_output(r);
+		return NULL;
+	}
+	r->type = cls.type;
+	r->stype = cls.stype;
+	r->sstype = cls.sstype;
+	r->tclass = cls.tclass;
+	r->raw = 1;
+	r->c->type = t_const;
+	str++;
+	if (p->views)
+	{
+		r->c->v.cstr = (char *)str;
+		return r;
+	}
+	len = strlen(str);
+	r->c->v.cstr = mi_parser_malloc(p, len + 1);
+	if (!r->c->v.cstr)
+	{
+		mi_free_output(r);
+		return NULL;
+	}
+	memcpy(r->c->v.cstr, str, len + 1);
+	return r;
+}
+
 mi_output *mi_get_rrecord(mi_output *r)
 {
 	if (!r)
@@ -516,17 +708,125 @@ mi_output *mi_get_rrecord(mi_output *r)
 	return r;
 }
 
+/* Take the string of a result. Strings in an arena only live until the arena
+   is reset, so they are copied, others are stolen from the result. */
+char *mi_take_cstr(mi_results *r)
+{
+	char *s = r->v.cstr;
+	if (r->arena)
+		return s ? strdup(s) : NULL;
+	r->v.cstr = NULL;
+	return s;
+}
+
+/* Take the list or tuple of a result, copying it out of an arena. */
+mi_results *mi_take_results(mi_results *r)
+{
+	mi_results *rs = r->v.rs;
+	if (r->arena)
+		return mi_copy_results(rs);
+	r->v.rs = NULL;
+	return rs;
+}
+
+/* Deep copy of a list of results, allocated with malloc. */
+mi_results *mi_copy_results(const mi_results *r)
+{
+	mi_results *first = NULL, *last = NULL;
+
+	for (; r; r = r->next)
+	{
+		mi_results *c = (mi_results *)mi_calloc1(sizeof(mi_results));
+		if (!c)
+		{
+			mi_free_results(first);
+			return NULL;
+		}
+		c->type = r->type;
+		c->hash = r->hash;
+		if (r->var)
+			c->var = strdup(r->var);
+		if (r->type == t_const)
+			c->v.cstr = r->v.cstr ? strdup(r->v.cstr) : NULL;
+		else
+			c->v.rs = mi_copy_results(r->v.rs);
+		if (last)
+			last->next = c;
+		else
+			first = c;
+		last = c;
+	}
+	return first;
+}
+
 mi_results *mi_get_var_r(mi_results *r, const char *var)
 {
+	unsigned hash = mi_hash_var(var);
+
 	while (r)
 	{
-		if (strcmp(r->var, var) == 0)
+		if (r->var && r->hash == hash && strcmp(r->var, var) == 0)
 			return r;
 		r = r->next;
 	}
 	return NULL;
 }
 
+static unsigned mi_index_slot(unsigned hash)
+{
+	return (hash ^ (hash >> 16)) & (MI_INDEX_SIZE - 1);
+}
+
+void mi_index_results(mi_index *ix, mi_results *r)
+{
+	int n = 0;
+
+	memset(ix->slots, 0, sizeof(ix->slots));
+	for (; r && n < MI_INDEX_MAX; r = r->next)
+	{
+		unsigned i;
+
+		if (!r->var)
+			continue;
+		/* Keep the first result of a name. */
+		for (i = mi_index_slot(r->hash); ix->slots[i];
+			 i = (i + 1) & (MI_INDEX_SIZE - 1))
+			if (ix->slots[i]->hash == r->hash &&
+				strcmp(ix->slots[i]->var, r->var) == 0)
+				break;
+		if (!ix->slots[i])
+		{
+			ix->slots[i] = r;
+			n++;
+		}
+	}
+	ix->rest = r;
+}
+
+mi_results *mi_index_get_h(const mi_index *ix, const char *var, unsigned hash)
+{
+	unsigned i;
+	mi_results *r;
+
+	for (i = mi_index_slot(hash); (r = ix->slots[i]) != NULL;
+		 i = (i + 1) & (MI_INDEX_SIZE - 1))
+		if (r->hash == hash && strcmp(r->var, var) == 0)
+			return r;
+	for (r = ix->rest; r; r = r->next)
+		if (r->var && r->hash == hash && strcmp(r->var, var) == 0)
+			return r;
+	return NULL;
+}
+
+/* A constant result of the tuple, NULL if none. */
+static mi_results *mi_index_const(const mi_index *ix, const char *var,
+								  unsigned hash)
+{
+	mi_results *r = mi_index_get_h(ix, var, hash);
+	return r && r->type == t_const ? r : NULL;
+}
+#define MI_INDEX_CONST(ix, var) mi_index_const(ix, var, mi_hash_var(var))
+
 mi_results *mi_get_var(mi_output *res, const char *var)
 {
 	if (!res)
@@ -543,12 +843,12 @@ int mi_get_async_stop_reason(mi_output *r, char **reason)
 	{
 		if (r->type == MI_T_RESULT_RECORD && r->tclass == MI_CL_ERROR)
 		{
-			if (r->c->type == t_const)
+			if (r->c && r->c->type == t_const)
 				*reason = r->c->v.cstr;
 			return 0;
 		}
 		if (r->type == MI_T_OUT_OF_BAND && r->stype == MI_ST_ASYNC &&
-			r->sstype == MI_SST_EXEC && r->tclass == MI_CL_STOPPED)
+			r->sstype == MI_SST_EXEC && r->tclass == MI_CL_STOPPED && !r->raw)
 		{
 			mi_results *p = r->c;
 			found_stopped = 1;
@@ -566,7 +866,8 @@ int mi_get_async_stop_reason(mi_output *r, char **reason)
 	}
 	if (*reason == NULL && found_stopped)
 	{
-		*reason = strdup("unknown (temp bkpt?)");
+		/* Static, like the others it's not owned by the caller. */
+		*reason = (char *)"unknown (temp bkpt?)";
 		return 1;
 	}
 	return 0;
@@ -577,7 +878,7 @@ mi_frames *mi_get_async_frame(mi_output *r)
 	while (r)
 	{
 		if (r->type == MI_T_OUT_OF_BAND && r->stype == MI_ST_ASYNC &&
-			r->sstype == MI_SST_EXEC && r->tclass == MI_CL_STOPPED)
+			r->sstype == MI_SST_EXEC && r->tclass == MI_CL_STOPPED && !r->raw)
 		{
 			mi_results *p = r->c;
 			while (p)
@@ -652,48 +953,30 @@ mi_results *mi_res_done_var(mi_h *h, const char *var)
 mi_frames *mi_parse_frame(mi_results *c)
 {
 	mi_frames *res = mi_alloc_frames();
+	mi_index ix;
+	mi_results *r;
 	char *end;
 
 	if (res)
 	{
-		while (c)
-		{
-			if (c->type == t_const)
-			{
-				if (strcmp(c->var, "level") == 0)
-					res->level = atoi(c->v.cstr);
-				else if (strcmp(c->var, "addr") == 0)
-					res->addr = (void *)strtoul(c->v.cstr, &end, 0);
-				else if (strcmp(c->var, "func") == 0)
-				{
-					res->func = c->v.cstr;
-					c->v.cstr = NULL;
-				}
-				else if (strcmp(c->var, "file") == 0)
-				{
-					res->file = c->v.cstr;
-					c->v.cstr = NULL;
-				}
-				else if (strcmp(c->var, "fullname") == 0)
-				{
-					res->fullname = c->v.cstr;
-					c->v.cstr = NULL;
-				}
-				else if (strcmp(c->var, "from") == 0)
-				{
-					res->from = c->v.cstr;
-					c->v.cstr = NULL;
-				}
-				else if (strcmp(c->var, "line") == 0)
-					res->line = atoi(c->v.cstr);
-			}
-			else if (c->type == t_list && strcmp(c->var, "args") == 0)
-			{
-				res->args = c->v.rs;
-				c->v.rs = NULL;
-			}
-			c = c->next;
-		}
+		mi_index_results(&ix, c);
+		if ((r = MI_INDEX_CONST(&ix, "level")))
+			res->level = atoi(r->v.cstr);
+		if ((r = MI_INDEX_CONST(&ix, "addr")))
+			res->addr = (void *)strtoul(r->v.cstr, &end, 0);
+		if ((r = MI_INDEX_CONST(&ix, "func")))
+			res->func = mi_take_cstr(r);
+		if ((r = MI_INDEX_CONST(&ix, "file")))
+			res->file = mi_take_cstr(r);
+		if ((r = MI_INDEX_CONST(&ix, "fullname")))
+			res->fullname = mi_take_cstr(r);
+		if ((r = MI_INDEX_CONST(&ix, "from")))
+			res->from = mi_take_cstr(r);
+		if ((r = MI_INDEX_CONST(&ix, "line")))
+			res->line = atoi(r->v.cstr);
+		r = mi_index_get(&ix, "args");
+		if (r && r->type == t_list)
+			res->args = mi_take_results(r);
 	}
 	return res;
 }
@@ -790,7 +1073,9 @@ int mi_get_thread_ids(mi_output *res, int **list)
 		lids && lids->type == t_tuple)
 	{
 		ids = atoi(vids->v.cstr);
-		if (ids)
+		if (ids < 0)
+			ids = -1;
+		else if (ids)
 		{
 			int *lst;
 			lst = (int *)mi_calloc(ids, sizeof(int));
@@ -798,7 +1083,8 @@ int mi_get_thread_ids(mi_output *res, int **list)
 			{
 				lids = lids->v.rs;
 				i = 0;
-				while (lids)
+				/* Don't trust the count. */
+				while (lids && i < ids)
 				{
 					if (strcmp(lids->var, "thread-id") == 0 && lids->type == t_const)
 						lst[i++] = atoi(lids->v.cstr);
@@ -818,6 +1104,7 @@ int mi_res_thread_ids(mi_h *h, int **list)
 	mi_output *r, *res;
 	int ids = -1;
 
+	*list = NULL;
 	r = mi_get_response_blk(h);
 	res = mi_get_rrecord(r);
 	if (res && res->tclass == MI_CL_DONE)
@@ -957,8 +1244,7 @@ mi_gvar *mi_get_gvar(mi_output *o, mi_gvar *cur, const char *expression)
 			if (strcmp(r->var, "name") == 0)
 			{
 				free(res->name);
-				res->name = r->v.cstr;
-				r->v.cstr = NULL;
+				res->name = mi_take_cstr(r);
 			}
 			else if (strcmp(r->var, "numchild") == 0)
 			{
@@ -967,8 +1253,7 @@ mi_gvar *mi_get_gvar(mi_output *o, mi_gvar *cur, const char *expression)
 			else if (strcmp(r->var, "type") == 0)
 			{
 				free(res->type);
-				res->type = r->v.cstr;
-				r->v.cstr = NULL;
+				res->type = mi_take_cstr(r);
 				l = strlen(res->type);
 				if (l && res->type[l - 1] == '*')
 					res->ispointer = 1;
@@ -980,8 +1265,7 @@ mi_gvar *mi_get_gvar(mi_output *o, mi_gvar *cur, const char *expression)
 			else if (strcmp(r->var, "exp") == 0)
 			{
 				free(res->exp);
-				res->exp = r->v.cstr;
-				r->v.cstr = NULL;
+				res->exp = mi_take_cstr(r);
 			}
 			else if (strcmp(r->var, "format") == 0)
 			{
@@ -1028,8 +1312,8 @@ mi_gvar_chg *mi_get_gvar_chg(mi_results *r)
 			{
 				if (strcmp(r->var, "name") == 0)
 				{
-					n->name = r->v.cstr;
-					r->v.cstr = NULL;
+					free(n->name);
+					n->name = mi_take_cstr(r);
 				}
 				else if (strcmp(r->var, "in_scope") == 0)
 				{
@@ -1037,8 +1321,8 @@ mi_gvar_chg *mi_get_gvar_chg(mi_results *r)
 				}
 				else if (strcmp(r->var, "new_type") == 0)
 				{
-					n->new_type = r->v.cstr;
-					r->v.cstr = NULL;
+					free(n->new_type);
+					n->new_type = mi_take_cstr(r);
 				}
 				else if (strcmp(r->var, "new_num_children") == 0)
 				{
@@ -1109,8 +1393,8 @@ int mi_res_changelist(mi_h *h, mi_gvar_chg **changed)
 						mi_free_gvar_chg(*changed);
 						return 0;
 					}
-					n->name = r->v.cstr;
-					r->v.cstr = NULL;
+					free(n->name);
+					n->name = mi_take_cstr(r);
 				}
 				else if (strcmp(r->var, "in_scope") == 0)
 				{
@@ -1118,8 +1402,8 @@ int mi_res_changelist(mi_h *h, mi_gvar_chg **changed)
 				}
 				else if (strcmp(r->var, "new_type") == 0)
 				{
-					n->new_type = r->v.cstr;
-					r->v.cstr = NULL;
+					free(n->new_type);
+					n->new_type = mi_take_cstr(r);
 				}
 				else if (strcmp(r->var, "new_num_children") == 0)
 				{
@@ -1171,26 +1455,26 @@ int mi_get_children(mi_results *ch, mi_gvar *v)
 				{
 					if (strcmp(r->var, "name") == 0)
 					{
-						cur->name = r->v.cstr;
-						r->v.cstr = NULL;
+						free(cur->name);
+						cur->name = mi_take_cstr(r);
 					}
 					else if (strcmp(r->var, "exp") == 0)
 					{
-						cur->exp = r->v.cstr;
-						r->v.cstr = NULL;
+						free(cur->exp);
+						cur->exp = mi_take_cstr(r);
 					}
 					else if (strcmp(r->var, "type") == 0)
 					{
-						cur->type = r->v.cstr;
-						r->v.cstr = NULL;
+						free(cur->type);
+						cur->type = mi_take_cstr(r);
 						l = strlen(cur->type);
 						if (l && cur->type[l - 1] == '*')
 							cur->ispointer = 1;
 					}
 					else if (strcmp(r->var, "value") == 0)
 					{
-						cur->value = r->v.cstr;
-						r->v.cstr = NULL;
+						free(cur->value);
+						cur->value = mi_take_cstr(r);
 					}
 					else if (strcmp(r->var, "numchild") == 0)
 					{
@@ -1243,66 +1527,50 @@ int mi_res_children(mi_h *h, mi_gvar *v)
 mi_bkpt *mi_get_bkpt(mi_results *p)
 {
 	mi_bkpt *res;
+	mi_index ix;
+	mi_results *r;
 	char *end;
 
 	res = mi_alloc_bkpt();
 	if (!res)
 		return NULL;
-	while (p)
+	mi_index_results(&ix, p);
+	if ((r = MI_INDEX_CONST(&ix, "number")))
+		res->number = atoi(r->v.cstr);
+	if ((r = MI_INDEX_CONST(&ix, "type")))
 	{
-		if (p->type == t_const && p->var)
-		{
-			if (strcmp(p->var, "number") == 0)
-				res->number = atoi(p->v.cstr);
-			else if (strcmp(p->var, "type") == 0)
-			{
-				if (strcmp(p->v.cstr, "breakpoint") == 0)
-					res->type = t_breakpoint;
-				else
-					res->type = t_unknown;
-			}
-			else if (strcmp(p->var, "disp") == 0)
-			{
-				if (strcmp(p->v.cstr, "keep") == 0)
-					res->disp = d_keep;
-				else if (strcmp(p->v.cstr, "del") == 0)
-					res->disp = d_del;
-				else
-					res->disp = d_unknown;
-			}
-			else if (strcmp(p->var, "enabled") == 0)
-				res->enabled = p->v.cstr[0] == 'y';
-			else if (strcmp(p->var, "addr") == 0)
-				res->addr = (void *)strtoul(p->v.cstr, &end, 0);
-			else if (strcmp(p->var, "func") == 0)
-			{
-				res->func = p->v.cstr;
-				p->v.cstr = NULL;
-			}
-			else if (strcmp(p->var, "file") == 0)
-			{
-				res->file = p->v.cstr;
-				p->v.cstr = NULL;
-			}
-			else if (strcmp(p->var, "fullname") == 0)
-			{
-				res->fullname = p->v.cstr;
-				p->v.cstr = NULL;
-			}
-			else if (strcmp(p->var, "line") == 0)
-				res->line = atoi(p->v.cstr);
-			else if (strcmp(p->var, "times") == 0)
-				res->times = atoi(p->v.cstr);
-			else if (strcmp(p->var, "ignore") == 0)
-				res->ignore = atoi(p->v.cstr);
-			else if (strcmp(p->var, "cond") == 0)
-			{
-				res->cond = p->v.cstr;
-				p->v.cstr = NULL;
-			}
-		}
-		p = p->next;
+		if (strcmp(r->v.cstr, "breakpoint") == 0)
+			res->type = t_breakpoint;
+		else
+			res->type = t_unknown;
+	}
+	if ((r = MI_INDEX_CONST(&ix, "disp")))
+	{
+		if (strcmp(r->v.cstr, "keep") == 0)
+			res->disp = d_keep;
+		else if (strcmp(r->v.cstr, "del") == 0)
+			res->disp = d_del;
+		else
+			res->disp = d_unknown;
 	}
+	if ((r = MI_INDEX_CONST(&ix, "enabled")))
+		res->enabled = r->v.cstr[0] == 'y';
+	if ((r = MI_INDEX_CONST(&ix, "addr")))
+		res->addr = (void *)strtoul(r->v.cstr, &end, 0);
+	if ((r = MI_INDEX_CONST(&ix, "func")))
+		res->func = mi_take_cstr(r);
+	if ((r = MI_INDEX_CONST(&ix, "file")))
+		res->file = mi_take_cstr(r);
+	if ((r = MI_INDEX_CONST(&ix, "fullname")))
+		res->fullname = mi_take_cstr(r);
+	if ((r = MI_INDEX_CONST(&ix, "line")))
+		res->line = atoi(r->v.cstr);
+	if ((r = MI_INDEX_CONST(&ix, "times")))
+		res->times = atoi(r->v.cstr);
+	if ((r = MI_INDEX_CONST(&ix, "ignore")))
+		res->ignore = atoi(r->v.cstr);
+	if ((r = MI_INDEX_CONST(&ix, "cond")))
+		res->cond = mi_take_cstr(r);
 	return res;
 }
 
@@ -1351,8 +1619,8 @@ mi_wp *mi_get_wp(mi_results *p, enum mi_wp_mode m)
 				}
 				else if (strcmp(p->var, "exp") == 0)
 				{
-					res->exp = p->v.cstr;
-					p->v.cstr = NULL;
+					free(res->exp);
+					res->exp = mi_take_cstr(p);
 				}
 			}
 			p = p->next;
@@ -1411,8 +1679,7 @@ char *mi_res_value(mi_h *h)
 
 	if (r && r->type == t_const)
 	{
-		s = r->v.cstr;
-		r->v.rs = NULL;
+		s = mi_take_cstr(r);
 	}
 	mi_free_results(r);
 	return s;
@@ -1423,47 +1690,47 @@ mi_output *mi_get_stop_record(mi_output *r)
 	while (r)
 	{
 		if (r->type == MI_T_OUT_OF_BAND && r->stype == MI_ST_ASYNC &&
-			r->sstype == MI_SST_EXEC && r->tclass == MI_CL_STOPPED)
+			r->sstype == MI_SST_EXEC && r->tclass == MI_CL_STOPPED && !r->raw)
 			return r;
 		r = r->next;
 	}
 	return r;
 }
 
-static char *reason_names[] = {
-	(char *)"breakpoint-hit",
-	(char *)"watchpoint-trigger",
-	(char *)"read-watchpoint-trigger",
-	(char *)"access-watchpoint-trigger",
-	(char *)"watchpoint-scope",
-	(char *)"function-finished",
-	(char *)"location-reached",
-	(char *)"end-stepping-range",
-	(char *)"exited-signalled",
-	(char *)"exited",
-	(char *)"exited-normally",
-	(char *)"signal-received"};
-
-static enum mi_stop_reason reason_values[] = {
+static const char *const reason_names[] = {
+	"breakpoint-hit",
+	"watchpoint-trigger",
+	"read-watchpoint-trigger",
+	"access-watchpoint-trigger",
+	"watchpoint-scope",
+	"function-finished",
+	"location-reached",
+	"end-stepping-range",
+	"exited-signalled",
+	"exited",
+	"exited-normally",
+	"signal-received"};
+
+static const enum mi_stop_reason reason_values[] = {
 	sr_bkpt_hit,
 	sr_wp_trigger, sr_read_wp_trigger, sr_access_wp_trigger, sr_wp_scope,
 	sr_function_finished, sr_location_reached, sr_end_stepping_range,
 	sr_exited_signalled, sr_exited, sr_exited_normally,
 	sr_signal_received};
 
-static char *reason_expl[] = {
-	(char *)"Hit a breakpoint",
-	(char *)"Write watchpoint",
-	(char *)"Read watchpoint",
-	(char *)"Access watchpoint",
-	(char *)"Watchpoint out of scope",
-	(char *)"Function finished",
-	(char *)"Location reached",
-	(char *)"End of stepping",
-	(char *)"Exited signalled",
-	(char *)"Exited with error",
-	(char *)"Exited normally",
-	(char *)"Signal received"};
+static const char *const reason_expl[] = {
+	"Hit a breakpoint",
+	"Write watchpoint",
+	"Read watchpoint",
+	"Access watchpoint",
+	"Watchpoint out of scope",
+	"Function finished",
+	"Location reached",
+	"End of stepping",
+	"Exited signalled",
+	"Exited with error",
+	"Exited normally",
+	"Signal received"};
 
 enum mi_stop_reason mi_reason_str_to_enum(const char *s)
 {
@@ -1490,86 +1757,70 @@ const char *mi_reason_enum_to_str(enum mi_stop_reason r)
 mi_stop *mi_get_stopped(mi_results *r)
 {
 	mi_stop *res = mi_alloc_stop();
+	mi_index ix;
 
 	if (res)
 	{
-		while (r)
+		mi_index_results(&ix, r);
+		if ((r = MI_INDEX_CONST(&ix, "reason")))
+			res->reason = mi_reason_str_to_enum(r->v.cstr);
+		if ((r = MI_INDEX_CONST(&ix, "thread-id")))
 		{
-			if (r->type == t_const)
+			res->have_thread_id = 1;
+			res->thread_id = atoi(r->v.cstr);
+		}
+		if ((r = MI_INDEX_CONST(&ix, "bkptno")))
+		{
+			res->have_bkptno = 1;
+			res->bkptno = atoi(r->v.cstr);
+		}
+		else if ((r = MI_INDEX_CONST(&ix, "wpnum")))
+		{
+			res->have_wpno = 1;
+			res->wpno = atoi(r->v.cstr);
+		}
+		if ((r = MI_INDEX_CONST(&ix, "gdb-result-var")))
+			res->gdb_result_var = mi_take_cstr(r);
+		if ((r = MI_INDEX_CONST(&ix, "return-value")))
+			res->return_value = mi_take_cstr(r);
+		if ((r = MI_INDEX_CONST(&ix, "signal-name")))
+			res->signal_name = mi_take_cstr(r);
+		if ((r = MI_INDEX_CONST(&ix, "signal-meaning")))
+			res->signal_meaning = mi_take_cstr(r);
+		if ((r = MI_INDEX_CONST(&ix, "exit-code")))
+		{
+			res->have_exit_code = 1;
+			res->exit_code = atoi(r->v.cstr);
+		}
+		// tuples or lists
+		r = mi_index_get(&ix, "frame");
+		if (r && r->type != t_const)
+			res->frame = mi_parse_frame(r->v.rs);
+		if ((r = mi_index_get(&ix, "wpt")) && r->type != t_const)
+			res->wp = mi_get_wp(r->v.rs, wm_write);
+		else if ((r = mi_index_get(&ix, "hw-rwpt")) && r->type != t_const)
+			res->wp = mi_get_wp(r->v.rs, wm_read);
+		else if ((r = mi_index_get(&ix, "hw-awpt")) && r->type != t_const)
+			res->wp = mi_get_wp(r->v.rs, wm_rw);
+		r = mi_index_get(&ix, "value");
+		if (r && r->type != t_const)
+		{
+			mi_results *p;
+			for (p = r->v.rs; p; p = p->next)
 			{
-				if (strcmp(r->var, "reason") == 0)
-					res->reason = mi_reason_str_to_enum(r->v.cstr);
-				else if (!res->have_thread_id && strcmp(r->var, "thread-id") == 0)
-				{
-					res->have_thread_id = 1;
-					res->thread_id = atoi(r->v.cstr);
-				}
-				else if (!res->have_bkptno && strcmp(r->var, "bkptno") == 0)
-				{
-					res->have_bkptno = 1;
-					res->bkptno = atoi(r->v.cstr);
-				}
-				else if (!res->have_bkptno && strcmp(r->var, "wpnum") == 0)
-				{
-					res->have_wpno = 1;
-					res->wpno = atoi(r->v.cstr);
-				}
-				else if (strcmp(r->var, "gdb-result-var") == 0)
-				{
-					res->gdb_result_var = r->v.cstr;
-					r->v.cstr = NULL;
-				}
-				else if (strcmp(r->var, "return-value") == 0)
-				{
-					res->return_value = r->v.cstr;
-					r->v.cstr = NULL;
-				}
-				else if (strcmp(r->var, "signal-name") == 0)
-				{
-					res->signal_name = r->v.cstr;
-					r->v.cstr = NULL;
-				}
-				else if (strcmp(r->var, "signal-meaning") == 0)
+				if (!p->var || p->type != t_const)
+					continue;
+				if (strcmp(p->var, "value") == 0 || strcmp(p->var, "new") == 0)
 				{
-					res->signal_meaning = r->v.cstr;
-					r->v.cstr = NULL;
+					free(res->wp_val);
+					res->wp_val = mi_take_cstr(p);
 				}
-				else if (!res->have_exit_code && strcmp(r->var, "exit-code") == 0)
+				else if (strcmp(p->var, "old") == 0)
 				{
-					res->have_exit_code = 1;
-					res->exit_code = atoi(r->v.cstr);
+					free(res->wp_old);
+					res->wp_old = mi_take_cstr(p);
 				}
 			}
-			else // tuple or list
-			{
-				if (strcmp(r->var, "frame") == 0)
-					res->frame = mi_parse_frame(r->v.rs);
-				else if (!res->wp && strcmp(r->var, "wpt") == 0)
-					res->wp = mi_get_wp(r->v.rs, wm_write);
-				else if (!res->wp && strcmp(r->var, "hw-rwpt") == 0)
-					res->wp = mi_get_wp(r->v.rs, wm_read);
-				else if (!res->wp && strcmp(r->var, "hw-awpt") == 0)
-					res->wp = mi_get_wp(r->v.rs, wm_rw);
-				else if (!(res->wp_old || res->wp_val) && strcmp(r->var, "value") == 0)
-				{
-					mi_results *p = r->v.rs;
-					while (p)
-					{
-						if (strcmp(p->var, "value") == 0 || strcmp(p->var, "new") == 0)
-						{
-							res->wp_val = p->v.cstr;
-							p->v.cstr = NULL;
-						}
-						else if (strcmp(p->var, "old") == 0)
-						{
-							res->wp_old = p->v.cstr;
-							p->v.cstr = NULL;
-						}
-						p = p->next;
-					}
-				}
-			}
-			r = r->next;
 		}
 	}
 	return res;
@@ -1685,15 +1936,15 @@ mi_asm_insn *mi_parse_insn(mi_results *c)
 						cur->addr = (void *)strtoul(sub->v.cstr, &end, 0);
 					else if (strcmp(sub->var, "func-name") == 0)
 					{
-						cur->func = sub->v.cstr;
-						sub->v.cstr = NULL;
+						free(cur->func);
+						cur->func = mi_take_cstr(sub);
 					}
 					else if (strcmp(sub->var, "offset") == 0)
 						cur->offset = atoi(sub->v.cstr);
 					else if (strcmp(sub->var, "inst") == 0)
 					{
-						cur->inst = sub->v.cstr;
-						sub->v.cstr = NULL;
+						free(cur->inst);
+						cur->inst = mi_take_cstr(sub);
 					}
 				}
 				sub = sub->next;
@@ -1738,8 +1989,8 @@ mi_asm_insns *mi_parse_insns(mi_results *c)
 								cur->line = atoi(sub->v.cstr);
 							else if (strcmp(sub->var, "file") == 0)
 							{
-								cur->file = sub->v.cstr;
-								sub->v.cstr = NULL;
+								free(cur->file);
+								cur->file = mi_take_cstr(sub);
 							}
 						}
 						else if (sub->type == t_list)
@@ -1789,9 +2040,8 @@ mi_chg_reg *mi_parse_list_regs(mi_results *r, int *how_many)
 				cur = cur->next = mi_alloc_chg_reg();
 			else
 				first = cur = mi_alloc_chg_reg();
-			cur->name = c->v.cstr;
+			cur->name = mi_take_cstr(c);
 			cur->reg = cregs++;
-			c->v.cstr = NULL;
 		}
 		c = c->next;
 	}
@@ -1861,15 +2111,12 @@ int mi_parse_reg_values(mi_results *r, mi_chg_reg *l)
 					if (strcmp(c->var, "number") == 0)
 					{
 						if (atoi(c->v.cstr) != l->reg)
-						{
-							mi_error = MI_PARSER;
 							return 0;
-						}
 					}
 					else if (strcmp(c->var, "value") == 0)
 					{
-						l->val = c->v.cstr;
-						c->v.cstr = NULL;
+						free(l->val);
+						l->val = mi_take_cstr(c);
 					}
 				}
 				c = c->next;
@@ -1888,7 +2135,11 @@ int mi_get_reg_values(mi_h *h, mi_chg_reg *l)
 	int ok = 0;
 
 	if (r && r->type == t_list)
+	{
 		ok = mi_parse_reg_values(r->v.rs, l);
+		if (!ok)
+			h->error = MI_PARSER;
+	}
 	mi_free_results(r);
 	return ok;
 }
@@ -1900,8 +2151,7 @@ int mi_parse_list_regs_l(mi_results *r, mi_chg_reg *l)
 		if (r->type == t_const && !r->var)
 		{
 			free(l->name);
-			l->name = r->v.cstr;
-			r->v.cstr = NULL;
+			l->name = mi_take_cstr(r);
 			l = l->next;
 		}
 		r = r->next;
@@ -1947,8 +2197,8 @@ mi_chg_reg *mi_parse_reg_values_l(mi_results *r, int *how_many)
 					}
 					else if (strcmp(c->var, "value") == 0)
 					{
-						cur->val = c->v.cstr;
-						c->v.cstr = NULL;
+						free(cur->val);
+						cur->val = mi_take_cstr(c);
 					}
 				}
 				c = c->next;
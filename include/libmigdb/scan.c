@@ -0,0 +1,232 @@
+/**[txh]********************************************************************
+
+	GDB/MI interface library
+	Copyright (c) 2023 by Nicolas With.
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+	Module: Scanning.
+	Comments:
+	Vectorised search for the bytes the c-string parser stops at, in
+	terminated lines and in unterminated chunks of a stream. The SIMD
+	functions load whole aligned blocks, which can't cross a page, so they
+	may read past the terminator or the end of a chunk like the strlen of
+	the C library. The best implementation supported by the CPU is selected
+	on startup.
+
+***************************************************************************/
+
+#include <stdint.h>
+
+#include "mi_gdb.h"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define MI_SCAN_X86
+#include <immintrin.h>
+#endif
+
+/* The aligned loads may touch bytes outside of the buffer. */
+#if defined(__clang__) || __GNUC__ >= 8
+#define MI_SCAN_NO_SANITIZE __attribute__((no_sanitize("address", "thread")))
+#else
+#define MI_SCAN_NO_SANITIZE
+#endif
+
+static const char *mi_scan_cstr_scalar(const char *s)
+{
+	while (*s && *s != '"' && *s != '\\')
+		s++;
+	return s;
+}
+
+static const char *mi_scan_chunk_scalar(const char *s, const char *end)
+{
+	while (s < end && *s != '"' && *s != '\\' && *s != '\n')
+		s++;
+	return s;
+}
+
+#ifdef MI_SCAN_X86
+MI_SCAN_NO_SANITIZE
+static const char *mi_scan_cstr_sse2(const char *s)
+{
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i bslash = _mm_set1_epi8('\\');
+	const __m128i zero = _mm_setzero_si128();
+	unsigned off = (uintptr_t)s & 15;
+	const __m128i *p = (const __m128i *)(s - off);
+	__m128i v = _mm_load_si128(p);
+	unsigned mask = _mm_movemask_epi8(_mm_or_si128(
+		_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+		_mm_cmpeq_epi8(v, zero)));
+	/* Drop the bytes before s. */
+	mask >>= off;
+	if (mask)
+		return s + __builtin_ctz(mask);
+	for (;;)
+	{
+		v = _mm_load_si128(++p);
+		mask = _mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+			_mm_cmpeq_epi8(v, zero)));
+		if (mask)
+			return (const char *)p + __builtin_ctz(mask);
+	}
+}
+
+MI_SCAN_NO_SANITIZE
+static const char *mi_scan_chunk_sse2(const char *s, const char *end)
+{
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i bslash = _mm_set1_epi8('\\');
+	const __m128i nl = _mm_set1_epi8('\n');
+	unsigned off = (uintptr_t)s & 15;
+	const __m128i *p = (const __m128i *)(s - off);
+	unsigned mask;
+	for (;;)
+	{
+		__m128i v = _mm_load_si128(p);
+		mask = _mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+			_mm_cmpeq_epi8(v, nl)));
+		/* Drop the bytes before s. */
+		mask &= ~0u << off;
+		off = 0;
+		if (mask)
+		{
+			const char *r = (const char *)p + __builtin_ctz(mask);
+			return r < end ? r : end;
+		}
+		if ((const char *)++p >= end)
+			return end;
+	}
+}
+
+MI_SCAN_NO_SANITIZE __attribute__((target("avx2")))
+static const char *mi_scan_cstr_avx2(const char *s)
+{
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i bslash = _mm256_set1_epi8('\\');
+	const __m256i zero = _mm256_setzero_si256();
+	unsigned off = (uintptr_t)s & 31;
+	const __m256i *p = (const __m256i *)(s - off);
+	__m256i v = _mm256_load_si256(p);
+	unsigned mask = _mm256_movemask_epi8(_mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+						_mm256_cmpeq_epi8(v, bslash)),
+		_mm256_cmpeq_epi8(v, zero)));
+	mask >>= off;
+	if (mask)
+		return s + __builtin_ctz(mask);
+	for (;;)
+	{
+		v = _mm256_load_si256(++p);
+		mask = _mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+							_mm256_cmpeq_epi8(v, bslash)),
+			_mm256_cmpeq_epi8(v, zero)));
+		if (mask)
+			return (const char *)p + __builtin_ctz(mask);
+	}
+}
+
+MI_SCAN_NO_SANITIZE __attribute__((target("avx2")))
+static const char *mi_scan_chunk_avx2(const char *s, const char *end)
+{
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i bslash = _mm256_set1_epi8('\\');
+	const __m256i nl = _mm256_set1_epi8('\n');
+	unsigned off = (uintptr_t)s & 31;
+	const __m256i *p = (const __m256i *)(s - off);
+	unsigned mask;
+	for (;;)
+	{
+		__m256i v = _mm256_load_si256(p);
+		mask = _mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+							_mm256_cmpeq_epi8(v, bslash)),
+			_mm256_cmpeq_epi8(v, nl)));
+		/* Drop the bytes before s, shifting by 32 is undefined. */
+		mask &= off ? ~0u << off : ~0u;
+		off = 0;
+		if (mask)
+		{
+			const char *r = (const char *)p + __builtin_ctz(mask);
+			return r < end ? r : end;
+		}
+		if ((const char *)++p >= end)
+			return end;
+	}
+}
+#endif
+
+static int mi_simd_best()
+{
+#ifdef MI_SCAN_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return MI_SIMD_AVX2;
+	return MI_SIMD_SSE2;
+#else
+	return MI_SIMD_NONE;
+#endif
+}
+
+/* Read by the parsers of all threads, so it's accessed atomically. */
+static int mi_simd_level = mi_simd_best();
+
+const char *mi_scan_cstr(const char *s)
+{
+	/* Short runs are the common case, don't set up the vectors for them. */
+	if (!*s || *s == '"' || *s == '\\')
+		return s;
+	switch (__atomic_load_n(&mi_simd_level, __ATOMIC_RELAXED))
+	{
+#ifdef MI_SCAN_X86
+	case MI_SIMD_AVX2:
+		return mi_scan_cstr_avx2(s);
+	case MI_SIMD_SSE2:
+		return mi_scan_cstr_sse2(s);
+#endif
+	default:
+		return mi_scan_cstr_scalar(s);
+	}
+}
+
+const char *mi_scan_chunk(const char *s, const char *end)
+{
+	if (s == end || *s == '"' || *s == '\\' || *s == '\n')
+		return s;
+	switch (__atomic_load_n(&mi_simd_level, __ATOMIC_RELAXED))
+	{
+#ifdef MI_SCAN_X86
+	case MI_SIMD_AVX2:
+		return mi_scan_chunk_avx2(s, end);
+	case MI_SIMD_SSE2:
+		return mi_scan_chunk_sse2(s, end);
+#endif
+	default:
+		return mi_scan_chunk_scalar(s, end);
+	}
+}
+
+int mi_set_simd(int level)
+{
+	int best = mi_simd_best();
+	if (level < 0 || level > best)
+		level = best;
+	__atomic_store_n(&mi_simd_level, level, __ATOMIC_RELAXED);
+	return level;
+}
@@ -49,6 +49,11 @@
 #define MI_MISSING_GDB            13
 #define MI_LAST_ERROR             13
 
+/* Implementations of mi_scan_cstr. */
+#define MI_SIMD_NONE 0
+#define MI_SIMD_SSE2 1
+#define MI_SIMD_AVX2 2
+
 enum mi_val_type
 {
 	t_const,
@@ -82,6 +87,19 @@ enum mi_val_type
 #define MI_CL_CONNECTED    5
 #define MI_CL_ERROR        6
 #define MI_CL_EXIT         7
+/* Notify classes. */
+#define MI_CL_BREAKPOINT_CREATED  8
+#define MI_CL_BREAKPOINT_MODIFIED 9
+#define MI_CL_BREAKPOINT_DELETED  10
+
+/* Kinds of records for mi_subscribe. */
+#define MI_REC_RESULT     0x01 /* ^done, ^error, ... */
+#define MI_REC_STOPPED    0x02 /* *stopped */
+#define MI_REC_RUNNING    0x04 /* *running */
+#define MI_REC_BREAKPOINT 0x08 /* =breakpoint-created/modified/deleted */
+#define MI_REC_ASYNC      0x10 /* Other async records, =library-loaded, ... */
+#define MI_REC_STREAM     0x20 /* Console, target and log streams. */
+#define MI_REC_ALL        0x3f
 
 #define MI_VERSION_STR "0.8.13"
 #define MI_VERSION_MAJOR  0
@@ -92,6 +110,9 @@ struct mi_results_struct
 {
 	char *var; /* Result name or NULL if just a value. */
 	enum mi_val_type type;
+	unsigned hash; /* mi_hash_var of var, 0 if just a value. */
+	/* Allocated in the arena of a handle, the strings as well. */
+	char arena;
 	union
 	{
 		char *cstr;
@@ -101,6 +122,27 @@ struct mi_results_struct
 };
 typedef struct mi_results_struct mi_results;
 
+/* Lookup of the results of a tuple by name. Open addressing with the hashes
+   computed by the parser, the first result of a name is found like with
+   mi_get_var_r. Results past MI_INDEX_MAX are searched linearly. */
+#define MI_INDEX_SIZE 32 /* Power of two. */
+#define MI_INDEX_MAX  24
+
+typedef struct
+{
+	mi_results *slots[MI_INDEX_SIZE];
+	mi_results *rest;
+} mi_index;
+
+/* FNV-1a, evaluated at compile time for literal names. */
+constexpr inline unsigned mi_hash_var(const char *s)
+{
+	unsigned h = 2166136261u;
+	for (; *s; s++)
+		h = (h ^ (unsigned char)*s) * 16777619u;
+	return h;
+}
+
 struct mi_output_struct
 {
 	/* Type of output. */
@@ -108,6 +150,11 @@ struct mi_output_struct
 	char stype;
 	char sstype;
 	char tclass;
+	/* Allocated in the arena of a handle. */
+	char arena;
+	/* Not subscribed, so not parsed: c is a single constant holding the text
+	   after the type character. */
+	char raw;
 	/* Content. */
 	mi_results *c;
 	/* Always modeled as a list. */
@@ -115,6 +162,36 @@ struct mi_output_struct
 };
 typedef struct mi_output_struct mi_output;
 
+/* Bump allocator for the output of a single response. */
+struct mi_arena_block_struct
+{
+	struct mi_arena_block_struct *next;
+	size_t size;
+};
+typedef struct mi_arena_block_struct mi_arena_block;
+
+struct mi_arena_struct
+{
+	/* The blocks are kept when the arena is reset. */
+	mi_arena_block *first, *cur;
+	char *pos, *end;
+};
+typedef struct mi_arena_struct mi_arena;
+
+/* State of a parse, passed down the parser instead of globals, so
+   different threads can parse at the same time. */
+struct mi_parser_struct
+{
+	/* Arena the output is allocated from, NULL to use malloc. */
+	mi_arena *arena;
+	/* The parsed line may be modified: strings reference it instead of
+	   copies. */
+	char views;
+	/* MI_* code of the failure. */
+	int error;
+};
+typedef struct mi_parser_struct mi_parser;
+
 /* Values of this structure shouldn't be manipulated by the user. */
 struct mi_h_struct
 {
@@ -122,6 +199,16 @@ struct mi_h_struct
 	char *line;
 	/* Parsed output. */
 	mi_output *po, *last;
+	/* The last error of this handle, MI_FROM_GDB with the message of gdb
+	   for ^error records. */
+	int error;
+	char *error_from_gdb;
+	/* Arena for the parsed output, NULL if it's allocated with malloc. */
+	mi_arena *arena;
+	/* Strings reference a copy of the line in the arena. */
+	char views;
+	/* Records which are only classified, MI_REC_* flags. */
+	int skip;
 };
 typedef struct mi_h_struct mi_h;
 
@@ -382,19 +469,33 @@ struct mi_stop_struct
 };
 typedef struct mi_stop_struct mi_stop;
 
-/* Variable containing the last error. */
-extern int mi_error;
-extern char *mi_error_from_gdb;
-const char *mi_get_error_str();
+/* Message of the last error of a handle. */
+const char *mi_get_error_str(const mi_h *h);
 
 /* Parse gdb output. */
 mi_output *mi_parse_gdb_output(const char *str);
+mi_output *mi_parse_gdb_output_skip(mi_parser *p, const char *str, int skip);
+/* Get the type and class of gdb output without parsing it. */
+int mi_classify_output(mi_output *r, const char *str);
+/* Find the first '"', '\\' or terminator of a c-string. */
+const char *mi_scan_cstr(const char *s);
+/* Find the first '"', '\\' or '\n' in [s, end), end if there is none. */
+const char *mi_scan_chunk(const char *s, const char *end);
+/* Select the scan implementation, a negative level selects the best one.
+   Returns the selected level. Parsers running meanwhile may use either. */
+int mi_set_simd(int level);
 /* Wait until gdb sends a response. */
 mi_output *mi_get_response_blk(mi_h *h);
+/* Parse only the records of the MI_REC_* kinds, the others are passed on
+   raw. By default all records are parsed. */
+void mi_subscribe(mi_h *h, int records);
 /* Check if gdb sent a complete response. Use with mi_retire_response. */
 int mi_get_response(mi_h *h);
 /* Get the last response. Use with mi_get_response. */
 mi_output *mi_retire_response(mi_h *h);
+/* Release a retired response. In arena mode this resets the arena, so it
+   must be done before the next line is passed to mi_get_response. */
+void mi_release_response(mi_h *h, mi_output *r);
 /* Look for a result record in gdb output. */
 mi_output *mi_get_rrecord(mi_output *r);
 /* Look if the output contains an async stop.
@@ -430,6 +531,16 @@ int mi_res_changelist(mi_h *h, mi_gvar_chg **changed);
 int mi_res_children(mi_h *h, mi_gvar *v);
 // mi_bkpt *mi_res_bkpt(mi_h *h); // original func
 mi_bkpt *mi_res_bkpt(mi_output *output);
+/* Take a string or a list out of a result. Arena memory is copied. */
+char *mi_take_cstr(mi_results *r);
+mi_results *mi_take_results(mi_results *r);
+mi_results *mi_copy_results(const mi_results *r);
+/* Index the results of a tuple. The index is valid while they are. */
+void mi_index_results(mi_index *ix, mi_results *r);
+mi_results *mi_index_get_h(const mi_index *ix, const char *var, unsigned hash);
+#define mi_index_get(ix, var) mi_index_get_h(ix, var, mi_hash_var(var))
+/* Extract a breakpoint from the results of a bkpt tuple. */
+mi_bkpt *mi_get_bkpt(mi_results *p);
 mi_wp *mi_res_wp(mi_h *h);
 char *mi_res_value(mi_h *h);
 // mi_stop *mi_res_stop(mi_h *h); // original func
@@ -450,8 +561,19 @@ void *mi_calloc(size_t count, size_t sz);
 void *mi_calloc1(size_t sz);
 char *mi_malloc(size_t sz);
 mi_h *mi_alloc_h();
+/* Allocate the output of the handle in an arena. */
+int mi_use_arena(mi_h *h);
+/* Like mi_use_arena, but strings are views of a copy of the line. */
+int mi_use_views(mi_h *h);
+void *mi_arena_alloc(mi_arena *a, size_t sz);
+void mi_arena_reset(mi_arena *a);
 mi_results *mi_alloc_results(void);
 mi_output *mi_alloc_output(void);
+/* Allocation for the output of a parser, they set its error. */
+void *mi_parser_calloc(mi_parser *p, size_t sz);
+char *mi_parser_malloc(mi_parser *p, size_t sz);
+mi_results *mi_parser_alloc_results(mi_parser *p);
+mi_output *mi_parser_alloc_output(mi_parser *p);
 mi_frames *mi_alloc_frames(void);
 mi_gvar *mi_alloc_gvar(void);
 mi_gvar_chg *mi_alloc_gvar_chg(void);
@@ -462,6 +584,7 @@ mi_asm_insns *mi_alloc_asm_insns(void);
 mi_asm_insn *mi_alloc_asm_insn(void);
 mi_chg_reg *mi_alloc_chg_reg(void);
 void mi_free_h(mi_h **handle);
+void mi_free_arena(mi_arena *a);
 void mi_free_output(mi_output *r);
 void mi_free_output_but(mi_output *r, mi_output *no, mi_results *no_r);
 void mi_free_frames(mi_frames *f);
@@ -0,0 +1,788 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file loadgen.cpp
+ *
+ * @brief Contains the implementation of the LoadGenerator class.
+ *
+ * This file contains the implementation of the LoadGenerator class and the
+ * entry point of the load generator.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+#include "loadgen.hpp"
+
+using asio::ip::tcp;
+using std::string;
+using std::chrono::steady_clock;
+
+/// The period of the timer generating the events in milliseconds.
+#define LOADGEN_TICK_MS 5
+/// The maximum number of queued bytes per connection. More output is dropped.
+#define LOADGEN_MAX_PENDING (1 << 20)
+/// The number of seconds to retry connecting to the master.
+#define LOADGEN_CONNECT_TIMEOUT 30
+/// The number of lines of the emulated source file.
+#define LOADGEN_SOURCE_LINES 200
+/// The line of the main function in the emulated source file.
+#define LOADGEN_MAIN_LINE 10
+
+/**
+ * This is the default constructor for the LoadGenerator class.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param[in] argv The array containing the arguments passed to this program.
+ */
+LoadGenerator::LoadGenerator(const int argc, char **argv)
+	: m_argc(argc),
+	  m_argv(argv),
+	  m_ip_addr("127.0.0.1"),
+	  m_base_port(32768),
+	  m_num_processes(-1),
+	  m_event_rate(1.0),
+	  m_auto_continue(false),
+	  m_output_rate(0),
+	  m_burst_ms(100),
+	  m_skew(0.0),
+	  m_source_path("/tmp/pgdbloadgen.c"),
+	  m_duration(0),
+	  m_timer(m_io_context),
+	  m_processes(nullptr),
+	  m_num_open(0),
+	  m_bytes_sent(0),
+	  m_bytes_dropped(0),
+	  m_events(0),
+	  m_commands(0)
+{
+}
+
+/**
+ * This function closes all connections.
+ */
+LoadGenerator::~LoadGenerator()
+{
+	if (nullptr == m_processes)
+	{
+		return;
+	}
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		delete m_processes[rank].gdb.socket;
+		delete m_processes[rank].trgt.socket;
+	}
+	delete[] m_processes;
+}
+
+/**
+ * This function parses the command line arguments.
+ *
+ * @return @c true on success, @c false on error.
+ */
+bool LoadGenerator::parse_cl_args()
+{
+	int c;
+	opterr = 0;
+	while ((c = getopt(m_argc, m_argv, "hi:p:n:e:ao:b:s:f:t:")) != -1)
+	{
+		try
+		{
+			switch (c)
+			{
+			case 'i': // ip
+				m_ip_addr = optarg;
+				break;
+			case 'p': // port
+				m_base_port = std::stoi(optarg);
+				break;
+			case 'n': // number of processes
+				m_num_processes = std::stoi(optarg);
+				break;
+			case 'e': // stop events per second
+				m_event_rate = std::stod(optarg);
+				break;
+			case 'a': // continue automatically
+				m_auto_continue = true;
+				break;
+			case 'o': // target output per second
+				m_output_rate = std::stoi(optarg);
+				break;
+			case 'b': // burst interval
+				m_burst_ms = std::stoi(optarg);
+				break;
+			case 's': // skew
+				m_skew = std::stod(optarg);
+				break;
+			case 'f': // source file
+				m_source_path = optarg;
+				break;
+			case 't': // duration
+				m_duration = std::stoi(optarg);
+				break;
+			case 'h': // help
+				print_help();
+				exit(EXIT_SUCCESS);
+				break;
+			default:
+				fprintf(stderr, "Invalid option '-%c'.\n", optopt);
+				print_help();
+				return false;
+			}
+		}
+		catch (const std::exception &)
+		{
+			fprintf(stderr, "Could not parse the value of option -%c: %s\n", c,
+					optarg);
+			print_help();
+			return false;
+		}
+	}
+	if (m_num_processes <= 0)
+	{
+		fprintf(stderr, "Missing number of processes.\n");
+		print_help();
+		return false;
+	}
+	if (m_base_port < 0 || m_base_port + 2 * m_num_processes > 0x10000 ||
+		m_event_rate <= 0.0 || m_output_rate < 0 || m_burst_ms <= 0 ||
+		m_skew < 0.0 || m_skew > 1.0 || m_duration < 0)
+	{
+		fprintf(stderr, "Invalid option value.\n");
+		print_help();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * This function connects a socket to a port of the master. As the master
+ * might still be starting, connecting is retried for a while.
+ *
+ * @param[out] socket The socket.
+ *
+ * @param port The TCP port.
+ *
+ * @return @c true on success, @c false on timeout.
+ */
+bool LoadGenerator::connect(tcp::socket &socket, const int port)
+{
+	const tcp::endpoint endpoint(asio::ip::make_address(m_ip_addr), port);
+	const steady_clock::time_point deadline =
+		steady_clock::now() + std::chrono::seconds(LOADGEN_CONNECT_TIMEOUT);
+	for (;;)
+	{
+		asio::error_code error;
+		socket.connect(endpoint, error);
+		if (!error)
+		{
+			socket.set_option(tcp::no_delay(true));
+			return true;
+		}
+		socket.close();
+		if (steady_clock::now() >= deadline)
+		{
+			fprintf(stderr, "Could not connect to port %d: %s\n", port,
+					error.message().c_str());
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+}
+
+/**
+ * This function opens the GDB and target connections of all processes and
+ * emits the output of a GDB instance starting the target up to the breakpoint
+ * at main.
+ *
+ * @return @c true on success, @c false on error.
+ */
+bool LoadGenerator::open_connections()
+{
+	m_processes = new Process[m_num_processes];
+	m_start = steady_clock::now();
+	m_last_report = m_start;
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		Process &process = m_processes[rank];
+		process.rank = rank;
+		process.gdb.socket = new tcp::socket(m_io_context);
+		process.gdb.writing = false;
+		process.trgt.socket = new tcp::socket(m_io_context);
+		process.trgt.writing = false;
+		process.state = RUNNING;
+		process.line = LOADGEN_MAIN_LINE;
+		process.num_bkpts = 1;
+		process.hits = 0;
+		process.value_count = 0;
+		process.stepping = false;
+		process.output_count = 0;
+		process.random.seed(rank);
+		// spread the rates linearly around the mean
+		process.rate = 1.0;
+		if (m_num_processes > 1)
+		{
+			process.rate += m_skew * (2.0 * rank / (m_num_processes - 1) - 1.0);
+		}
+		process.rate = std::max(process.rate, 0.01);
+		if (!connect(*process.gdb.socket, m_base_port + rank) ||
+			!connect(*process.trgt.socket, m_base_port + m_num_processes + rank))
+		{
+			return false;
+		}
+		m_num_open += 2;
+	}
+	fprintf(stderr, "Opened %d connections.\n", m_num_open);
+
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		Process &process = m_processes[rank];
+		const string pid = std::to_string(10000 + rank);
+		send(process.gdb,
+			 "=thread-group-added,id=\"i1\"\n"
+			 "~\"Reading symbols from target...\\n\"\n"
+			 "=breakpoint-created," +
+				 breakpoint(1, LOADGEN_MAIN_LINE) +
+				 "\n"
+				 "=thread-group-started,id=\"i1\",pid=\"" +
+				 pid + "\"\n"
+					   "=thread-created,id=\"1\",group-id=\"i1\"\n"
+					   "*running,thread-id=\"all\"\n"
+					   "(gdb)\n");
+		emit_stopped(process, "breakpoint-hit");
+		process.next_event = m_start + next_interval(process);
+		process.next_output = m_start;
+		read(process, process.gdb, true);
+		read(process, process.trgt, false);
+	}
+	return true;
+}
+
+/**
+ * This function queues data for a connection. If the master does not read
+ * fast enough and too much data is queued, the data is dropped.
+ *
+ * @param[in] conn The connection.
+ *
+ * @param[in] data The data to send.
+ */
+void LoadGenerator::send(Connection &conn, const string &data)
+{
+	if (!conn.socket->is_open())
+	{
+		return;
+	}
+	if (conn.pending.size() > LOADGEN_MAX_PENDING)
+	{
+		m_bytes_dropped += data.size();
+		return;
+	}
+	conn.pending += data;
+	if (!conn.writing)
+	{
+		write(conn);
+	}
+}
+
+/**
+ * This function writes all queued data of a connection. Data queued while
+ * writing is written afterwards in one go.
+ *
+ * @param[in] conn The connection.
+ */
+void LoadGenerator::write(Connection &conn)
+{
+	conn.sending.swap(conn.pending);
+	conn.pending.clear();
+	conn.writing = true;
+	asio::async_write(*conn.socket, asio::buffer(conn.sending),
+					  [this, &conn](const asio::error_code &error,
+									const std::size_t length)
+					  {
+						  conn.writing = false;
+						  if (error)
+						  {
+							  close(conn);
+							  return;
+						  }
+						  m_bytes_sent += length;
+						  if (!conn.pending.empty())
+						  {
+							  write(conn);
+						  }
+					  });
+}
+
+/**
+ * This function reads from a connection. Commands on the GDB connection are
+ * answered, a Ctrl+C on the target connection interrupts the process.
+ *
+ * @param[in] process The process owning the connection.
+ *
+ * @param[in] conn The connection.
+ *
+ * @param is_gdb Whether the connection is the GDB connection.
+ */
+void LoadGenerator::read(Process &process, Connection &conn, const bool is_gdb)
+{
+	conn.socket->async_read_some(
+		asio::buffer(conn.buffer, LOADGEN_READ_SIZE),
+		[this, &process, &conn, is_gdb](const asio::error_code &error,
+										const std::size_t length)
+		{
+			if (error)
+			{
+				close(conn);
+				return;
+			}
+			if (!is_gdb)
+			{
+				if (nullptr != memchr(conn.buffer, '\3', length) &&
+					RUNNING == process.state)
+				{
+					emit_stopped(process, "signal-received");
+				}
+			}
+			else
+			{
+				conn.line.append(conn.buffer, length);
+				size_t newline;
+				while (string::npos != (newline = conn.line.find('\n')))
+				{
+					const string command = conn.line.substr(0, newline);
+					conn.line.erase(0, newline + 1);
+					handle_command(process, command);
+				}
+			}
+			read(process, conn, is_gdb);
+		});
+}
+
+/**
+ * This function closes a connection. When all connections are closed, the
+ * event loop ends.
+ *
+ * @param[in] conn The connection.
+ */
+void LoadGenerator::close(Connection &conn)
+{
+	if (!conn.socket->is_open())
+	{
+		return;
+	}
+	asio::error_code error;
+	conn.socket->close(error);
+	if (0 == --m_num_open)
+	{
+		m_timer.cancel();
+	}
+}
+
+/**
+ * This function returns the MI frame of the current location of a process.
+ *
+ * @param[in] process The process.
+ *
+ * @return The frame as MI result.
+ */
+string LoadGenerator::frame(const Process &process) const
+{
+	char addr[32];
+	snprintf(addr, sizeof(addr), "0x%016x", 0x1000 + 4 * process.line);
+	return "frame={addr=\"" + string(addr) +
+		   "\",func=\"main\",args=[],file=\"loadgen.c\",fullname=\"" +
+		   m_source_path + "\",line=\"" + std::to_string(process.line) +
+		   "\",arch=\"i386:x86-64\"}";
+}
+
+/**
+ * This function returns the MI description of a breakpoint.
+ *
+ * @param number The breakpoint number.
+ *
+ * @param line The line of the breakpoint.
+ *
+ * @return The breakpoint as MI result.
+ */
+string LoadGenerator::breakpoint(const int number, const int line) const
+{
+	char addr[32];
+	snprintf(addr, sizeof(addr), "0x%016x", 0x1000 + 4 * line);
+	return "bkpt={number=\"" + std::to_string(number) +
+		   "\",type=\"breakpoint\",disp=\"keep\",enabled=\"y\",addr=\"" +
+		   string(addr) + "\",func=\"main\",file=\"loadgen.c\",fullname=\"" +
+		   m_source_path + "\",line=\"" + std::to_string(line) +
+		   "\",thread-groups=[\"i1\"],times=\"0\",original-location=\"" +
+		   m_source_path + ":" + std::to_string(line) + "\"}";
+}
+
+/**
+ * This function emits the records of a process starting to run.
+ *
+ * @param[in] process The process.
+ *
+ * @param command Whether the process runs due to a command, which is answered
+ * with a result record.
+ */
+void LoadGenerator::emit_running(Process &process, const bool command)
+{
+	process.state = RUNNING;
+	++m_events;
+	send(process.gdb, string(command ? "^running\n" : "") +
+						  "*running,thread-id=\"all\"\n(gdb)\n");
+}
+
+/**
+ * This function emits the records of a process stopping. At a breakpoint the
+ * process stops at a random line, after a step at the next line.
+ *
+ * @param[in] process The process.
+ *
+ * @param[in] reason The stop reason.
+ */
+void LoadGenerator::emit_stopped(Process &process, const char *reason)
+{
+	process.state = STOPPED;
+	++m_events;
+	string records;
+	string details;
+	if (0 == strcmp(reason, "breakpoint-hit"))
+	{
+		const int bkptno =
+			1 + (int)(process.random() % (unsigned)process.num_bkpts);
+		if (process.hits > 0)
+		{
+			process.line = 1 + (int)(process.random() % LOADGEN_SOURCE_LINES);
+		}
+		++process.hits;
+		string bkpt = breakpoint(bkptno, process.line);
+		bkpt.replace(bkpt.find("times=\"0\""), 9,
+					 "times=\"" + std::to_string(process.hits) + "\"");
+		records = "=breakpoint-modified," + bkpt + "\n";
+		details = ",disp=\"keep\",bkptno=\"" + std::to_string(bkptno) + "\"";
+	}
+	else if (0 == strcmp(reason, "end-stepping-range"))
+	{
+		process.line = process.line % LOADGEN_SOURCE_LINES + 1;
+	}
+	else
+	{
+		details = ",signal-name=\"SIGINT\",signal-meaning=\"Interrupt\"";
+	}
+	send(process.gdb, records + "*stopped,reason=\"" + reason + "\"" + details +
+						  "," + frame(process) +
+						  ",thread-id=\"1\",stopped-threads=\"all\",core=\"" +
+						  std::to_string(process.rank % 64) + "\"\n(gdb)\n");
+}
+
+/**
+ * This function emits a burst of target output as numbered lines.
+ *
+ * @param[in] process The process.
+ *
+ * @param bytes The approximate number of bytes to emit.
+ */
+void LoadGenerator::emit_output(Process &process, const std::size_t bytes)
+{
+	string output;
+	while (output.size() < bytes)
+	{
+		output += "rank " + std::to_string(process.rank) + " line " +
+				  std::to_string(process.output_count++) +
+				  ": the quick brown fox jumps over the lazy dog\n";
+	}
+	send(process.trgt, output);
+}
+
+/**
+ * This function draws the time until the next event of a process. The
+ * intervals are exponentially distributed around the configured rate.
+ *
+ * @param[in] process The process.
+ *
+ * @return The interval.
+ */
+steady_clock::duration LoadGenerator::next_interval(Process &process)
+{
+	std::exponential_distribution<double> distribution(m_event_rate *
+													   process.rate);
+	return std::chrono::duration_cast<steady_clock::duration>(
+		std::chrono::duration<double>(distribution(process.random)));
+}
+
+/**
+ * This function answers a command of the master like GDB would. Execution
+ * commands change the state of the process, the resulting stop is emitted
+ * later by @ref tick. Unknown commands are acknowledged without output.
+ *
+ * @param[in] process The process.
+ *
+ * @param command The command line.
+ */
+void LoadGenerator::handle_command(Process &process, string command)
+{
+	++m_commands;
+	if (!command.empty() && '\r' == command.back())
+	{
+		command.pop_back();
+	}
+	const size_t space = command.find(' ');
+	const string name = command.substr(0, space);
+	const string arg = string::npos == space ? "" : command.substr(space + 1);
+	const steady_clock::time_point now = steady_clock::now();
+
+	const bool step = "next" == name || "n" == name || "-exec-next" == name ||
+					  "step" == name || "s" == name || "-exec-step" == name ||
+					  "finish" == name || "-exec-finish" == name;
+	const bool cont = "continue" == name || "c" == name ||
+					  "-exec-continue" == name;
+	const bool run = "run" == name || "r" == name || "-exec-run" == name;
+	if (step || cont || run)
+	{
+		if (RUNNING == process.state)
+		{
+			send(process.gdb, "^error,msg=\"Cannot execute this command while "
+							  "the target is running.\"\n(gdb)\n");
+			return;
+		}
+		if (EXITED == process.state && !run)
+		{
+			send(process.gdb, "^error,msg=\"The program is not being "
+							  "run.\"\n(gdb)\n");
+			return;
+		}
+		if (run)
+		{
+			process.line = LOADGEN_MAIN_LINE;
+			process.hits = 0;
+		}
+		emit_running(process, true);
+		process.stepping = step;
+		process.next_event = step || run
+								 ? now + std::chrono::milliseconds(1)
+								 : now + next_interval(process);
+		return;
+	}
+	if ("-exec-interrupt" == name || "interrupt" == name)
+	{
+		send(process.gdb, "^done\n(gdb)\n");
+		if (RUNNING == process.state)
+		{
+			emit_stopped(process, "signal-received");
+		}
+		return;
+	}
+	if ("kill" == name || "k" == name)
+	{
+		process.state = EXITED;
+		send(process.gdb, "=thread-exited,id=\"1\",group-id=\"i1\"\n"
+						  "=thread-group-exited,id=\"i1\"\n^done\n(gdb)\n");
+		return;
+	}
+	if ("-break-insert" == name || "break" == name || "b" == name)
+	{
+		int line = 1 + (int)(process.random() % LOADGEN_SOURCE_LINES);
+		try
+		{
+			line = std::stoi(arg.substr(arg.rfind(':') + 1));
+		}
+		catch (const std::exception &)
+		{
+		}
+		const string bkpt = breakpoint(++process.num_bkpts, line);
+		if ('-' == name[0])
+		{
+			send(process.gdb, "^done," + bkpt + "\n(gdb)\n");
+		}
+		else
+		{
+			send(process.gdb, "~\"Breakpoint " +
+								  std::to_string(process.num_bkpts) +
+								  " at 0x1000: file loadgen.c, line " +
+								  std::to_string(line) +
+								  ".\\n\"\n=breakpoint-created," + bkpt +
+								  "\n^done\n(gdb)\n");
+		}
+		return;
+	}
+	if ("backtrace" == name || "bt" == name || "where" == name)
+	{
+		send(process.gdb, "~\"#0  main () at " + m_source_path + ":" +
+							  std::to_string(process.line) +
+							  "\\n\"\n^done\n(gdb)\n");
+		return;
+	}
+	if ("-stack-list-frames" == name)
+	{
+		send(process.gdb, "^done,stack=[" + frame(process).replace(0, 7, "frame={level=\"0\",") + "]\n(gdb)\n");
+		return;
+	}
+	if ("-data-evaluate-expression" == name)
+	{
+		send(process.gdb, "^done,value=\"" + std::to_string(process.rank) +
+							  "\"\n(gdb)\n");
+		return;
+	}
+	if ("print" == name || "p" == name)
+	{
+		send(process.gdb, "~\"$" + std::to_string(++process.value_count) +
+							  " = " + std::to_string(process.rank) +
+							  "\\n\"\n^done\n(gdb)\n");
+		return;
+	}
+	send(process.gdb, "^done\n(gdb)\n");
+}
+
+/**
+ * This function generates the timed events of all processes: stops of running
+ * processes, automatic continues and target output bursts. Once per second
+ * the throughput is printed to stderr.
+ */
+void LoadGenerator::tick()
+{
+	const steady_clock::time_point now = steady_clock::now();
+	if (m_duration > 0 && now - m_start >= std::chrono::seconds(m_duration))
+	{
+		for (int rank = 0; rank < m_num_processes; ++rank)
+		{
+			close(m_processes[rank].gdb);
+			close(m_processes[rank].trgt);
+		}
+		return;
+	}
+
+	const std::size_t burst_bytes = (std::size_t)m_output_rate * m_burst_ms / 1000;
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		Process &process = m_processes[rank];
+		if (RUNNING == process.state && now >= process.next_event)
+		{
+			emit_stopped(process, process.stepping ? "end-stepping-range"
+												   : "breakpoint-hit");
+			process.stepping = false;
+			process.next_event = now + next_interval(process);
+		}
+		else if (STOPPED == process.state && m_auto_continue &&
+				 now >= process.next_event)
+		{
+			emit_running(process, false);
+			process.next_event = now + next_interval(process);
+		}
+		if (burst_bytes > 0 && EXITED != process.state &&
+			now >= process.next_output)
+		{
+			emit_output(process, (std::size_t)(burst_bytes * process.rate));
+			process.next_output = now + std::chrono::milliseconds(m_burst_ms);
+		}
+	}
+
+	if (now - m_last_report >= std::chrono::seconds(1))
+	{
+		const double seconds =
+			std::chrono::duration<double>(now - m_last_report).count();
+		fprintf(stderr,
+				"%.0f s: %d open, %.2f MiB/s sent, %.0f events/s, "
+				"%.0f commands/s, %.2f MiB dropped\n",
+				std::chrono::duration<double>(now - m_start).count(),
+				m_num_open, m_bytes_sent / seconds / (1 << 20),
+				m_events / seconds, m_commands / seconds,
+				m_bytes_dropped / (double)(1 << 20));
+		m_bytes_sent = 0;
+		m_events = 0;
+		m_commands = 0;
+		m_last_report = now;
+	}
+
+	m_timer.expires_after(std::chrono::milliseconds(LOADGEN_TICK_MS));
+	m_timer.async_wait([this](const asio::error_code &error)
+					   {
+						   if (!error && m_num_open > 0)
+						   {
+							   tick();
+						   }
+					   });
+}
+
+/**
+ * This function runs the event loop until all connections are closed, either
+ * by the master or after the configured duration.
+ */
+void LoadGenerator::run()
+{
+	tick();
+	m_io_context.run();
+}
+
+/**
+ * This function prints the help text.
+ */
+void LoadGenerator::print_help()
+{
+	fprintf(
+		stderr,
+		"Usage: ./pgdbloadgen -n <num> [OPTIONS]\n"
+		"  -n <num>\t number of emulated processes\n"
+		"  -h\t\t print this help\n"
+		"\n"
+		"Options:\n"
+		"  -i <addr>\t master IP address (default 127.0.0.1)\n"
+		"  -p <port>\t the base port (default 32768)\n"
+		"  -e <rate>\t stops per second of a running process (default 1)\n"
+		"  -a\t\t continue automatically after every stop\n"
+		"  -o <bytes>\t target output per second and process (default 0)\n"
+		"  -b <ms>\t interval of the target output bursts (default 100)\n"
+		"  -s <skew>\t spread of the rates over the ranks, 0 to 1 (default 0)\n"
+		"  -f <path>\t source file reported in the frames\n"
+		"  -t <sec>\t close the connections after this time (default: never)\n");
+}
+
+/// Entry point for the load generator.
+/**
+ * This program emulates the slaves of many processes for scale testing the
+ * master.
+ *
+ * @param argc The number of arguments passed to this program.
+ *
+ * @param argv The array containing the arguments.
+ *
+ * @return The exit state of the program.
+ */
+int main(const int argc, char **argv)
+{
+	LoadGenerator generator(argc, argv);
+
+	if (!generator.parse_cl_args())
+	{
+		return EXIT_FAILURE;
+	}
+	if (!generator.open_connections())
+	{
+		return EXIT_FAILURE;
+	}
+	generator.run();
+
+	return EXIT_SUCCESS;
+}
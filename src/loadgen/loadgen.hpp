@@ -0,0 +1,162 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file loadgen.hpp
+ *
+ * @brief Header file for the LoadGenerator class.
+ *
+ * This is the header file for the LoadGenerator class.
+ */
+
+#ifndef LOADGEN_HPP
+#define LOADGEN_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "asio.hpp"
+
+/// The number of bytes read from a connection at once.
+#define LOADGEN_READ_SIZE 4096
+
+/// Emulates the slaves of many processes for scale testing the master.
+/**
+ * This class opens the GDB and target connections of every process to the
+ * master, just like the socat instances of the slaves, and emits MI traffic
+ * as GDB would: stop records with frames, breakpoint notifications, console
+ * streams and bursty target output. Commands sent by the master (next, step,
+ * continue, breakpoints, backtrace, ...) are answered plausibly.
+ *
+ * All connections are served by a single asio event loop. A periodic tick
+ * generates the timed events of all processes.
+ */
+class LoadGenerator
+{
+	/// The execution state of an emulated process.
+	enum State
+	{
+		STOPPED,
+		RUNNING,
+		EXITED
+	};
+
+	/// A connection to the master.
+	struct Connection
+	{
+		asio::ip::tcp::socket *socket;
+		std::string pending;
+		std::string sending;
+		bool writing;
+		std::string line;
+		char buffer[LOADGEN_READ_SIZE];
+	};
+
+	/// An emulated process: GDB and the target program.
+	struct Process
+	{
+		int rank;
+		Connection gdb;
+		Connection trgt;
+		State state;
+		int line;
+		int num_bkpts;
+		int hits;
+		int value_count;
+		double rate;
+		bool stepping;
+		std::chrono::steady_clock::time_point next_event;
+		std::chrono::steady_clock::time_point next_output;
+		std::uint64_t output_count;
+		std::mt19937 random;
+	};
+
+	const int m_argc;
+	char **m_argv;
+
+	std::string m_ip_addr;
+	int m_base_port;
+	int m_num_processes;
+	double m_event_rate;
+	bool m_auto_continue;
+	int m_output_rate;
+	int m_burst_ms;
+	double m_skew;
+	std::string m_source_path;
+	int m_duration;
+
+	asio::io_context m_io_context;
+	asio::steady_timer m_timer;
+	Process *m_processes;
+	int m_num_open;
+	std::chrono::steady_clock::time_point m_start;
+	std::chrono::steady_clock::time_point m_last_report;
+	std::uint64_t m_bytes_sent;
+	std::uint64_t m_bytes_dropped;
+	std::uint64_t m_events;
+	std::uint64_t m_commands;
+
+	/// Connects a socket to a port of the master.
+	bool connect(asio::ip::tcp::socket &socket, const int port);
+	/// Queues data for a connection.
+	void send(Connection &conn, const std::string &data);
+	/// Writes the queued data of a connection.
+	void write(Connection &conn);
+	/// Reads from a connection.
+	void read(Process &process, Connection &conn, const bool is_gdb);
+	/// Closes a connection.
+	void close(Connection &conn);
+	/// Answers a command of the master.
+	void handle_command(Process &process, std::string command);
+	/// Handles the periodic timer.
+	void tick();
+
+	/// Returns the MI frame of the current location of a process.
+	std::string frame(const Process &process) const;
+	/// Returns the MI description of a breakpoint.
+	std::string breakpoint(const int number, const int line) const;
+	/// Emits the records of a process starting to run.
+	void emit_running(Process &process, const bool command);
+	/// Emits the records of a process stopping.
+	void emit_stopped(Process &process, const char *reason);
+	/// Emits a burst of target output.
+	void emit_output(Process &process, const std::size_t bytes);
+	/// Draws the time until the next event of a process.
+	std::chrono::steady_clock::duration next_interval(Process &process);
+
+public:
+	/// Default constructor.
+	LoadGenerator(const int argc, char **argv);
+	/// Destructor.
+	~LoadGenerator();
+
+	/// Parses the command line arguments.
+	bool parse_cl_args();
+	/// Opens the connections of all processes.
+	bool open_connections();
+	/// Runs the event loop until all connections are closed.
+	void run();
+
+	/// Prints the help text.
+	static void print_help();
+};
+
+#endif /* LOADGEN_HPP */
@@ -87,7 +87,7 @@ Breakpoint::~Breakpoint()
  * Breakpoints are ID'd by a number which is set by GDB. It is saved in the
  * @ref m_numbers array per process. The @ref m_numbers array is set by the
  * @ref set_number function which is called by the
- * @ref UIWindow::handle_data_gdb function, when the corresponding GDB output
+ * @ref UIWindow::apply_breakpoint function, when the corresponding GDB output
  * has been parsed.
  */
 bool Breakpoint::create_breakpoint(const int rank)
@@ -99,7 +99,7 @@ bool Breakpoint::create_breakpoint(const int rank)
 	}
 	string cmd =
 		"-break-insert " + m_full_path + ":" + std::to_string(m_line) + "\n";
-	if (m_window->send_data(m_window->get_conns_gdb(rank), cmd))
+	if (m_window->send_data(true, rank, cmd))
 	{
 		m_window->set_breakpoint(rank, this);
 		m_breakpoint_state[rank] = CREATED;
@@ -120,8 +120,8 @@ bool Breakpoint::create_breakpoint(const int rank)
  * Breakpoints are ID'd by a number which is set by GDB. It is saved in the
  * @ref m_numbers array per process and used in this function to delete it.
  * The @ref m_numbers array is set by the @ref set_number function which is
- * called by the @ref UIWindow::handle_data_gdb function, when the corresponding
- * GDB output has been parsed.
+ * called by the @ref UIWindow::apply_breakpoint function, when the
+ * corresponding GDB output has been parsed.
  */
 bool Breakpoint::delete_breakpoint(const int rank)
 {
@@ -131,7 +131,7 @@ bool Breakpoint::delete_breakpoint(const int rank)
 		return false;
 	}
 	string cmd = "-break-delete " + std::to_string(m_numbers[rank]) + "\n";
-	if (m_window->send_data(m_window->get_conns_gdb(rank), cmd))
+	if (m_window->send_data(true, rank, cmd))
 	{
 		m_breakpoint_state[rank] = NOT_EXISTING;
 		return true;
@@ -0,0 +1,157 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file buffer_pool.cpp
+ *
+ * @brief Contains the implementation of the BufferPool class.
+ *
+ * This file contains the implementation of the BufferPool class.
+ */
+
+#include "buffer_pool.hpp"
+
+using std::size_t;
+
+/**
+ * This is the default constructor for the BufferPool class. It allocates the
+ * free lists, the buffers themselves are allocated on demand.
+ *
+ * @param num_ports The number of TCP ports (two per process).
+ *
+ * @param buffer_size The size of a single buffer in bytes.
+ *
+ * @param buffers_per_port The maximum number of buffers a port can have in
+ * flight. This is rounded up to the next power of two.
+ *
+ * @param max_idle The maximum number of free buffers kept over all ports.
+ */
+BufferPool::BufferPool(const int num_ports, const size_t buffer_size,
+					   const size_t buffers_per_port, const size_t max_idle)
+	: m_num_ports(num_ports),
+	  m_buffer_size(buffer_size),
+	  m_mask([buffers_per_port]
+			 {
+				 size_t size = 1;
+				 while (size < buffers_per_port)
+				 {
+					 size <<= 1;
+				 }
+				 return size - 1;
+			 }()),
+	  m_max_idle(max_idle),
+	  m_free_lists(new FreeList[num_ports]),
+	  m_idle(0),
+	  m_allocations(0)
+{
+	for (int idx = 0; idx < m_num_ports; ++idx)
+	{
+		m_free_lists[idx].slots = new char *[m_mask + 1];
+		m_free_lists[idx].head = 0;
+		m_free_lists[idx].tail = 0;
+	}
+}
+
+/**
+ * This function deallocates all buffers ever handed out by this pool. So no
+ * buffer must be in use anymore when the pool is destroyed.
+ */
+BufferPool::~BufferPool()
+{
+	for (char *const buffer : m_owned)
+	{
+		delete[] buffer;
+	}
+	for (int idx = 0; idx < m_num_ports; ++idx)
+	{
+		delete[] m_free_lists[idx].slots;
+	}
+	delete[] m_free_lists;
+}
+
+/**
+ * This function takes a buffer from the free list of a port. If the free list
+ * is empty, a new buffer is allocated and counted in @ref m_allocations.
+ *
+ * @param idx The port index (port - base port).
+ *
+ * @return The buffer. It has a size of @ref buffer_size bytes.
+ */
+char *BufferPool::acquire(const int idx)
+{
+	FreeList &list = m_free_lists[idx];
+	const size_t tail = list.tail.load(std::memory_order_relaxed);
+	if (tail != list.head.load(std::memory_order_acquire))
+	{
+		char *const buffer = list.slots[tail & m_mask];
+		list.tail.store(tail + 1, std::memory_order_release);
+		m_idle.fetch_sub(1, std::memory_order_relaxed);
+		return buffer;
+	}
+	char *const buffer = new char[m_buffer_size];
+	m_allocations.fetch_add(1, std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(m_mutex_owned);
+	m_owned.insert(buffer);
+	return buffer;
+}
+
+/**
+ * This function returns a buffer to the free list of a port. Should the free
+ * list be full or the pool already keep @ref m_max_idle free buffers, the
+ * buffer is deallocated, see @ref discard. Only a single thread may return the
+ * buffers of a port.
+ *
+ * @param idx The port index (port - base port).
+ *
+ * @param[in] buffer The buffer, previously returned by @ref acquire.
+ */
+void BufferPool::release(const int idx, char *const buffer)
+{
+	FreeList &list = m_free_lists[idx];
+	const size_t head = list.head.load(std::memory_order_relaxed);
+	if (head - list.tail.load(std::memory_order_acquire) > m_mask)
+	{
+		discard(buffer);
+		return;
+	}
+	if (m_idle.fetch_add(1, std::memory_order_relaxed) >= m_max_idle)
+	{
+		m_idle.fetch_sub(1, std::memory_order_relaxed);
+		discard(buffer);
+		return;
+	}
+	list.slots[head & m_mask] = buffer;
+	list.head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * This function deallocates a buffer instead of returning it to a free list.
+ * Unlike @ref release, it may be called from any thread, e.g. by a reading
+ * thread left with an unused buffer.
+ *
+ * @param[in] buffer The buffer, previously returned by @ref acquire.
+ */
+void BufferPool::discard(char *const buffer)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_owned);
+		m_owned.erase(buffer);
+	}
+	delete[] buffer;
+}
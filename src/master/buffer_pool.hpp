@@ -0,0 +1,113 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file buffer_pool.hpp
+ *
+ * @brief Header file for the BufferPool class.
+ *
+ * This is the header file for the BufferPool class.
+ */
+
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+
+/// The maximum number of bytes received at once.
+#define MAX_LENGTH 8192 // socat default
+
+/// Recycles the fixed-size receive buffers of the TCP ports.
+/**
+ * This class hands out fixed-size receive buffers to the threads reading from
+ * the TCP sockets. A buffer is passed on by ownership together with the
+ * received data and returned to the pool after it has been processed. Every
+ * port has its own lock-free free list, filled by the thread processing the
+ * data and emptied by the reading thread. New memory is only allocated when a
+ * free list runs dry, so in the steady state the receive path does not
+ * allocate at all. A buffer which does not fit into a full free list is
+ * deallocated right away, as is a buffer beyond the number of idle buffers
+ * kept over all ports. So the pool does not keep the peak usage of every
+ * port.
+ */
+class BufferPool
+{
+	/// A single-producer/single-consumer ring of free buffers.
+	struct FreeList
+	{
+		char **slots;
+		alignas(64) std::atomic<std::size_t> head;
+		alignas(64) std::atomic<std::size_t> tail;
+	};
+
+	const int m_num_ports;
+	const std::size_t m_buffer_size;
+	const std::size_t m_mask;
+	const std::size_t m_max_idle;
+	FreeList *const m_free_lists;
+	alignas(64) std::atomic<std::size_t> m_idle;
+
+	std::mutex m_mutex_owned;
+	std::unordered_set<char *> m_owned;
+
+	std::atomic<std::uint64_t> m_allocations;
+
+public:
+	/// Default constructor.
+	BufferPool(const int num_ports, const std::size_t buffer_size,
+			   const std::size_t buffers_per_port, const std::size_t max_idle);
+	/// Destructor.
+	~BufferPool();
+
+	/// Takes a buffer from the free list of a port. (network thread)
+	char *acquire(const int idx);
+	/// Returns a buffer to the free list of a port. (processing thread)
+	void release(const int idx, char *const buffer);
+	/// Deallocates a buffer instead of returning it. (any thread)
+	void discard(char *const buffer);
+
+	/// Returns the size of a buffer.
+	/**
+	 * This function returns the size of a buffer.
+	 *
+	 * @return The size of a buffer in bytes.
+	 */
+	inline std::size_t buffer_size() const
+	{
+		return m_buffer_size;
+	}
+
+	/// Returns the number of buffers allocated so far.
+	/**
+	 * This function returns the number of buffers allocated so far. Sampling
+	 * this periodically gives the allocation rate of the receive path.
+	 *
+	 * @return The number of buffers allocated so far.
+	 */
+	inline std::uint64_t allocations() const
+	{
+		return m_allocations.load(std::memory_order_relaxed);
+	}
+};
+
+#endif /* BUFFER_POOL_HPP */
@@ -66,10 +66,17 @@ public:
 	 * @param rank The process rank to set the offset for.
 	 *
 	 * @param offset The offset in pixels.
+	 *
+	 * @return @c true if the offset changed.
 	 */
-	void set_y_offset(const int rank, const int offset)
+	bool set_y_offset(const int rank, const int offset)
 	{
+		if (m_y_offsets[rank] == offset)
+		{
+			return false;
+		}
 		m_y_offsets[rank] = offset;
+		return true;
 	}
 
 	/// Returns the radius of the dots.
@@ -0,0 +1,98 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file frame_cache.cpp
+ *
+ * @brief Contains the implementation of the FrameCache class.
+ *
+ * This file contains the implementation of the FrameCache class.
+ */
+
+#include <functional>
+#include <string_view>
+
+#include "frame_cache.hpp"
+#include "intern_table.hpp"
+#include "mi_event.hpp"
+
+using std::size_t;
+using std::string_view;
+
+/**
+ * This is the default constructor for the FrameCache class. It allocates the
+ * empty slots.
+ */
+FrameCache::FrameCache()
+	: m_slots(new Slot[FRAME_CACHE_SLOTS]())
+{
+	for (int idx = 0; idx < FRAME_CACHE_SLOTS; ++idx)
+	{
+		m_slots[idx].frame = StopFrame{INTERN_NONE, INTERN_NONE, 0};
+	}
+}
+
+/**
+ * This function deallocates the slots.
+ */
+FrameCache::~FrameCache()
+{
+	delete[] m_slots;
+}
+
+/**
+ * This function returns the location of the frame of a stop. If the frame is
+ * cached, the cached location is returned. Otherwise the location is extracted
+ * from the frame, its file and function are interned and the new location
+ * replaces the one in the slot of the frame.
+ *
+ * @param[in] text The text of the frame, MiStopped::frame. It must not be
+ * empty.
+ *
+ * @param[in] strings The table the file and function are interned in on a
+ * miss.
+ *
+ * @param[out] hit Whether the frame was cached.
+ *
+ * @return The location, with the file @ref INTERN_NONE if the frame has none.
+ * It is valid until the next call of this function.
+ */
+const StopFrame &FrameCache::lookup(const string_view text,
+									InternTable &strings, bool &hit)
+{
+	const size_t hash = std::hash<string_view>()(text);
+	Slot &slot = m_slots[hash % FRAME_CACHE_SLOTS];
+	hit = slot.hash == hash && slot.text == text;
+	if (!hit)
+	{
+		// the strings are unescaped in place, so a copy is parsed
+		m_scratch.assign(text);
+		MiFrame location;
+		if (!parse_mi_frame(&m_scratch[0], location) ||
+			location.fullname.empty())
+		{
+			location = MiFrame{string_view(), 0, string_view()};
+		}
+		slot.hash = hash;
+		slot.text.assign(text);
+		slot.frame = StopFrame{strings.intern(location.fullname),
+							   strings.intern(location.func), location.line};
+	}
+	return slot.frame;
+}
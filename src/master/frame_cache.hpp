@@ -0,0 +1,89 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file frame_cache.hpp
+ *
+ * @brief Header file for the FrameCache class.
+ *
+ * This is the header file for the FrameCache class.
+ */
+
+#ifndef FRAME_CACHE_HPP
+#define FRAME_CACHE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class InternTable;
+
+/// The number of slots of a FrameCache.
+#define FRAME_CACHE_SLOTS 256
+
+/// The location of a stop, with the file and function interned.
+struct StopFrame
+{
+	/** The source file, or INTERN_NONE if unknown. */
+	int file;
+	/** The function, or INTERN_NONE if unknown. */
+	int func;
+	/** The line. (one-based) */
+	int line;
+};
+
+/// Remembers the locations of the recent stops of a worker.
+/**
+ * This class maps the frame of a stop record, as copied by MiEventParser, to
+ * the StopFrame built from it. After a command sent to all processes, most of
+ * them stop at the same few locations, so the location is extracted from the
+ * frame and its file and function are interned once per frame instead of for
+ * every process. The key is a hash of the text of the frame, a hit skips the
+ * extraction entirely. The arguments are not part of the frame, the other
+ * fields of the record, e.g. the thread, neither. The cache is direct-mapped
+ * with a fixed number of slots, a frame replaces the previous one of its slot.
+ * It is not thread-safe, every worker of the ParsePool has its own.
+ */
+class FrameCache
+{
+	/// A cached frame and its location.
+	struct Slot
+	{
+		std::size_t hash;
+		std::string text;
+		StopFrame frame;
+	};
+
+	Slot *const m_slots;
+	std::string m_scratch;
+
+public:
+	/// Default constructor.
+	FrameCache();
+	/// Destructor.
+	~FrameCache();
+	FrameCache(const FrameCache &) = delete;
+	FrameCache &operator=(const FrameCache &) = delete;
+
+	/// Returns the location of the frame of a stop.
+	const StopFrame &lookup(const std::string_view text, InternTable &strings,
+							bool &hit);
+};
+
+#endif /* FRAME_CACHE_HPP */
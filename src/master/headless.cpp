@@ -0,0 +1,817 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file headless.cpp
+ *
+ * @brief Contains the implementation of the Headless class.
+ *
+ * This file contains the implementation of the Headless class.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <istream>
+#include <sstream>
+#include <vector>
+
+#include "headless.hpp"
+#include "buffer_pool.hpp"
+#include "ingest_budget.hpp"
+#include "intern_table.hpp"
+#include "metrics.hpp"
+#include "send_queue.hpp"
+#include "parse_pool.hpp"
+
+using asio::ip::tcp;
+using std::size_t;
+using std::string;
+
+/// The maximum number of threads parsing GDB output.
+#define HEADLESS_MAX_WORKERS 8
+
+/**
+ * This function quotes a string as a JSON string.
+ *
+ * @param[in] text The string to quote.
+ *
+ * @return The quoted and escaped string.
+ */
+static string json_string(const string &text)
+{
+	string json = "\"";
+	for (const char c : text)
+	{
+		switch (c)
+		{
+		case '"':
+			json += "\\\"";
+			break;
+		case '\\':
+			json += "\\\\";
+			break;
+		case '\n':
+			json += "\\n";
+			break;
+		case '\r':
+			json += "\\r";
+			break;
+		case '\t':
+			json += "\\t";
+			break;
+		default:
+			if ((unsigned char)c < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				json += escaped;
+			}
+			else
+			{
+				json += c;
+			}
+		}
+	}
+	return json + "\"";
+}
+
+/**
+ * This function quotes a string as a GDB/MI C string. Unlike JSON, these only
+ * know the backslash escapes and octal escapes for other control characters.
+ *
+ * @param[in] text The string to quote.
+ *
+ * @return The quoted and escaped string.
+ */
+static string mi_c_string(const string &text)
+{
+	string quoted = "\"";
+	for (const char c : text)
+	{
+		switch (c)
+		{
+		case '"':
+			quoted += "\\\"";
+			break;
+		case '\\':
+			quoted += "\\\\";
+			break;
+		case '\n':
+			quoted += "\\n";
+			break;
+		case '\t':
+			quoted += "\\t";
+			break;
+		default:
+			if ((unsigned char)c < 0x20 || 0x7f == c)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\%03o", (unsigned char)c);
+				quoted += escaped;
+			}
+			else
+			{
+				quoted += c;
+			}
+		}
+	}
+	return quoted + "\"";
+}
+
+/**
+ * This function returns the name of a target state, as printed in JSON.
+ *
+ * @param state The target state.
+ *
+ * @return The name of the state.
+ */
+static const char *state_name(const TargetState state)
+{
+	switch (state)
+	{
+	case TargetState::STOPPED:
+		return "stopped";
+	case TargetState::RUNNING:
+		return "running";
+	case TargetState::EXITED:
+		return "exited";
+	default:
+		return "unknown";
+	}
+}
+
+/**
+ * This is the default constructor for the Headless class. It creates the
+ * receive pipeline and starts the thread handling the parsed GDB output.
+ *
+ * @param num_processes The number of processes.
+ *
+ * @param base_port The base port.
+ *
+ * @param rank_budget The ingest budget of a single process in bytes.
+ *
+ * @param total_budget The ingest budget of all processes in bytes.
+ *
+ * @param reply_timeout The number of seconds to wait for the replies to a
+ * command.
+ */
+Headless::Headless(const int num_processes, const int base_port,
+				   const size_t rank_budget, const size_t total_budget,
+				   const int reply_timeout)
+	: m_num_processes(num_processes),
+	  m_base_port(base_port),
+	  m_reply_timeout(reply_timeout),
+	  m_deltas_ready(false),
+	  m_stop(false),
+	  m_num_connected(0),
+	  m_num_pending(0),
+	  m_last_sample(Metrics::now())
+{
+	m_connected = new bool[m_num_processes]();
+	m_states = new TargetState[m_num_processes]();
+	m_selected = new bool[m_num_processes];
+	std::fill(m_selected, m_selected + m_num_processes, true);
+	m_replies = new Reply[m_num_processes]();
+	m_stale_replies = new int[m_num_processes]();
+
+	// target output is printed directly and never dropped
+	m_ingest_budget = new IngestBudget(m_num_processes, rank_budget,
+									   total_budget, false);
+	// GDB output queues in the parse pool up to the budget
+	m_buffer_pool = new BufferPool(
+		2 * m_num_processes, MAX_LENGTH + 8,
+		m_ingest_budget->max_buffers(MAX_LENGTH + 8),
+		m_ingest_budget->total_buffers(MAX_LENGTH + 8));
+	m_metrics = new Metrics(m_num_processes);
+	m_strings = new InternTable();
+	m_send_queue = new SendQueue(2 * m_num_processes,
+								 [this]
+								 { report_send_failures(); });
+	const int num_workers = std::max(
+		1, std::min({m_num_processes, HEADLESS_MAX_WORKERS,
+					 (int)std::thread::hardware_concurrency() - 1}));
+	m_parse_pool = new ParsePool(m_num_processes, num_workers, m_buffer_pool,
+								 m_ingest_budget, m_metrics, m_strings,
+								 [this]
+								 {
+									 std::lock_guard<std::mutex> lock(m_mutex);
+									 m_deltas_ready = true;
+									 m_cond.notify_all();
+								 });
+	m_event_thread = std::thread(&Headless::process_events, this);
+}
+
+/**
+ * This function stops the event thread and destroys the receive pipeline.
+ */
+Headless::~Headless()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cond.notify_all();
+	m_event_thread.join();
+	delete m_send_queue;
+	delete m_parse_pool;
+	delete m_buffer_pool;
+	delete m_ingest_budget;
+	delete m_metrics;
+	delete m_strings;
+	delete[] m_connected;
+	delete[] m_states;
+	delete[] m_selected;
+	delete[] m_replies;
+	delete[] m_stale_replies;
+}
+
+/**
+ * This function prints a line of JSON to stdout. Lines printed by different
+ * threads are never interleaved.
+ *
+ * @param[in] json The JSON object.
+ */
+void Headless::print(const string &json)
+{
+	std::lock_guard<std::mutex> lock(m_mutex_stdout);
+	fputs(json.c_str(), stdout);
+	fputc('\n', stdout);
+	fflush(stdout);
+}
+
+/**
+ * This function handles received data. GDB output is handed to the parse pool,
+ * the output of the target program is printed directly. It is called from the
+ * thread reading from the TCP socket.
+ *
+ * @param[in] data The received, '\0'-terminated data. The buffer is taken from
+ * the buffer pool.
+ *
+ * @param length The length of the received data in bytes.
+ *
+ * @param port The TCP port the data was received on.
+ *
+ * @return @c true if the parse pool took ownership of the buffer, @c false if
+ * the data is already handled and the buffer stays with the caller.
+ */
+bool Headless::push_data(char *const data, const size_t length,
+						 const int port)
+{
+	const int rank = get_rank(port);
+	const std::uint64_t received = Metrics::now();
+	m_metrics->count_read(rank, length);
+	if (src_is_gdb(port))
+	{
+		m_ingest_budget->charge(rank, m_buffer_pool->buffer_size());
+		m_parse_pool->push(rank, data, length, received);
+		return true;
+	}
+	print("{\"event\":\"output\",\"rank\":" + std::to_string(rank) +
+		  ",\"text\":" + json_string(string(data, length)) + "}");
+	m_metrics->read_to_ui.record(Metrics::now() - received);
+	return false;
+}
+
+/**
+ * This function takes a receive buffer for a TCP port from the buffer pool.
+ * As long as the process exceeds its ingest budget, this function blocks.
+ *
+ * @param port The TCP port.
+ *
+ * @return A buffer of @ref MAX_LENGTH + 8 bytes.
+ */
+char *Headless::acquire_buffer(const int port)
+{
+	if (src_is_gdb(port))
+	{
+		m_ingest_budget->wait_for_room(get_rank(port));
+	}
+	return m_buffer_pool->acquire(port - m_base_port);
+}
+
+/**
+ * This function deallocates a receive buffer, which a reading thread no longer
+ * needs. The buffers handed to the parse pool are returned to the buffer pool
+ * by the parse workers alone, see BufferPool::release.
+ *
+ * @param[in] buffer The buffer, previously taken with @ref acquire_buffer.
+ */
+void Headless::discard_buffer(char *const buffer)
+{
+	m_buffer_pool->discard(buffer);
+}
+
+/**
+ * This function sets the TCP socket connected to GDB. A closed connection
+ * completes a pending command of the process.
+ *
+ * @param rank The process rank.
+ *
+ * @param[in] socket The TCP socket, or @c nullptr when the connection is
+ * closed.
+ */
+void Headless::set_conns_gdb(const int rank, tcp::socket *const socket)
+{
+	m_send_queue->attach(rank, socket);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_connected[rank] = nullptr != socket;
+	if (nullptr != socket)
+	{
+		++m_num_connected;
+	}
+	else if (m_replies[rank].pending)
+	{
+		m_replies[rank].pending = false;
+		m_replies[rank].failed = true;
+		m_replies[rank].result = "disconnected";
+		--m_num_pending;
+	}
+	m_cond.notify_all();
+}
+
+/**
+ * This function sets the TCP socket connected to the target program.
+ *
+ * @param rank The process rank.
+ *
+ * @param[in] socket The TCP socket, or @c nullptr when the connection is
+ * closed.
+ */
+void Headless::set_conns_trgt(const int rank, tcp::socket *const socket)
+{
+	m_send_queue->attach(m_num_processes + rank, socket);
+	if (nullptr != socket)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_num_connected;
+		m_cond.notify_all();
+	}
+}
+
+/**
+ * This function prints the write failures reported by the SendQueue. It is
+ * called from the writer thread of the SendQueue.
+ */
+void Headless::report_send_failures()
+{
+	int idx;
+	string message;
+	while (m_send_queue->pop_failure(idx, message))
+	{
+		const bool is_gdb = idx < m_num_processes;
+		const int rank = is_gdb ? idx : idx - m_num_processes;
+		print(string("{\"event\":\"send-failed\",\"rank\":") +
+			  std::to_string(rank) + ",\"target\":" +
+			  (is_gdb ? "\"gdb\"" : "\"program\"") + ",\"message\":" +
+			  json_string(message) + "}");
+	}
+}
+
+/**
+ * This function waits for parsed GDB output and applies it. It runs on its
+ * own thread until the object is destroyed.
+ */
+void Headless::process_events()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_cond.wait(lock, [this]
+					{ return m_stop || m_deltas_ready; });
+		if (m_stop)
+		{
+			return;
+		}
+		m_deltas_ready = false;
+		lock.unlock();
+		const std::vector<GdbDelta> &deltas = m_parse_pool->take_deltas();
+		lock.lock();
+		for (const GdbDelta &delta : deltas)
+		{
+			apply_delta(delta);
+		}
+		m_cond.notify_all();
+	}
+}
+
+/**
+ * This function applies a delta to the state of its process. Stream output
+ * and the result of a command are collected for a pending command, everything
+ * else is printed as an event. The caller must hold @c m_mutex.
+ *
+ * @param[in] delta The delta to apply.
+ */
+void Headless::apply_delta(const GdbDelta &delta)
+{
+	const int rank = delta.rank;
+	Reply &reply = m_replies[rank];
+	if (delta.completed && m_stale_replies[rank] > 0)
+	{
+		// the late answer of a command which timed out
+		--m_stale_replies[rank];
+	}
+	else if (reply.pending)
+	{
+		reply.output += delta.text;
+		if (delta.completed)
+		{
+			reply.pending = false;
+			reply.failed = delta.failed;
+			reply.result = delta.result;
+			reply.bkpt_number = delta.bkpt_number;
+			--m_num_pending;
+		}
+	}
+	else if (!delta.text.empty())
+	{
+		print("{\"event\":\"console\",\"rank\":" + std::to_string(rank) +
+			  ",\"text\":" + json_string(delta.text) + "}");
+	}
+
+	if (delta.exited)
+	{
+		m_states[rank] = TargetState::EXITED;
+		print("{\"event\":\"exited\",\"rank\":" + std::to_string(rank) +
+			  ",\"code\":" + std::to_string(delta.exit_code) + "}");
+	}
+	else if (TargetState::STOPPED == delta.state)
+	{
+		m_states[rank] = TargetState::STOPPED;
+		string json = "{\"event\":\"stopped\",\"rank\":" + std::to_string(rank);
+		if (INTERN_NONE != delta.file)
+		{
+			json += ",\"file\":" + json_string(m_strings->str(delta.file)) +
+					",\"line\":" + std::to_string(delta.line);
+		}
+		if (INTERN_NONE != delta.func)
+		{
+			json += ",\"func\":" + json_string(m_strings->str(delta.func));
+		}
+		if (0 != delta.bkptno)
+		{
+			json += ",\"breakpoint\":" + std::to_string(delta.bkptno);
+		}
+		print(json + "}");
+	}
+	else if (TargetState::RUNNING == delta.state)
+	{
+		m_states[rank] = TargetState::RUNNING;
+	}
+	m_metrics->read_to_ui.record(Metrics::now() - delta.received);
+}
+
+/**
+ * This function waits until all slaves are connected to the master.
+ *
+ * @param timeout The number of seconds to wait.
+ *
+ * @return @c true when all connections are established, @c false on timeout.
+ */
+bool Headless::wait_slaves(const int timeout)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_cond.wait_for(lock, std::chrono::seconds(timeout),
+						   [this]
+						   { return m_num_connected >= 2 * m_num_processes; });
+}
+
+/**
+ * This function sends a GDB command to all selected and connected processes
+ * and waits for their replies. The replies are printed as a single result.
+ * Processes which do not reply within the timeout are reported as such, their
+ * late replies are ignored.
+ *
+ * @param[in] command The command as entered.
+ *
+ * @param[in] mi_cmd The command sent to GDB.
+ */
+void Headless::run_gdb_command(const string &command, const string &mi_cmd)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::vector<int> ranks;
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		if (!m_selected[rank] || !m_connected[rank])
+		{
+			continue;
+		}
+		m_replies[rank] = Reply{true, false, "", "", 0};
+		if (!m_send_queue->enqueue(rank, mi_cmd + "\n"))
+		{
+			m_replies[rank] = Reply{false, true, "", "disconnected", 0};
+		}
+		else
+		{
+			++m_num_pending;
+		}
+		ranks.push_back(rank);
+	}
+	m_cond.wait_for(lock, std::chrono::seconds(m_reply_timeout),
+					[this]
+					{ return 0 == m_num_pending; });
+
+	string json = "{\"result\":" + json_string(command) + ",\"ranks\":[";
+	for (const int rank : ranks)
+	{
+		Reply &reply = m_replies[rank];
+		const char *status = reply.failed ? "error" : "done";
+		if (reply.pending)
+		{
+			status = "timeout";
+			reply.pending = false;
+			++m_stale_replies[rank];
+			--m_num_pending;
+		}
+		json += "{\"rank\":" + std::to_string(rank) + ",\"status\":\"" +
+				status + "\"";
+		if (!reply.result.empty())
+		{
+			json += ",\"value\":" + json_string(reply.result);
+		}
+		if (0 != reply.bkpt_number)
+		{
+			json += ",\"breakpoint\":" + std::to_string(reply.bkpt_number);
+		}
+		json += ",\"output\":" + json_string(reply.output) + "},";
+	}
+	if (',' == json.back())
+	{
+		json.pop_back();
+	}
+	lock.unlock();
+	print(json + "]}");
+}
+
+/**
+ * This function selects the processes following commands are sent to. The
+ * ranks are given as a comma separated list of ranks and ranges, e.g.
+ * "0-3,7", or as "all".
+ *
+ * @param[in] command The command as entered.
+ *
+ * @param[in] ranks The rank set.
+ */
+void Headless::select_ranks(const string &command, const string &ranks)
+{
+	bool *selected = new bool[m_num_processes]();
+	bool valid = !ranks.empty();
+	if ("all" == ranks)
+	{
+		std::fill(selected, selected + m_num_processes, true);
+	}
+	else
+	{
+		std::istringstream iss(ranks);
+		string range;
+		while (valid && std::getline(iss, range, ','))
+		{
+			try
+			{
+				size_t pos;
+				const int first = std::stoi(range, &pos, 10);
+				int last = first;
+				if (pos < range.size() && '-' == range[pos])
+				{
+					const string rest = range.substr(pos + 1);
+					last = std::stoi(rest, &pos, 10);
+					pos = pos == rest.size() ? range.size() : 0;
+				}
+				if (pos != range.size() || first < 0 || last < first ||
+					last >= m_num_processes)
+				{
+					throw std::exception();
+				}
+				std::fill(selected + first, selected + last + 1, true);
+			}
+			catch (const std::exception &)
+			{
+				valid = false;
+			}
+		}
+	}
+	if (!valid)
+	{
+		delete[] selected;
+		print("{\"result\":" + json_string(command) +
+			  ",\"error\":\"Invalid rank set.\"}");
+		return;
+	}
+
+	string json = "{\"result\":" + json_string(command) + ",\"selected\":[";
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::swap(m_selected, selected);
+		for (int rank = 0; rank < m_num_processes; ++rank)
+		{
+			if (m_selected[rank])
+			{
+				json += std::to_string(rank) + ",";
+			}
+		}
+	}
+	delete[] selected;
+	if (',' == json.back())
+	{
+		json.pop_back();
+	}
+	print(json + "]}");
+}
+
+/**
+ * This function waits until all selected processes are stopped or exited.
+ *
+ * @param[in] command The command as entered.
+ *
+ * @param timeout The number of seconds to wait.
+ */
+void Headless::wait_stopped(const string &command, const int timeout)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const bool stopped = m_cond.wait_for(
+		lock, std::chrono::seconds(timeout),
+		[this]
+		{
+			for (int rank = 0; rank < m_num_processes; ++rank)
+			{
+				if (m_selected[rank] && m_connected[rank] &&
+					TargetState::STOPPED != m_states[rank] &&
+					TargetState::EXITED != m_states[rank])
+				{
+					return false;
+				}
+			}
+			return true;
+		});
+	lock.unlock();
+	print("{\"result\":" + json_string(command) + ",\"status\":\"" +
+		  (stopped ? "done" : "timeout") + "\"}");
+}
+
+/**
+ * This function interrupts the target programs of the selected processes by
+ * sending Ctrl+C to their terminals.
+ *
+ * @param[in] command The command as entered.
+ */
+void Headless::interrupt(const string &command)
+{
+	string json = "{\"result\":" + json_string(command) + ",\"interrupted\":[";
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (int rank = 0; rank < m_num_processes; ++rank)
+		{
+			if (m_selected[rank] && TargetState::RUNNING == m_states[rank] &&
+				m_send_queue->enqueue(m_num_processes + rank, "\3"))
+			{
+				json += std::to_string(rank) + ",";
+			}
+		}
+	}
+	if (',' == json.back())
+	{
+		json.pop_back();
+	}
+	print(json + "]}");
+}
+
+/**
+ * This function prints the connection and target state of all processes.
+ *
+ * @param[in] command The command as entered.
+ */
+void Headless::print_status(const string &command)
+{
+	string json = "{\"result\":" + json_string(command) + ",\"ranks\":[";
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (int rank = 0; rank < m_num_processes; ++rank)
+		{
+			json += "{\"rank\":" + std::to_string(rank) + ",\"connected\":" +
+					(m_connected[rank] ? "true" : "false") +
+					",\"selected\":" + (m_selected[rank] ? "true" : "false") +
+					",\"state\":\"" + state_name(m_states[rank]) + "\"},";
+		}
+	}
+	json.pop_back();
+	print(json + "]}");
+}
+
+/**
+ * This function prints the transport and parser metrics of all processes
+ * since the last call.
+ *
+ * @param[in] command The command as entered.
+ */
+void Headless::print_metrics(const string &command)
+{
+	const std::uint64_t now = Metrics::now();
+	m_metrics->sample((now - m_last_sample) / 1e9);
+	m_last_sample = now;
+	print("{\"result\":" + json_string(command) + ",\"report\":" +
+		  json_string(m_metrics->report(m_num_processes)) + "}");
+}
+
+/**
+ * This function reads commands line by line and executes them, until the
+ * input ends or "quit" is read. Empty lines and lines starting with '#' are
+ * ignored. See the README for the available commands.
+ *
+ * @param[in] input The stream to read the commands from.
+ */
+void Headless::run(std::istream &input)
+{
+	print("{\"event\":\"ready\",\"processes\":" +
+		  std::to_string(m_num_processes) + "}");
+	string line;
+	while (std::getline(input, line))
+	{
+		const size_t start = line.find_first_not_of(" \t");
+		if (string::npos == start || '#' == line[start])
+		{
+			continue;
+		}
+		line = line.substr(start, line.find_last_not_of(" \t\r") - start + 1);
+		const size_t space = line.find(' ');
+		const string name = line.substr(0, space);
+		const string arg = string::npos == space
+							   ? ""
+							   : line.substr(line.find_first_not_of(' ', space));
+
+		if ("quit" == name)
+		{
+			break;
+		}
+		else if ("ranks" == name)
+		{
+			select_ranks(line, arg);
+		}
+		else if ("break" == name && !arg.empty())
+		{
+			run_gdb_command(line, "-break-insert " + arg);
+		}
+		else if ("continue" == name)
+		{
+			run_gdb_command(line, "-exec-continue");
+		}
+		else if ("backtrace" == name)
+		{
+			run_gdb_command(line, "backtrace");
+		}
+		else if ("evaluate" == name && !arg.empty())
+		{
+			run_gdb_command(line, "-data-evaluate-expression " +
+									  mi_c_string(arg));
+		}
+		else if ("gdb" == name && !arg.empty())
+		{
+			run_gdb_command(line, arg);
+		}
+		else if ("interrupt" == name)
+		{
+			interrupt(line);
+		}
+		else if ("wait" == name)
+		{
+			int timeout = m_reply_timeout;
+			try
+			{
+				timeout = arg.empty() ? timeout : std::stoi(arg);
+			}
+			catch (const std::exception &)
+			{
+			}
+			wait_stopped(line, timeout);
+		}
+		else if ("status" == name)
+		{
+			print_status(line);
+		}
+		else if ("metrics" == name)
+		{
+			print_metrics(line);
+		}
+		else
+		{
+			print("{\"result\":" + json_string(line) +
+				  ",\"error\":\"Unknown command.\"}");
+		}
+	}
+}
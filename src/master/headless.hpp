@@ -0,0 +1,182 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file headless.hpp
+ *
+ * @brief Header file for the Headless class.
+ *
+ * This is the header file for the Headless class.
+ */
+
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "asio.hpp"
+#include "target_state.hpp"
+
+class BufferPool;
+class IngestBudget;
+class InternTable;
+class Metrics;
+class SendQueue;
+class ParsePool;
+struct GdbDelta;
+
+/// Runs the master without a GUI.
+/**
+ * This class replaces the UIWindow when the master runs headless. It uses the
+ * same receive pipeline: pooled receive buffers, the ingest budget, the parse
+ * pool and the send queue. Instead of a GUI it reads commands line by line
+ * from an input stream and prints results and events as one JSON object per
+ * line to stdout.
+ *
+ * Commands are sent to the selected processes. A command completes when every
+ * selected process has answered with a result record, or after a timeout.
+ */
+class Headless
+{
+	/// The answer of a single process to the current command.
+	struct Reply
+	{
+		bool pending;
+		bool failed;
+		std::string output;
+		std::string result;
+		int bkpt_number;
+	};
+
+	const int m_num_processes;
+	const int m_base_port;
+	const int m_reply_timeout;
+
+	BufferPool *m_buffer_pool;
+	IngestBudget *m_ingest_budget;
+	Metrics *m_metrics;
+	InternTable *m_strings;
+	SendQueue *m_send_queue;
+	ParsePool *m_parse_pool;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	bool m_deltas_ready;
+	bool m_stop;
+	int m_num_connected;
+	bool *m_connected;
+	TargetState *m_states;
+	bool *m_selected;
+	Reply *m_replies;
+	int *m_stale_replies;
+	int m_num_pending;
+	std::uint64_t m_last_sample;
+	std::thread m_event_thread;
+
+	std::mutex m_mutex_stdout;
+
+	/// Takes the parsed deltas and applies them. (event thread)
+	void process_events();
+	/// Applies a delta to the process state and the pending command.
+	void apply_delta(const GdbDelta &delta);
+	/// Prints the send failures reported by the SendQueue.
+	void report_send_failures();
+	/// Prints a line of JSON to stdout.
+	void print(const std::string &json);
+
+	/// Sends a GDB command to the selected processes and prints the replies.
+	void run_gdb_command(const std::string &command, const std::string &mi_cmd);
+	/// Selects the processes following commands are sent to.
+	void select_ranks(const std::string &command, const std::string &ranks);
+	/// Waits until all selected processes are stopped or exited.
+	void wait_stopped(const std::string &command, const int timeout);
+	/// Interrupts the selected processes.
+	void interrupt(const std::string &command);
+	/// Prints the state of all processes.
+	void print_status(const std::string &command);
+	/// Prints the transport and parser metrics.
+	void print_metrics(const std::string &command);
+
+public:
+	/// Default constructor.
+	Headless(const int num_processes, const int base_port,
+			 const std::size_t rank_budget, const std::size_t total_budget,
+			 const int reply_timeout);
+	/// Destructor.
+	~Headless();
+
+	/// Waits until all slaves are connected.
+	bool wait_slaves(const int timeout);
+	/// Executes commands until the input ends or quit is read.
+	void run(std::istream &input);
+
+	/// Handles received data. (network thread)
+	bool push_data(char *const data, const std::size_t length,
+				   const int port);
+	/// Takes a receive buffer for a TCP port. (network thread)
+	char *acquire_buffer(const int port);
+	/// Deallocates a receive buffer no longer needed. (network thread)
+	void discard_buffer(char *const buffer);
+	/// Sets the TCP socket connected to GDB.
+	void set_conns_gdb(const int rank, asio::ip::tcp::socket *const socket);
+	/// Sets the TCP socket connected to the target program.
+	void set_conns_trgt(const int rank, asio::ip::tcp::socket *const socket);
+
+	/// Checks if the TCP port is used for GDB.
+	/**
+	 * This function checks if the TCP port is used for GDB.
+	 *
+	 * @param port The TCP port.
+	 *
+	 * @return @c true if the port is used for GDB, @c false if it is used for
+	 * the target program.
+	 */
+	inline bool src_is_gdb(const int port) const
+	{
+		return port < m_base_port + m_num_processes;
+	}
+
+	/// Retrieves the process rank from the TCP port.
+	/**
+	 * This function retrieves the process rank from the TCP port.
+	 *
+	 * @param port The TCP port.
+	 *
+	 * @return The process rank.
+	 */
+	inline int get_rank(const int port) const
+	{
+		if (port < m_base_port + m_num_processes)
+		{
+			return port - m_base_port;
+		}
+		else
+		{
+			return port - m_base_port - m_num_processes;
+		}
+	}
+};
+
+#endif /* HEADLESS_HPP */
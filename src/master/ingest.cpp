@@ -0,0 +1,239 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ingest.cpp
+ *
+ * @brief Contains the implementation of the IngestQueue class.
+ *
+ * This file contains the implementation of the IngestQueue class.
+ */
+
+#include "ingest.hpp"
+
+using std::size_t;
+
+/**
+ * This is the default constructor for the IngestQueue class. It allocates a
+ * ring buffer for every port.
+ *
+ * @param num_ports The number of TCP ports (two per process).
+ *
+ * @param capacity The number of chunks a ring buffer can hold. This is rounded
+ * up to the next power of two.
+ */
+IngestQueue::IngestQueue(const int num_ports, const size_t capacity)
+	: m_num_ports(num_ports),
+	  m_mask([capacity]
+			 {
+				 size_t size = 1;
+				 while (size < capacity)
+				 {
+					 size <<= 1;
+				 }
+				 return size - 1;
+			 }()),
+	  m_rings(new Ring[num_ports]),
+	  m_cursor(0),
+	  m_wakeup_pending(false),
+	  m_closed(false)
+{
+	for (int idx = 0; idx < m_num_ports; ++idx)
+	{
+		m_rings[idx].slots = new IngestChunk[m_mask + 1];
+		m_rings[idx].head = 0;
+		m_rings[idx].tail = 0;
+		m_rings[idx].listed = false;
+		m_rings[idx].waiting = false;
+	}
+	m_ready.reserve(m_num_ports);
+	m_active.reserve(m_num_ports);
+}
+
+/**
+ * This function deallocates the ring buffers. The data of chunks still pending
+ * is owned by the BufferPool and is not freed here.
+ */
+IngestQueue::~IngestQueue()
+{
+	for (int idx = 0; idx < m_num_ports; ++idx)
+	{
+		delete[] m_rings[idx].slots;
+	}
+	delete[] m_rings;
+}
+
+/**
+ * This function announces a port with pending data to the GUI thread.
+ *
+ * @param idx The port index.
+ */
+void IngestQueue::announce(const int idx)
+{
+	std::lock_guard<std::mutex> lock(m_ready_mutex);
+	m_ready.push_back(idx);
+}
+
+/**
+ * This function appends a chunk to the ring buffer of a port. It is called
+ * from the thread reading from the socket of this port. When the ring buffer
+ * is full, the calling thread blocks until the GUI thread removed a chunk, see
+ * @ref pop. As no more data is read from the socket meanwhile, this pushes
+ * back on the sender. After @ref close no chunk is taken anymore.
+ *
+ * @param idx The port index (port - base port).
+ *
+ * @param[in] chunk The chunk. The queue takes ownership of the data buffer,
+ * if it takes the chunk.
+ *
+ * @param[out] wakeup Whether the GUI thread needs to be woken up, @c false if
+ * a wakeup is already pending.
+ *
+ * @return @c true if the chunk was queued, @c false if the queue is closed and
+ * the data buffer stays with the caller.
+ */
+bool IngestQueue::push(const int idx, const IngestChunk &chunk, bool &wakeup)
+{
+	Ring &ring = m_rings[idx];
+	const size_t head = ring.head.load(std::memory_order_relaxed);
+	if (m_closed)
+	{
+		return false;
+	}
+	if (head - ring.tail.load(std::memory_order_acquire) > m_mask)
+	{
+		std::unique_lock<std::mutex> lock(ring.mutex);
+		// pop checks the flag after advancing the tail, so either it sees the
+		// flag or the check below sees the new tail
+		ring.waiting.store(true, std::memory_order_seq_cst);
+		ring.cond.wait(lock, [this, &ring, head]
+					   { return m_closed ||
+								head - ring.tail.load() <= m_mask; });
+		ring.waiting.store(false, std::memory_order_relaxed);
+		if (m_closed)
+		{
+			return false;
+		}
+	}
+	ring.slots[head & m_mask] = chunk;
+	ring.head.store(head + 1, std::memory_order_seq_cst);
+	if (!ring.listed.exchange(true, std::memory_order_seq_cst))
+	{
+		announce(idx);
+	}
+	wakeup = !m_wakeup_pending.exchange(true, std::memory_order_seq_cst);
+	return true;
+}
+
+/**
+ * This function moves the announced ports into the active list, which is only
+ * accessed by the GUI thread.
+ */
+void IngestQueue::collect_ready()
+{
+	std::lock_guard<std::mutex> lock(m_ready_mutex);
+	m_active.insert(m_active.end(), m_ready.begin(), m_ready.end());
+	m_ready.clear();
+}
+
+/**
+ * This function removes the next chunk. The ports with pending data are
+ * visited in round-robin order, one chunk at a time, so a single chatty
+ * process cannot starve the others. A reading thread waiting for room in the
+ * ring buffer is woken up.
+ *
+ * @param[out] chunk The removed chunk. The caller takes ownership of the data.
+ *
+ * @return @c true if a chunk was removed, @c false if all queues are empty.
+ */
+bool IngestQueue::pop(IngestChunk &chunk)
+{
+	for (;;)
+	{
+		if (m_cursor >= m_active.size())
+		{
+			collect_ready();
+			m_cursor = 0;
+			if (m_active.empty())
+			{
+				return false;
+			}
+		}
+		const int idx = m_active[m_cursor];
+		Ring &ring = m_rings[idx];
+		const size_t tail = ring.tail.load(std::memory_order_relaxed);
+		if (tail != ring.head.load(std::memory_order_acquire))
+		{
+			chunk = ring.slots[tail & m_mask];
+			ring.tail.store(tail + 1, std::memory_order_seq_cst);
+			if (ring.waiting.load(std::memory_order_seq_cst))
+			{
+				// the producer checks under the mutex, take it to not miss it
+				std::lock_guard<std::mutex> lock(ring.mutex);
+				ring.cond.notify_one();
+			}
+			++m_cursor;
+			return true;
+		}
+		// ring is empty: unlist it, unless the producer raced us
+		ring.listed.store(false, std::memory_order_seq_cst);
+		if (tail != ring.head.load(std::memory_order_seq_cst) &&
+			!ring.listed.exchange(true, std::memory_order_acq_rel))
+		{
+			continue;
+		}
+		m_active[m_cursor] = m_active.back();
+		m_active.pop_back();
+	}
+}
+
+/**
+ * This function clears the wakeup flag after the GUI thread drained the
+ * queue. If data is still pending (e.g. the drain ran out of time), the flag
+ * is set again and the caller has to schedule another drain itself.
+ *
+ * @return @c true if the caller needs to schedule another drain, @c false
+ * otherwise.
+ */
+bool IngestQueue::rearm()
+{
+	m_wakeup_pending.store(false, std::memory_order_seq_cst);
+	bool pending = !m_active.empty();
+	if (!pending)
+	{
+		std::lock_guard<std::mutex> lock(m_ready_mutex);
+		pending = !m_ready.empty();
+	}
+	return pending && !m_wakeup_pending.exchange(true, std::memory_order_acq_rel);
+}
+
+/**
+ * This function closes the queue, e.g. when the GUI thread stopped draining
+ * it. The reading threads waiting for room in a ring buffer are woken up, and
+ * @ref push refuses all further chunks.
+ */
+void IngestQueue::close()
+{
+	m_closed = true;
+	for (int idx = 0; idx < m_num_ports; ++idx)
+	{
+		std::lock_guard<std::mutex> lock(m_rings[idx].mutex);
+		m_rings[idx].cond.notify_all();
+	}
+}
@@ -0,0 +1,120 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ingest.hpp
+ *
+ * @brief Header file for the IngestQueue class.
+ *
+ * This is the header file for the IngestQueue class.
+ */
+
+#ifndef INGEST_HPP
+#define INGEST_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/// A chunk of data received from a socat instance.
+struct IngestChunk
+{
+	/** The received, '\0'-terminated data. */
+	char *data;
+	/** The length of the data in bytes, without the termination. */
+	std::size_t length;
+	/** The originating TCP port. */
+	int port;
+	/** The time the data was received. See Metrics::now. */
+	std::uint64_t received;
+};
+
+/// Collects received data from the network threads for the GUI thread.
+/**
+ * This class holds one lock-free single-producer/single-consumer ring buffer
+ * per TCP port. The producer is the thread reading from the socket, the
+ * consumer is the GUI thread. Ports with pending data are announced once in a
+ * ready list, so the consumer never scans idle ports. A single wakeup flag
+ * makes sure the GUI thread is only woken once, no matter how many chunks are
+ * pending. A reading thread finding its ring buffer full blocks until the GUI
+ * thread removed a chunk from it, or until the queue is closed.
+ */
+class IngestQueue
+{
+	/// A single-producer/single-consumer ring buffer.
+	struct Ring
+	{
+		IngestChunk *slots;
+		alignas(64) std::atomic<std::size_t> head;
+		alignas(64) std::atomic<std::size_t> tail;
+		std::atomic<bool> listed;
+		std::atomic<bool> waiting;
+		std::mutex mutex;
+		std::condition_variable cond;
+	};
+
+	const int m_num_ports;
+	const std::size_t m_mask;
+	Ring *const m_rings;
+
+	std::mutex m_ready_mutex;
+	std::vector<int> m_ready;
+
+	std::vector<int> m_active;
+	std::size_t m_cursor;
+
+	alignas(64) std::atomic<bool> m_wakeup_pending;
+	std::atomic<bool> m_closed;
+
+	/// Moves the announced ports into the active list. (GUI thread)
+	void collect_ready();
+	/// Announces a port with pending data.
+	void announce(const int idx);
+
+public:
+	/// Default constructor.
+	IngestQueue(const int num_ports, const std::size_t capacity);
+	/// Destructor.
+	~IngestQueue();
+
+	/// Appends a chunk to the ring buffer of a port. (network thread)
+	bool push(const int idx, const IngestChunk &chunk, bool &wakeup);
+	/// Removes the next chunk in round-robin order over all ports. (GUI thread)
+	bool pop(IngestChunk &chunk);
+	/// Clears the wakeup flag after a drain. (GUI thread)
+	bool rearm();
+	/// Refuses all further chunks and wakes up the waiting threads.
+	void close();
+
+	/// Returns the number of ports.
+	/**
+	 * This function returns the number of ports.
+	 *
+	 * @return The number of ports.
+	 */
+	inline int num_ports() const
+	{
+		return m_num_ports;
+	}
+};
+
+#endif /* INGEST_HPP */
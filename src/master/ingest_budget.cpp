@@ -0,0 +1,179 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ingest_budget.cpp
+ *
+ * @brief Contains the implementation of the IngestBudget class.
+ *
+ * This file contains the implementation of the IngestBudget class.
+ */
+
+#include "ingest_budget.hpp"
+
+using std::size_t;
+
+/**
+ * This is the default constructor for the IngestBudget class.
+ *
+ * @param num_processes The number of processes.
+ *
+ * @param rank_budget The number of bytes a single process may have in flight.
+ *
+ * @param total_budget The number of bytes all processes together may have in
+ * flight.
+ *
+ * @param drop_overflow Whether target output is dropped instead of paused when
+ * a budget is exceeded.
+ */
+IngestBudget::IngestBudget(const int num_processes, const size_t rank_budget,
+						   const size_t total_budget, const bool drop_overflow)
+	: m_num_processes(num_processes),
+	  m_rank_budget(rank_budget),
+	  m_total_budget(total_budget),
+	  m_drop_overflow(drop_overflow),
+	  m_ranks(new Rank[num_processes]),
+	  m_total(0),
+	  m_num_throttled(0),
+	  m_closed(false)
+{
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		m_ranks[rank].bytes = 0;
+		m_ranks[rank].dropped = 0;
+	}
+}
+
+/**
+ * This function deallocates the accounting of the processes.
+ */
+IngestBudget::~IngestBudget()
+{
+	delete[] m_ranks;
+}
+
+/**
+ * This function blocks until both the process and all processes together are
+ * below their budgets. It is called by a reading thread before it reads the
+ * next chunk, so an exceeded budget stops reading from the socket. After
+ * @ref close it returns at once.
+ *
+ * @param rank The process rank.
+ */
+void IngestBudget::wait_for_room(const int rank)
+{
+	Rank &self = m_ranks[rank];
+	if (self.bytes.load() < m_rank_budget && m_total.load() < m_total_budget)
+	{
+		return;
+	}
+	m_num_throttled.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::unique_lock<std::mutex> lock(self.mutex);
+		self.cond.wait(lock, [this, &self]
+					   { return m_closed || self.bytes.load() < m_rank_budget; });
+	}
+	{
+		std::unique_lock<std::mutex> lock(m_mutex_total);
+		m_cond_total.wait(lock, [this]
+						  { return m_closed || m_total.load() < m_total_budget; });
+	}
+	m_num_throttled.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * This function accounts a buffer handed over by a reading thread.
+ *
+ * @param rank The process rank.
+ *
+ * @param bytes The size of the buffer in bytes.
+ */
+void IngestBudget::charge(const int rank, const size_t bytes)
+{
+	m_ranks[rank].bytes.fetch_add(bytes);
+	m_total.fetch_add(bytes);
+}
+
+/**
+ * This function accounts a buffer if it fits into both budgets. Otherwise the
+ * data is counted as dropped and the caller must discard it.
+ *
+ * @param rank The process rank.
+ *
+ * @param bytes The size of the buffer in bytes.
+ *
+ * @param length The number of received bytes in the buffer.
+ *
+ * @return @c true if the buffer was accounted, @c false if it must be dropped.
+ */
+bool IngestBudget::try_charge(const int rank, const size_t bytes,
+							  const size_t length)
+{
+	Rank &self = m_ranks[rank];
+	if (self.bytes.load() >= m_rank_budget || m_total.load() >= m_total_budget)
+	{
+		self.dropped.fetch_add(length, std::memory_order_relaxed);
+		return false;
+	}
+	charge(rank, bytes);
+	return true;
+}
+
+/**
+ * This function accounts a buffer released after processing and wakes up the
+ * reading threads waiting for room.
+ *
+ * @param rank The process rank.
+ *
+ * @param bytes The size of the buffer in bytes.
+ */
+void IngestBudget::release(const int rank, const size_t bytes)
+{
+	Rank &self = m_ranks[rank];
+	const size_t rank_bytes = self.bytes.fetch_sub(bytes);
+	if (rank_bytes >= m_rank_budget && rank_bytes - bytes < m_rank_budget)
+	{
+		// the waiting thread checks under the mutex, so take it to not miss it
+		std::lock_guard<std::mutex> lock(self.mutex);
+		self.cond.notify_all();
+	}
+	const size_t total = m_total.fetch_sub(bytes);
+	if (total >= m_total_budget && total - bytes < m_total_budget)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_total);
+		m_cond_total.notify_all();
+	}
+}
+
+/**
+ * This function wakes up the reading threads waiting for room and lets
+ * @ref wait_for_room return at once from now on. It is called when the
+ * buffers are no longer released, so these threads can be joined.
+ */
+void IngestBudget::close()
+{
+	m_closed = true;
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		std::lock_guard<std::mutex> lock(m_ranks[rank].mutex);
+		m_ranks[rank].cond.notify_all();
+	}
+	std::lock_guard<std::mutex> lock(m_mutex_total);
+	m_cond_total.notify_all();
+}
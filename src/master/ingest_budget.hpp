@@ -0,0 +1,173 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ingest_budget.hpp
+ *
+ * @brief Header file for the IngestBudget class.
+ *
+ * This is the header file for the IngestBudget class.
+ */
+
+#ifndef INGEST_BUDGET_HPP
+#define INGEST_BUDGET_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/// Limits the memory held by received data which is not yet processed.
+/**
+ * This class accounts the receive buffers in flight, i.e. handed over by the
+ * reading threads but not yet released by the GUI thread or the parser. There
+ * is a budget per process (shared by its GDB and target port) and a global
+ * one.
+ *
+ * A reading thread waits for room before it reads again. So a process which
+ * sends faster than the master can process is paused by TCP backpressure.
+ * Alternatively, target output is dropped instead when it does not fit into
+ * the budget, and only the number of dropped bytes is kept. GDB output is
+ * never dropped, as the MI records must stay complete.
+ */
+class IngestBudget
+{
+	/// The accounting of a single process.
+	struct Rank
+	{
+		alignas(64) std::atomic<std::size_t> bytes;
+		std::atomic<std::uint64_t> dropped;
+		std::mutex mutex;
+		std::condition_variable cond;
+	};
+
+	const int m_num_processes;
+	const std::size_t m_rank_budget;
+	const std::size_t m_total_budget;
+	const bool m_drop_overflow;
+	Rank *const m_ranks;
+
+	alignas(64) std::atomic<std::size_t> m_total;
+	std::atomic<int> m_num_throttled;
+	std::atomic<bool> m_closed;
+	std::mutex m_mutex_total;
+	std::condition_variable m_cond_total;
+
+public:
+	/// Default constructor.
+	IngestBudget(const int num_processes, const std::size_t rank_budget,
+				 const std::size_t total_budget, const bool drop_overflow);
+	/// Destructor.
+	~IngestBudget();
+
+	/// Waits until a process is below its budget. (network thread)
+	void wait_for_room(const int rank);
+	/// Accounts a buffer handed over. (network thread)
+	void charge(const int rank, const std::size_t bytes);
+	/// Accounts a buffer if it fits, otherwise counts it as dropped.
+	bool try_charge(const int rank, const std::size_t bytes,
+					const std::size_t length);
+	/// Accounts a buffer released.
+	void release(const int rank, const std::size_t bytes);
+	/// Stops waiting for room, e.g. when nothing is released anymore.
+	void close();
+
+	/// Returns the number of buffers a single port can have in flight.
+	/**
+	 * This function returns the number of receive buffers a single port can
+	 * have in flight at most. These are the buffers fitting into the budget,
+	 * the one charged beyond it and the one being read into.
+	 *
+	 * @param buffer_size The size of a buffer in bytes.
+	 *
+	 * @return The number of buffers.
+	 */
+	inline std::size_t max_buffers(const std::size_t buffer_size) const
+	{
+		return std::min(m_rank_budget, m_total_budget) / buffer_size + 2;
+	}
+
+	/// Returns the number of buffers all processes can have in flight.
+	/**
+	 * This function returns the number of receive buffers fitting into the
+	 * total budget. It also bounds the free buffers kept for reuse, so these
+	 * do not grow with the number of processes.
+	 *
+	 * @param buffer_size The size of a buffer in bytes.
+	 *
+	 * @return The number of buffers.
+	 */
+	inline std::size_t total_buffers(const std::size_t buffer_size) const
+	{
+		return m_total_budget / buffer_size;
+	}
+
+	/// Returns whether target output is dropped on overflow.
+	/**
+	 * This function returns whether target output is dropped on overflow
+	 * instead of paused.
+	 *
+	 * @return @c true for dropping, @c false for pausing.
+	 */
+	inline bool drop_overflow() const
+	{
+		return m_drop_overflow;
+	}
+
+	/// Returns the number of dropped bytes of a process.
+	/**
+	 * This function returns the number of target output bytes of a process
+	 * which were dropped so far.
+	 *
+	 * @param rank The process rank.
+	 *
+	 * @return The number of dropped bytes.
+	 */
+	inline std::uint64_t dropped(const int rank) const
+	{
+		return m_ranks[rank].dropped.load(std::memory_order_relaxed);
+	}
+
+	/// Returns the number of bytes in flight.
+	/**
+	 * This function returns the number of bytes in flight of all processes.
+	 *
+	 * @return The number of bytes in flight.
+	 */
+	inline std::size_t total() const
+	{
+		return m_total.load(std::memory_order_relaxed);
+	}
+
+	/// Returns the number of paused reading threads.
+	/**
+	 * This function returns the number of reading threads currently waiting
+	 * for room in a budget.
+	 *
+	 * @return The number of paused reading threads.
+	 */
+	inline int num_throttled() const
+	{
+		return m_num_throttled.load(std::memory_order_relaxed);
+	}
+};
+
+#endif /* INGEST_BUDGET_HPP */
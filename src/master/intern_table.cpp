@@ -0,0 +1,82 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file intern_table.cpp
+ *
+ * @brief Contains the implementation of the InternTable class.
+ *
+ * This file contains the implementation of the InternTable class.
+ */
+
+#include "intern_table.hpp"
+
+using std::string;
+
+/**
+ * This is the default constructor for the InternTable class. The empty string
+ * is interned as @ref INTERN_NONE.
+ */
+InternTable::InternTable()
+{
+	m_strings.emplace_back();
+	m_ids.emplace(m_strings.back(), INTERN_NONE);
+}
+
+/**
+ * This function returns the ID of a string. A new string is copied into the
+ * table once, the keys of the lookup point to the copies, which the deque
+ * never moves.
+ *
+ * @param text The string.
+ *
+ * @return The ID of the string, @ref INTERN_NONE for the empty string.
+ */
+int InternTable::intern(const std::string_view text)
+{
+	if (text.empty())
+	{
+		return INTERN_NONE;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto it = m_ids.find(text);
+	if (it != m_ids.end())
+	{
+		return it->second;
+	}
+	const int id = (int)m_strings.size();
+	m_strings.emplace_back(text);
+	m_ids.emplace(m_strings.back(), id);
+	return id;
+}
+
+/**
+ * This function returns the string of an ID. The reference stays valid while
+ * other strings are added.
+ *
+ * @param id The ID returned by @ref intern.
+ *
+ * @return The string.
+ */
+const string &InternTable::str(const int id) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_strings[id];
+}
+
@@ -0,0 +1,66 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file intern_table.hpp
+ *
+ * @brief Header file for the InternTable class.
+ *
+ * This is the header file for the InternTable class.
+ */
+
+#ifndef INTERN_TABLE_HPP
+#define INTERN_TABLE_HPP
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// The ID of the empty string, meaning no file or function.
+#define INTERN_NONE 0
+
+/// Maps the strings of all processes to small integer IDs.
+/**
+ * This class interns the source file paths and function names of the stop
+ * records. Every distinct string is stored once and identified by a small
+ * integer, so the per-process state holds IDs instead of copies of the same
+ * paths, and comparing locations is comparing integers. The worker threads of
+ * the ParsePool intern while parsing, the GUI thread looks the strings up when
+ * it needs their text. Strings are never removed, an ID stays valid for the
+ * lifetime of the table.
+ */
+class InternTable
+{
+	mutable std::mutex m_mutex;
+	std::deque<std::string> m_strings;
+	std::unordered_map<std::string_view, int> m_ids;
+
+public:
+	/// Default constructor.
+	InternTable();
+
+	/// Returns the ID of a string, adding it if it is new. (thread-safe)
+	int intern(const std::string_view text);
+	/// Returns the string of an ID. (thread-safe)
+	const std::string &str(const int id) const;
+};
+
+#endif /* INTERN_TABLE_HPP */
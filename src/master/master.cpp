@@ -32,36 +32,54 @@
 #include <utility>
 #include <unistd.h>
 #include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <getopt.h>
 
 #include "master.hpp"
 #include "window.hpp"
+#include "headless.hpp"
 #include "startup.hpp"
+#include "session_log.hpp"
 
 using asio::ip::tcp;
 using std::string;
 
-#define MAX_LENGTH 8192 // socat default
-
 static Gtk::Application *s_app;
 
+/// The default number of seconds to wait for replies in headless mode.
+#define HEADLESS_TIMEOUT 30
+
 /**
- * This is the default constructor for the Master class. It sets the base ports
- * for the TCP sockets and creates a new Gtk::Application, which will later
- * display the GUI.
+ * This is the default constructor for the Master class. The Gtk::Application,
+ * which will later display the GUI, is only created with the startup dialog,
+ * so the headless mode runs without a display.
  */
 Master::Master()
+	: m_window(nullptr),
+	  m_headless(nullptr),
+	  m_dialog(nullptr),
+	  m_reply_timeout(HEADLESS_TIMEOUT),
+	  m_record_path(nullptr),
+	  m_recorder(nullptr),
+	  m_stop_replay(false)
 {
-	m_app = Gtk::Application::create();
-	s_app = m_app.get();
 }
 
 /**
- * This function will delete the app and the GUI window.
+ * This function will delete the app and the GUI window or the headless state.
+ * A replay still feeding the GUI window is stopped first.
  */
 Master::~Master()
 {
+	stop_replay();
 	m_app.reset();
 	delete m_window;
+	delete m_headless;
+	delete m_recorder;
 }
 
 /**
@@ -97,7 +115,9 @@ int Master::run_cmd(ssh_session &session)
 		ssh_channel_free(channel);
 		return rc;
 	}
-	printf("Started slaves via SSH with command:\n%s\n", cmd.c_str());
+	// in headless mode stdout is reserved for the JSON output
+	fprintf(nullptr != m_headless ? stderr : stdout,
+			"Started slaves via SSH with command:\n%s\n", cmd.c_str());
 
 	ssh_channel_send_eof(channel);
 	ssh_channel_close(channel);
@@ -183,6 +203,11 @@ bool Master::start_slaves_local()
 		{
 			close(fd);
 		}
+		// in headless mode stdout is reserved for the JSON output
+		if (nullptr != m_headless)
+		{
+			dup2(STDERR_FILENO, STDOUT_FILENO);
+		}
 
 		string cmd = m_dialog->get_cmd();
 		printf("Started slaves with command:\n%s\n", cmd.c_str());
@@ -207,33 +232,36 @@ bool Master::start_slaves_local()
 
 /**
  * This function handles the TCP communication between socat and the master.
- * It waits (blocking) for data. When data is received, a copy is sent to be
- * displayed/parsed. On error the connection is closed and the master
- * terminates.
+ * It waits (blocking) for data. The data is received into a pooled buffer,
+ * which is then handed over to the GUI thread to be displayed/parsed. On
+ * error the connection is closed and the master terminates.
+ *
+ * @tparam Receiver The class handling the received data: UIWindow or
+ * Headless.
+ *
+ * @param[in] receiver The object handling the received data.
  *
  * @param socket The TCP socket.
  *
  * @param port The assigned port of the @p socket.
  */
-void Master::read_data(tcp::socket socket, const asio::ip::port_type port)
+template <class Receiver>
+void Master::read_data(Receiver *receiver, tcp::socket socket,
+					   const asio::ip::port_type port)
 {
-	const int rank = m_window->get_rank(port);
-	if (m_window->src_is_gdb(port))
+	const int rank = receiver->get_rank(port);
+	if (receiver->src_is_gdb(port))
 	{
-		m_window->set_conns_gdb(rank, &socket);
+		receiver->set_conns_gdb(rank, &socket);
 	}
 	else
 	{
-		m_window->set_conns_trgt(rank, &socket);
+		receiver->set_conns_trgt(rank, &socket);
 	}
 
-	// Allocate enough memory for a socat message. This memory will be
-	// overwritten without clearing it, as it is '\0'-terminated anyway.
-	char *data = new char[MAX_LENGTH + 8];
-	if (nullptr == data)
-	{
-		throw std::bad_alloc();
-	}
+	// Take a buffer large enough for a socat message from the pool. This
+	// memory is not cleared, as the data is '\0'-terminated anyway.
+	char *data = receiver->acquire_buffer(port);
 	for (;;)
 	{
 		asio::error_code error;
@@ -241,13 +269,13 @@ void Master::read_data(tcp::socket socket, const asio::ip::port_type port)
 			socket.read_some(asio::buffer(data, MAX_LENGTH), error);
 		if (asio::error::eof == error)
 		{
-			if (m_window->src_is_gdb(port))
+			if (receiver->src_is_gdb(port))
 			{
-				m_window->set_conns_gdb(rank, nullptr);
+				receiver->set_conns_gdb(rank, nullptr);
 			}
 			else
 			{
-				m_window->set_conns_trgt(rank, nullptr);
+				receiver->set_conns_trgt(rank, nullptr);
 			}
 			// there should be no data on eof ... ?
 			break;
@@ -258,47 +286,99 @@ void Master::read_data(tcp::socket socket, const asio::ip::port_type port)
 		}
 		// add null termination to received data.
 		data[length] = '\0';
-		// hand a copy of the data to the print function
-		Glib::signal_idle().connect_once(
-			sigc::bind(sigc::mem_fun(*m_window, &UIWindow::handle_data),
-					   strdup(data), port));
+		if (nullptr != m_recorder)
+		{
+			m_recorder->record(port, data, length);
+		}
+		// hand the buffer over to the GUI thread and continue with a new one,
+		// or read into it again if the data was dropped or already handled
+		if (receiver->push_data(data, length, port))
+		{
+			data = receiver->acquire_buffer(port);
+		}
 	}
-	delete[] data;
+	// the free list of the port is only filled by the thread handling its
+	// data, so the buffer is not returned from here
+	receiver->discard_buffer(data);
 }
 
 /**
  * This function waits for a TCP connection on the TCP @p port.
  *
+ * @tparam Receiver The class handling the received data.
+ *
+ * @param[in] receiver The object handling the received data.
+ *
  * @param acceptor The asio acceptor bound to the TCP address and port.
  *
  * @param port The assigned port of the @p socket.
  */
-void Master::start_acceptor(tcp::acceptor acceptor,
+template <class Receiver>
+void Master::start_acceptor(Receiver *receiver, tcp::acceptor acceptor,
 							const asio::ip::port_type port)
 {
 	tcp::socket socket(acceptor.accept());
 	acceptor.close();
-	read_data(std::move(socket), port);
+	read_data(receiver, std::move(socket), port);
+}
+
+/**
+ * This function creates the UIWindow, or the Headless state in headless mode,
+ * and the acceptors handing the received data to it. If a session log is set,
+ * it is created here.
+ *
+ * @return @c true when all acceptors could be created, @c false on
+ * port collision or if the session log cannot be created.
+ */
+bool Master::start_servers()
+{
+	if (nullptr != m_record_path)
+	{
+		m_recorder = new SessionRecorder(m_record_path,
+										 m_dialog->num_processes(),
+										 m_dialog->base_port());
+		if (!m_recorder->is_open())
+		{
+			fprintf(stderr, "Error: Cannot create %s.\n", m_record_path);
+			return false;
+		}
+	}
+	if (!m_app)
+	{
+		m_headless = new Headless{m_dialog->num_processes(),
+								  m_dialog->base_port(),
+								  m_dialog->rank_budget(),
+								  m_dialog->total_budget(), m_reply_timeout};
+		return start_acceptors(m_headless);
+	}
+	m_window = new UIWindow{m_dialog->num_processes(), m_dialog->base_port(),
+							m_dialog->rank_budget(), m_dialog->total_budget(),
+							m_dialog->drop_overflow()};
+	return start_acceptors(m_window);
 }
 
 /**
  * This function creates threads for each blocking TCP acceptor call. It checks
  * for port collision when creating the acceptor.
  *
+ * @tparam Receiver The class handling the received data.
+ *
+ * @param[in] receiver The object handling the received data.
+ *
  * @return @c true when all acceptors could be created, @c false on
  * port collision.
  */
-bool Master::start_servers()
+template <class Receiver>
+bool Master::start_acceptors(Receiver *receiver)
 {
-	m_window = new UIWindow{m_dialog->num_processes(), m_dialog->base_port()};
-
 	for (int offset = 0; offset < 2 * m_dialog->num_processes(); ++offset)
 	{
 		const int port = m_dialog->base_port() + offset;
 		try
 		{
-			std::thread(&Master::start_acceptor,
+			std::thread(&Master::start_acceptor<Receiver>,
 						this,
+						receiver,
 						tcp::acceptor(
 							*(new asio::io_context),
 							tcp::endpoint(tcp::v4(), port)),
@@ -325,6 +405,8 @@ bool Master::start_servers()
  */
 bool Master::run_startup_dialog()
 {
+	m_app = Gtk::Application::create();
+	s_app = m_app.get();
 	m_dialog = new StartupDialog;
 	for (;;)
 	{
@@ -341,6 +423,24 @@ bool Master::run_startup_dialog()
 	return false;
 }
 
+/**
+ * This function reads the configuration for the headless mode from a
+ * configuration file, as exported by the startup dialog.
+ *
+ * @param[in] config_path The path of the configuration file.
+ *
+ * @param reply_timeout The number of seconds to wait for the replies to a
+ * command.
+ *
+ * @return @c true if the configuration is valid, @c false otherwise.
+ */
+bool Master::load_config(const char *config_path, const int reply_timeout)
+{
+	m_dialog = new StartupDialog(config_path);
+	m_reply_timeout = reply_timeout;
+	return m_dialog->is_valid();
+}
+
 /**
  * This function starts the slaves on the desired debug platform.
  *
@@ -387,6 +487,180 @@ void Master::start_GUI()
 	m_app->run(*m_window->root_window());
 }
 
+/**
+ * This function runs the headless mode. It waits for the slaves and then
+ * executes the commands read from stdin.
+ *
+ * @return @c true on success, @c false if the slaves did not connect in time.
+ */
+bool Master::start_headless()
+{
+	if (!m_headless->wait_slaves(m_reply_timeout))
+	{
+		fprintf(stderr, "Error: The slaves did not connect in time.\n");
+		return false;
+	}
+	m_headless->run(std::cin);
+	return true;
+}
+
+/**
+ * This function sets the file the received data is recorded to. It must be
+ * called before @ref start_servers.
+ *
+ * @param[in] log_path The path of the session log.
+ */
+void Master::record_session(const char *log_path)
+{
+	m_record_path = log_path;
+}
+
+/**
+ * This function feeds the chunks of a session log to the receiver, through
+ * the same handoff as @ref read_data. Without @p paced the chunks are fed as
+ * fast as the receiver takes them, otherwise at the recorded pace. The replay
+ * ends early once @ref stop_replay is called.
+ *
+ * @tparam Receiver The class handling the received data.
+ *
+ * @param[in] receiver The object handling the received data.
+ *
+ * @param[in] reader The session log. It is deleted after the replay.
+ *
+ * @param paced Whether to keep the recorded timing.
+ */
+template <class Receiver>
+void Master::replay(Receiver *receiver, SessionReader *reader,
+					const bool paced)
+{
+	const auto start = std::chrono::steady_clock::now();
+	std::uint64_t time;
+	int idx;
+	size_t length;
+	size_t num_chunks = 0;
+	// the buffers not taken by the receiver, read into again like in read_data
+	std::vector<char *> spares(2 * reader->num_processes(), nullptr);
+	while (!m_stop_replay && reader->next(time, idx, length, MAX_LENGTH))
+	{
+		const int port = reader->base_port() + idx;
+		if (paced)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex_replay);
+			if (m_cond_replay.wait_until(lock,
+										 start + std::chrono::nanoseconds(time),
+										 [this]
+										 { return m_stop_replay.load(); }))
+			{
+				break;
+			}
+		}
+		char *data = nullptr != spares[idx] ? spares[idx]
+											: receiver->acquire_buffer(port);
+		spares[idx] = nullptr;
+		if (!reader->read(data, length))
+		{
+			receiver->discard_buffer(data);
+			break;
+		}
+		data[length] = '\0';
+		if (!receiver->push_data(data, length, port))
+		{
+			spares[idx] = data;
+		}
+		++num_chunks;
+	}
+	for (char *const data : spares)
+	{
+		if (nullptr != data)
+		{
+			receiver->discard_buffer(data);
+		}
+	}
+	const double seconds = std::chrono::duration<double>(
+							   std::chrono::steady_clock::now() - start)
+							   .count();
+	fprintf(stderr, "Replayed %zu chunks in %.3f s.\n", num_chunks, seconds);
+	delete reader;
+}
+
+/**
+ * This function replays a recorded session. No slaves are started, the
+ * recorded chunks are fed to a new UIWindow or, in headless mode, to the
+ * Headless state, which then runs as usual.
+ *
+ * @param[in] log_path The path of the session log.
+ *
+ * @param paced Whether to keep the recorded timing.
+ *
+ * @param headless Whether to replay without the GUI.
+ *
+ * @param reply_timeout The number of seconds to wait for the replies to a
+ * command in headless mode.
+ *
+ * @return @c true on success, @c false if the log cannot be read.
+ */
+bool Master::start_replay(const char *log_path, const bool paced,
+						  const bool headless, const int reply_timeout)
+{
+	SessionReader *reader = new SessionReader(log_path);
+	if (!reader->is_open())
+	{
+		fprintf(stderr, "Error: %s is not a session log.\n", log_path);
+		delete reader;
+		return false;
+	}
+	const size_t rank_budget = (size_t)DEFAULT_RANK_BUDGET_KIB << 10;
+	const size_t total_budget = (size_t)DEFAULT_TOTAL_BUDGET_MIB << 20;
+	if (headless)
+	{
+		m_headless = new Headless{reader->num_processes(), reader->base_port(),
+								  rank_budget, total_budget, reply_timeout};
+		// the replay is finished before quitting, so an empty stdin replays
+		// the whole log
+		std::thread replay_thread(&Master::replay<Headless>, this, m_headless,
+								  reader, paced);
+		m_headless->run(std::cin);
+		replay_thread.join();
+		return true;
+	}
+
+	m_app = Gtk::Application::create();
+	s_app = m_app.get();
+	m_window = new UIWindow{reader->num_processes(), reader->base_port(),
+							rank_budget, total_budget, false};
+	if (!m_window->init(m_app))
+	{
+		delete reader;
+		return false;
+	}
+	m_replay_thread =
+		std::thread(&Master::replay<UIWindow>, this, m_window, reader, paced);
+	m_app->run(*m_window->root_window());
+	stop_replay();
+	return true;
+}
+
+/**
+ * This function stops a replay into the GUI window and joins its thread, so it
+ * no longer uses the window. The GUI thread does not process the received data
+ * anymore, so neither the ingest budget nor a full IngestQueue must pause the
+ * replay, see UIWindow::stop_ingest. It does nothing if no replay runs.
+ */
+void Master::stop_replay()
+{
+	if (!m_replay_thread.joinable())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_replay);
+		m_stop_replay = true;
+	}
+	m_cond_replay.notify_all();
+	m_window->stop_ingest();
+	m_replay_thread.join();
+}
+
 /**
  * This function handles the SIGINT signal. It will close the master and thus
  * the slave program.
@@ -402,14 +676,110 @@ void sigint_handler(int signum)
 	s_app->quit();
 }
 
+/**
+ * This function prints the command line usage of the master.
+ *
+ * @param[in] name The name of the executable.
+ */
+static void print_usage(const char *name)
+{
+	fprintf(stderr,
+			"Usage: %s [options]\n"
+			"  -H, --headless       run without GUI, controlled via stdin\n"
+			"  -c, --config <file>  configuration file (headless mode)\n"
+			"  -t, --timeout <s>    timeout for the slaves and the replies\n"
+			"                       (headless mode, default %d)\n"
+			"  -r, --record <file>  record the received data to a session log\n"
+			"  -R, --replay <file>  replay a session log instead of starting\n"
+			"                       the slaves\n"
+			"  -p, --paced          replay at the recorded pace\n"
+			"  -h, --help           print this help\n",
+			name, HEADLESS_TIMEOUT);
+}
+
 /// Master entry point.
 /**
  * This is the entry point for ParallelGDB. It will first open a dialog to
  * configure the necessary parameters and then start the slaves and the GUI.
+ *
+ * In headless mode no GUI is started. The configuration is read from a file
+ * and the debugger is controlled via stdin and stdout instead. In replay mode
+ * a recorded session log is fed to the GUI or the headless mode.
  */
-int main(int, char const **)
+int main(int argc, char **argv)
 {
+	static const struct option long_options[] = {
+		{"headless", no_argument, nullptr, 'H'},
+		{"config", required_argument, nullptr, 'c'},
+		{"timeout", required_argument, nullptr, 't'},
+		{"record", required_argument, nullptr, 'r'},
+		{"replay", required_argument, nullptr, 'R'},
+		{"paced", no_argument, nullptr, 'p'},
+		{"help", no_argument, nullptr, 'h'},
+		{nullptr, 0, nullptr, 0}};
+	bool headless = false;
+	bool paced = false;
+	const char *config_path = nullptr;
+	const char *replay_path = nullptr;
+	int timeout = HEADLESS_TIMEOUT;
 	Master master;
+	int c;
+	while ((c = getopt_long(argc, argv, "Hc:t:r:R:ph", long_options,
+							nullptr)) != -1)
+	{
+		switch (c)
+		{
+		case 'H':
+			headless = true;
+			break;
+		case 'c':
+			config_path = optarg;
+			break;
+		case 't':
+			timeout = atoi(optarg);
+			break;
+		case 'r':
+			master.record_session(optarg);
+			break;
+		case 'R':
+			replay_path = optarg;
+			break;
+		case 'p':
+			paced = true;
+			break;
+		default:
+			print_usage(argv[0]);
+			return 'h' == c ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if (optind < argc || timeout <= 0 ||
+		(headless && nullptr == config_path && nullptr == replay_path))
+	{
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (nullptr != replay_path)
+	{
+		return master.start_replay(replay_path, paced, headless, timeout)
+				   ? EXIT_SUCCESS
+				   : EXIT_FAILURE;
+	}
+	if (headless)
+	{
+		if (!master.load_config(config_path, timeout) ||
+			!master.start_servers())
+		{
+			return EXIT_FAILURE;
+		}
+		if (!master.start_slaves())
+		{
+			fprintf(stderr, "Could not start slaves.\n");
+			return EXIT_FAILURE;
+		}
+		return master.start_headless() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	if (!master.run_startup_dialog())
 	{
 		return EXIT_SUCCESS;
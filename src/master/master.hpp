@@ -31,9 +31,16 @@
 #include "asio.hpp"
 #include <gtkmm.h>
 #include <libssh/libssh.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 class UIWindow;
+class Headless;
 class StartupDialog;
+class SessionRecorder;
+class SessionReader;
 
 /// Holds the state of the master program.
 /**
@@ -45,7 +52,15 @@ class Master
 {
 	Glib::RefPtr<Gtk::Application> m_app;
 	UIWindow *m_window;
+	Headless *m_headless;
 	StartupDialog *m_dialog;
+	int m_reply_timeout;
+	const char *m_record_path;
+	SessionRecorder *m_recorder;
+	std::thread m_replay_thread;
+	std::atomic<bool> m_stop_replay;
+	std::mutex m_mutex_replay;
+	std::condition_variable m_cond_replay;
 
 private:
 	/// Executes the launcher command on the remote server.
@@ -55,11 +70,21 @@ private:
 	/// Starts the slave instances on the local (host) machine.
 	bool start_slaves_local();
 	/// Handles the TCP communication between socat and the master.
-	void read_data(asio::ip::tcp::socket socket,
+	template <class Receiver>
+	void read_data(Receiver *receiver, asio::ip::tcp::socket socket,
 				   const asio::ip::port_type port);
 	/// Waits (blocking) for a TCP connection on the TCP @p port.
-	void start_acceptor(asio::ip::tcp::acceptor acceptor,
+	template <class Receiver>
+	void start_acceptor(Receiver *receiver, asio::ip::tcp::acceptor acceptor,
 						const asio::ip::port_type port);
+	/// Creates threads for each blocking TCP acceptor call.
+	template <class Receiver>
+	bool start_acceptors(Receiver *receiver);
+	/// Feeds the chunks of a session log to the receiver.
+	template <class Receiver>
+	void replay(Receiver *receiver, SessionReader *reader, const bool paced);
+	/// Stops the replay into the GUI and waits for it.
+	void stop_replay();
 
 public:
 	/// Default constructor.
@@ -69,12 +94,21 @@ public:
 
 	/// Runs the startup dialog.
 	bool run_startup_dialog();
+	/// Reads the configuration for the headless mode.
+	bool load_config(const char *config_path, const int reply_timeout);
 	/// Creates threads for each blocking TCP acceptor call.
 	bool start_servers();
 	/// Starts the slaves on the desired debug platform.
 	bool start_slaves();
 	/// Starts the GUI main window.
 	void start_GUI();
+	/// Runs the headless mode on stdin and stdout.
+	bool start_headless();
+	/// Sets the file the received data is recorded to.
+	void record_session(const char *log_path);
+	/// Replays a recorded session in the GUI or headless.
+	bool start_replay(const char *log_path, const bool paced,
+					  const bool headless, const int reply_timeout);
 };
 
 /// Handles the SIGINT signal.
@@ -0,0 +1,292 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file metrics.cpp
+ *
+ * @brief Contains the implementation of the Histogram and Metrics classes.
+ *
+ * This file contains the implementation of the Histogram and Metrics classes.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "metrics.hpp"
+
+using std::size_t;
+using std::string;
+using std::uint64_t;
+
+/**
+ * This is the default constructor for the Histogram class.
+ */
+Histogram::Histogram()
+	: m_count(0),
+	  m_sum(0)
+{
+	for (std::atomic<uint64_t> &bucket : m_buckets)
+	{
+		bucket = 0;
+	}
+}
+
+/**
+ * This function records a duration.
+ *
+ * @param ns The duration in nanoseconds.
+ */
+void Histogram::record(const uint64_t ns)
+{
+	int bucket = 0;
+	if (ns > 0)
+	{
+		bucket = std::min(64 - __builtin_clzll(ns), s_num_buckets - 1);
+	}
+	m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_sum.fetch_add(ns, std::memory_order_relaxed);
+}
+
+/**
+ * This function returns an upper bound of a percentile.
+ *
+ * @param fraction The percentile as a fraction, e.g. 0.99.
+ *
+ * @return The upper bound of the bucket the percentile falls into, in
+ * nanoseconds. 0 if nothing was recorded.
+ */
+uint64_t Histogram::percentile(const double fraction) const
+{
+	const uint64_t count = m_count.load(std::memory_order_relaxed);
+	if (0 == count)
+	{
+		return 0;
+	}
+	const uint64_t target = std::max<uint64_t>(1, fraction * count);
+	uint64_t seen = 0;
+	for (int bucket = 0; bucket < s_num_buckets; ++bucket)
+	{
+		seen += m_buckets[bucket].load(std::memory_order_relaxed);
+		if (seen >= target)
+		{
+			return uint64_t(1) << bucket;
+		}
+	}
+	return uint64_t(1) << (s_num_buckets - 1);
+}
+
+/**
+ * This is the default constructor for the Metrics class.
+ *
+ * @param num_processes The number of processes.
+ */
+Metrics::Metrics(const int num_processes)
+	: m_num_processes(num_processes),
+	  m_bytes(new std::atomic<uint64_t>[num_processes]),
+	  m_chunks(new std::atomic<uint64_t>[num_processes]),
+	  m_last_bytes(new uint64_t[num_processes]()),
+	  m_last_chunks(new uint64_t[num_processes]()),
+	  m_byte_rates(new double[num_processes]()),
+	  m_chunk_rates(new double[num_processes]()),
+	  m_pending_idle(0),
+	  m_frame_lookups(0),
+	  m_frame_hits(0)
+{
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		m_bytes[rank] = 0;
+		m_chunks[rank] = 0;
+	}
+}
+
+/**
+ * This function deallocates the counters.
+ */
+Metrics::~Metrics()
+{
+	delete[] m_bytes;
+	delete[] m_chunks;
+	delete[] m_last_bytes;
+	delete[] m_last_chunks;
+	delete[] m_byte_rates;
+	delete[] m_chunk_rates;
+}
+
+/**
+ * This function returns the current time of a monotonic clock.
+ *
+ * @return The current time in nanoseconds.
+ */
+uint64_t Metrics::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+/**
+ * This function counts a chunk received from a socket.
+ *
+ * @param rank The process rank.
+ *
+ * @param length The length of the chunk in bytes.
+ */
+void Metrics::count_read(const int rank, const size_t length)
+{
+	m_bytes[rank].fetch_add(length, std::memory_order_relaxed);
+	m_chunks[rank].fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * This function computes the byte and chunk rates per process since the last
+ * call.
+ *
+ * @param seconds The time since the last call in seconds.
+ */
+void Metrics::sample(const double seconds)
+{
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		const uint64_t bytes = m_bytes[rank].load(std::memory_order_relaxed);
+		const uint64_t chunks = m_chunks[rank].load(std::memory_order_relaxed);
+		m_byte_rates[rank] = (bytes - m_last_bytes[rank]) / seconds;
+		m_chunk_rates[rank] = (chunks - m_last_chunks[rank]) / seconds;
+		m_last_bytes[rank] = bytes;
+		m_last_chunks[rank] = chunks;
+	}
+}
+
+/**
+ * This function formats a duration with a fitting unit.
+ *
+ * @param ns The duration in nanoseconds.
+ *
+ * @return The formatted duration.
+ */
+static string format_ns(const uint64_t ns)
+{
+	char text[32];
+	if (ns < 1000)
+	{
+		snprintf(text, sizeof(text), "%lu ns", (unsigned long)ns);
+	}
+	else if (ns < 1000000)
+	{
+		snprintf(text, sizeof(text), "%.1f us", ns / 1e3);
+	}
+	else
+	{
+		snprintf(text, sizeof(text), "%.1f ms", ns / 1e6);
+	}
+	return text;
+}
+
+/**
+ * This function formats a histogram as a table row.
+ *
+ * @param[in] name The name of the row.
+ *
+ * @param[in] histogram The histogram.
+ *
+ * @return The formatted row.
+ */
+static string format_histogram(const char *const name,
+							   const Histogram &histogram)
+{
+	char text[160];
+	const uint64_t count = histogram.count();
+	snprintf(text, sizeof(text), "%-22s %10lu %10s %10s %10s %10s\n", name,
+			 (unsigned long)count,
+			 format_ns(count ? histogram.sum() / count : 0).c_str(),
+			 format_ns(histogram.percentile(0.5)).c_str(),
+			 format_ns(histogram.percentile(0.9)).c_str(),
+			 format_ns(histogram.percentile(0.99)).c_str());
+	return text;
+}
+
+/**
+ * This function formats the metrics as text. The processes are listed in
+ * descending order of their byte rate.
+ *
+ * @param max_ranks The maximum number of processes to list.
+ *
+ * @return The formatted metrics.
+ */
+string Metrics::report(const int max_ranks) const
+{
+	string report;
+	char line[160];
+
+	double total_bytes = 0;
+	double total_chunks = 0;
+	std::vector<int> ranks(m_num_processes);
+	std::iota(ranks.begin(), ranks.end(), 0);
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		total_bytes += m_byte_rates[rank];
+		total_chunks += m_chunk_rates[rank];
+	}
+	const int num_listed = std::min(max_ranks, m_num_processes);
+	std::partial_sort(ranks.begin(), ranks.begin() + num_listed, ranks.end(),
+					  [this](const int lhs, const int rhs)
+					  { return m_byte_rates[lhs] > m_byte_rates[rhs]; });
+
+	report += "Transport\n";
+	snprintf(line, sizeof(line), "%-22s %14s %14s\n", "", "KiB/s", "Chunks/s");
+	report += line;
+	snprintf(line, sizeof(line), "%-22s %14.1f %14.1f\n", "All Processes",
+			 total_bytes / 1024, total_chunks);
+	report += line;
+	for (int idx = 0; idx < num_listed; ++idx)
+	{
+		const int rank = ranks[idx];
+		snprintf(line, sizeof(line), "Process %-14d %14.1f %14.1f\n", rank,
+				 m_byte_rates[rank] / 1024, m_chunk_rates[rank]);
+		report += line;
+	}
+
+	report += "\nLatencies\n";
+	snprintf(line, sizeof(line), "%-22s %10s %10s %10s %10s %10s\n", "",
+			 "Count", "Mean", "p50", "p90", "p99");
+	report += line;
+	report += format_histogram("Parse per Record", parse);
+	report += format_histogram("Text Buffer Insert", insert);
+	report += format_histogram("Read to UI Update", read_to_ui);
+
+	report += "\nStop Frame Cache\n";
+	const uint64_t lookups = m_frame_lookups.load(std::memory_order_relaxed);
+	const uint64_t hits = m_frame_hits.load(std::memory_order_relaxed);
+	snprintf(line, sizeof(line), "%-22s %10s %10s %10s\n", "", "Lookups",
+			 "Hits", "Hit Rate");
+	report += line;
+	snprintf(line, sizeof(line), "%-22s %10lu %10lu %9.1f%%\n",
+			 "All Processes", (unsigned long)lookups, (unsigned long)hits,
+			 lookups ? 100.0 * hits / lookups : 0.0);
+	report += line;
+
+	report += "\nGUI\n";
+	snprintf(line, sizeof(line), "%-22s %10d\n", "Pending Idle Callbacks",
+			 m_pending_idle.load(std::memory_order_relaxed));
+	report += line;
+	return report;
+}
@@ -0,0 +1,163 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file metrics.hpp
+ *
+ * @brief Header file for the Histogram and Metrics classes.
+ *
+ * This is the header file for the Histogram and Metrics classes.
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Counts durations in fixed power-of-two buckets.
+/**
+ * This class is a lock-free histogram of durations in nanoseconds. Bucket
+ * @c i counts the durations in [2^(i-1), 2^i). Recording costs two relaxed
+ * atomic increments, so it is cheap enough to be always enabled. Percentiles
+ * are reported as the upper bound of the bucket they fall into.
+ */
+class Histogram
+{
+	static constexpr int s_num_buckets = 40;
+
+	std::atomic<std::uint64_t> m_buckets[s_num_buckets];
+	std::atomic<std::uint64_t> m_count;
+	std::atomic<std::uint64_t> m_sum;
+
+public:
+	/// Default constructor.
+	Histogram();
+
+	/// Records a duration.
+	void record(const std::uint64_t ns);
+	/// Returns an upper bound of a percentile.
+	std::uint64_t percentile(const double fraction) const;
+
+	/// Returns the number of recorded durations.
+	/**
+	 * This function returns the number of recorded durations.
+	 *
+	 * @return The number of recorded durations.
+	 */
+	inline std::uint64_t count() const
+	{
+		return m_count.load(std::memory_order_relaxed);
+	}
+
+	/// Returns the sum of recorded durations.
+	/**
+	 * This function returns the sum of recorded durations.
+	 *
+	 * @return The sum of recorded durations in nanoseconds.
+	 */
+	inline std::uint64_t sum() const
+	{
+		return m_sum.load(std::memory_order_relaxed);
+	}
+};
+
+/// Collects metrics of the receive pipeline.
+/**
+ * This class collects counters and latency histograms along the path of the
+ * received data: socket reads, parsing, text buffer inserts and the time from
+ * the read until the GUI has been updated. All recording functions are
+ * thread-safe and lock-free. The rates are computed by @ref sample, which is
+ * called periodically by the GUI thread.
+ */
+class Metrics
+{
+	const int m_num_processes;
+
+	std::atomic<std::uint64_t> *const m_bytes;
+	std::atomic<std::uint64_t> *const m_chunks;
+	std::uint64_t *const m_last_bytes;
+	std::uint64_t *const m_last_chunks;
+	double *const m_byte_rates;
+	double *const m_chunk_rates;
+
+	std::atomic<int> m_pending_idle;
+	std::atomic<std::uint64_t> m_frame_lookups;
+	std::atomic<std::uint64_t> m_frame_hits;
+
+public:
+	/** The parse time per MI event. */
+	Histogram parse;
+	/** The time per text buffer insert. */
+	Histogram insert;
+	/** The time from the socket read until the GUI has been updated. */
+	Histogram read_to_ui;
+
+	/// Default constructor.
+	Metrics(const int num_processes);
+	/// Destructor.
+	~Metrics();
+
+	/// Returns the current time for latency measurements.
+	static std::uint64_t now();
+
+	/// Counts a received chunk. (network thread)
+	void count_read(const int rank, const std::size_t length);
+	/// Updates the rates from the counters. (GUI thread)
+	void sample(const double seconds);
+	/// Formats the metrics as text. (GUI thread)
+	std::string report(const int max_ranks) const;
+
+	/// Counts a lookup in a frame cache.
+	/**
+	 * This function counts a lookup in the FrameCache of a parse worker.
+	 *
+	 * @param hit Whether the location was cached.
+	 */
+	inline void count_frame(const bool hit)
+	{
+		m_frame_lookups.fetch_add(1, std::memory_order_relaxed);
+		if (hit)
+		{
+			m_frame_hits.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	/// Counts a scheduled idle callback.
+	/**
+	 * This function counts a scheduled idle callback.
+	 */
+	inline void idle_scheduled()
+	{
+		m_pending_idle.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/// Counts an executed idle callback.
+	/**
+	 * This function counts an executed idle callback.
+	 */
+	inline void idle_ran()
+	{
+		m_pending_idle.fetch_sub(1, std::memory_order_relaxed);
+	}
+};
+
+#endif /* METRICS_HPP */
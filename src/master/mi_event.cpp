@@ -0,0 +1,1565 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file mi_event.cpp
+ *
+ * @brief Contains the implementation of the event parser.
+ *
+ * This file contains the implementation of the parsers turning GDB/MI output
+ * into typed events, line by line and as a stream of chunks. They scan the
+ * output once, without building a tree of results: the keys are mapped by
+ * compile-time keyword tables and only the values of the known keys are
+ * extracted, all others are skipped.
+ */
+
+#include <cstring>
+
+#include "mi_event.hpp"
+
+using std::string_view;
+
+static constexpr Keyword<int> s_result_class_words[] = {
+	{"done", MI_CL_DONE},
+	{"running", MI_CL_RUNNING},
+	{"connected", MI_CL_CONNECTED},
+	{"error", MI_CL_ERROR},
+	{"exit", MI_CL_EXIT}};
+/// The classes of result records.
+static constexpr KeywordTable<int, 8> s_result_classes(s_result_class_words,
+													   MI_CL_UNKNOWN);
+static_assert(s_result_classes.perfect(), "result class collision");
+
+static constexpr Keyword<int> s_async_class_words[] = {
+	{"stopped", MI_CL_STOPPED},
+	{"running", MI_CL_RUNNING},
+	{"breakpoint-created", MI_CL_BREAKPOINT_CREATED},
+	{"breakpoint-modified", MI_CL_BREAKPOINT_MODIFIED},
+	{"breakpoint-deleted", MI_CL_BREAKPOINT_DELETED}};
+/// The classes of async records.
+static constexpr KeywordTable<int, 8> s_async_classes(s_async_class_words,
+													  MI_CL_UNKNOWN);
+static_assert(s_async_classes.perfect(), "async class collision");
+
+static constexpr Keyword<mi_stop_reason> s_stop_reason_words[] = {
+	{"breakpoint-hit", sr_bkpt_hit},
+	{"watchpoint-trigger", sr_wp_trigger},
+	{"read-watchpoint-trigger", sr_read_wp_trigger},
+	{"access-watchpoint-trigger", sr_access_wp_trigger},
+	{"watchpoint-scope", sr_wp_scope},
+	{"function-finished", sr_function_finished},
+	{"location-reached", sr_location_reached},
+	{"end-stepping-range", sr_end_stepping_range},
+	{"exited-signalled", sr_exited_signalled},
+	{"exited", sr_exited},
+	{"exited-normally", sr_exited_normally},
+	{"signal-received", sr_signal_received}};
+/// The reasons of stop records.
+static constexpr KeywordTable<mi_stop_reason, 32> s_stop_reasons(
+	s_stop_reason_words, sr_unknown);
+static_assert(s_stop_reasons.perfect(), "stop reason collision");
+
+static constexpr Keyword<MiKey> s_key_words[] = {
+	{"reason", MiKey::REASON},
+	{"bkptno", MiKey::BKPTNO},
+	{"exit-code", MiKey::EXIT_CODE},
+	{"frame", MiKey::FRAME},
+	{"args", MiKey::ARGS},
+	{"fullname", MiKey::FULLNAME},
+	{"line", MiKey::LINE},
+	{"func", MiKey::FUNC},
+	{"bkpt", MiKey::BKPT},
+	{"number", MiKey::NUMBER},
+	{"id", MiKey::ID},
+	{"value", MiKey::VALUE},
+	{"msg", MiKey::MSG}};
+/// The keys of results.
+static constexpr KeywordTable<MiKey, 32> s_keys(s_key_words, MiKey::UNKNOWN);
+static_assert(s_keys.perfect(), "key collision");
+
+/**
+ * This function converts a number like @c atoi.
+ *
+ * @param text The text of the number.
+ *
+ * @return The number, or 0 if the text does not start with one.
+ */
+static int to_int(const string_view text)
+{
+	size_t i = 0;
+	while (i < text.size() && (' ' == text[i] || '\t' == text[i]))
+	{
+		++i;
+	}
+	const bool negative = i < text.size() && '-' == text[i];
+	if (i < text.size() && ('-' == text[i] || '+' == text[i]))
+	{
+		++i;
+	}
+	int value = 0;
+	for (; i < text.size() && '0' <= text[i] && text[i] <= '9'; ++i)
+	{
+		value = value * 10 + (text[i] - '0');
+	}
+	return negative ? -value : value;
+}
+
+/**
+ * This function returns whether a character may be part of a result name.
+ *
+ * @param c The character.
+ *
+ * @return @c true if the character is a name character.
+ */
+static inline bool is_name_char(const char c)
+{
+	return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') ||
+		   ('0' <= c && c <= '9') || '-' == c || '_' == c;
+}
+
+/**
+ * This function scans a c-string. A quote only ends the string if it is
+ * followed by the end of the line, ',', ']' or '}', as GDB does not always
+ * escape quotes. Escaped strings are unescaped in place.
+ *
+ * @param pos The position of the opening quote, set behind the closing quote.
+ *
+ * @param[out] value The string, or @c nullptr to skip it.
+ *
+ * @return @c true on success, @c false if the string is malformed.
+ */
+static bool scan_string(char *&pos, string_view *const value)
+{
+	if ('"' != *pos)
+	{
+		return false;
+	}
+	char *const start = pos + 1;
+	char *end = start;
+	bool escaped = false;
+	for (;;)
+	{
+		end = (char *)mi_scan_cstr(end);
+		if ('\\' == *end)
+		{
+			if ('\0' == end[1])
+			{
+				return false;
+			}
+			escaped = true;
+			end += 2;
+		}
+		else if ('\0' == *end)
+		{
+			return false;
+		}
+		else if ('\0' == end[1] || ',' == end[1] || ']' == end[1] ||
+				 '}' == end[1])
+		{
+			break;
+		}
+		else
+		{
+			++end;
+		}
+	}
+	pos = end + 1;
+	if (nullptr == value)
+	{
+		return true;
+	}
+	if (!escaped)
+	{
+		*value = string_view(start, end - start);
+		return true;
+	}
+	char *dest = start;
+	for (char *src = start; src < end; ++src, ++dest)
+	{
+		if ('\\' == *src)
+		{
+			++src;
+			*dest = 'n' == *src ? '\n' : 't' == *src ? '\t' : *src;
+		}
+		else
+		{
+			*dest = *src;
+		}
+	}
+	*value = string_view(start, dest - start);
+	return true;
+}
+
+/**
+ * This function scans the name of a result up to the '='. A meaningless
+ * string GDB sometimes puts before the name is skipped, e.g.
+ * *stopped,"Starting program",...
+ *
+ * @param pos The position of the name, set behind the '='.
+ *
+ * @param[out] name The name.
+ *
+ * @return @c true on success, @c false if the name is malformed.
+ */
+static bool scan_name(char *&pos, string_view &name)
+{
+	if ('"' == *pos)
+	{
+		if (!scan_string(pos, nullptr) || ',' != *pos)
+		{
+			return false;
+		}
+		++pos;
+	}
+	char *const start = pos;
+	while (is_name_char(*pos))
+	{
+		++pos;
+	}
+	if ('=' != *pos)
+	{
+		return false;
+	}
+	name = string_view(start, pos - start);
+	++pos;
+	return true;
+}
+
+/**
+ * This function skips a value: a c-string, a tuple or a list.
+ *
+ * @param pos The position of the value, set behind it.
+ *
+ * @return @c true on success, @c false if the value is malformed.
+ */
+static bool skip_value(char *&pos)
+{
+	if ('"' == *pos)
+	{
+		return scan_string(pos, nullptr);
+	}
+	if ('{' != *pos && '[' != *pos)
+	{
+		return false;
+	}
+	const char close = '{' == *pos ? '}' : ']';
+	++pos;
+	if (close == *pos)
+	{
+		++pos;
+		return true;
+	}
+	for (;;)
+	{
+		string_view name;
+		if ('"' != *pos && '{' != *pos && '[' != *pos && !scan_name(pos, name))
+		{
+			return false;
+		}
+		if (!skip_value(pos))
+		{
+			return false;
+		}
+		if (',' != *pos)
+		{
+			break;
+		}
+		++pos;
+	}
+	if (close != *pos)
+	{
+		return false;
+	}
+	++pos;
+	return true;
+}
+
+/**
+ * This function scans a value which is expected to be a c-string. Other
+ * values are skipped, like libmigdb ignores them.
+ *
+ * @param pos The position of the value, set behind it.
+ *
+ * @param[out] value The string, unchanged if the value is no c-string.
+ *
+ * @return @c true on success, @c false if the value is malformed.
+ */
+static bool scan_const(char *&pos, string_view &value)
+{
+	return '"' == *pos ? scan_string(pos, &value) : skip_value(pos);
+}
+
+/**
+ * This function scans the results of a record or a tuple. The value of every
+ * result is handed to a function, which has to scan or skip it.
+ *
+ * @param pos The position behind the class of a record or of the opening
+ * brace of a tuple, set behind the record or tuple.
+ *
+ * @param close The end of the results, '\0' for a record, '}' for a tuple.
+ *
+ * @param[in] on_result The function called with the key of every result and
+ * the position of its value. Returns @c false if the value is malformed.
+ *
+ * @return @c true on success, @c false if the results are malformed.
+ */
+template <typename Function>
+static bool scan_results(char *&pos, const char close, Function &&on_result)
+{
+	if ('\0' != close && close == *pos)
+	{
+		++pos;
+		return true;
+	}
+	for (bool first = '\0' != close; first || ',' == *pos; first = false)
+	{
+		if (!first)
+		{
+			++pos;
+		}
+		string_view name;
+		if (!scan_name(pos, name) || !on_result(s_keys.find(name), pos))
+		{
+			return false;
+		}
+	}
+	if (close != *pos)
+	{
+		return false;
+	}
+	if ('\0' != close)
+	{
+		++pos;
+	}
+	return true;
+}
+
+/**
+ * This function extracts the number of a breakpoint from a bkpt tuple.
+ *
+ * @param pos The position of the value, set behind it.
+ *
+ * @param[out] number The number, unchanged if there is none.
+ *
+ * @return @c true on success, @c false if the value is malformed.
+ */
+static bool scan_bkpt(char *&pos, int &number)
+{
+	if ('{' != *pos)
+	{
+		return skip_value(pos);
+	}
+	++pos;
+	return scan_results(pos, '}',
+						[&number](const MiKey key, char *&value)
+						{
+							string_view text;
+							if (MiKey::NUMBER != key)
+							{
+								return skip_value(value);
+							}
+							if (!scan_const(value, text))
+							{
+								return false;
+							}
+							number = to_int(text);
+							return true;
+						});
+}
+
+/**
+ * This function parses a result record.
+ *
+ * @param pos The position behind the result class.
+ *
+ * @param tclass The result class.
+ *
+ * @return The event.
+ */
+static MiEvent parse_result(char *pos, const int tclass)
+{
+	MiResult result{tclass, string_view(), 0};
+	bool have_value = false;
+	bool have_bkpt = false;
+	if (!scan_results(pos, '\0',
+					  [&](const MiKey key, char *&value)
+					  {
+						  if ((MiKey::VALUE == key || MiKey::MSG == key) &&
+							  !have_value && '"' == *value)
+						  {
+							  have_value = true;
+							  return scan_string(value, &result.value);
+						  }
+						  if (MiKey::BKPT == key && !have_bkpt &&
+							  MI_CL_DONE == tclass)
+						  {
+							  have_bkpt = true;
+							  return scan_bkpt(value, result.bkpt_number);
+						  }
+						  return skip_value(value);
+					  }))
+	{
+		return std::monostate();
+	}
+	return result;
+}
+
+/**
+ * This function parses a stop record.
+ *
+ * @param pos The position behind the class.
+ *
+ * @return The event, a MiStopped or a MiExited.
+ */
+static MiEvent parse_stopped(char *pos)
+{
+	MiStopped stopped{sr_unknown, 0, string_view()};
+	bool have_bkptno = false;
+	bool have_exit_code = false;
+	int exit_code = 0;
+	string_view text;
+	if (!scan_results(
+			pos, '\0',
+			[&](const MiKey key, char *&value)
+			{
+				switch (key)
+				{
+				case MiKey::REASON:
+					if ('"' != *value)
+					{
+						return skip_value(value);
+					}
+					if (!scan_string(value, &text))
+					{
+						return false;
+					}
+					// with more than one reason just the last, like libmigdb
+					stopped.reason = s_stop_reasons.find(text);
+					return true;
+				case MiKey::BKPTNO:
+				case MiKey::EXIT_CODE:
+					if ('"' != *value ||
+						(MiKey::BKPTNO == key ? have_bkptno : have_exit_code))
+					{
+						return skip_value(value);
+					}
+					if (!scan_string(value, &text))
+					{
+						return false;
+					}
+					if (MiKey::BKPTNO == key)
+					{
+						have_bkptno = true;
+						stopped.bkptno = to_int(text);
+					}
+					else
+					{
+						have_exit_code = true;
+						exit_code = to_int(text);
+					}
+					return true;
+				case MiKey::FRAME:
+				{
+					if ('{' != *value)
+					{
+						return skip_value(value);
+					}
+					// the last frame counts
+					char *const start = value;
+					if (!skip_value(value))
+					{
+						return false;
+					}
+					stopped.frame = string_view(start, value - start);
+					return true;
+				}
+				default:
+					return skip_value(value);
+				}
+			}))
+	{
+		return std::monostate();
+	}
+	if (sr_exited_signalled == stopped.reason || sr_exited == stopped.reason ||
+		sr_exited_normally == stopped.reason)
+	{
+		return MiExited{stopped.reason, exit_code};
+	}
+	return stopped;
+}
+
+/**
+ * This function parses a breakpoint notification.
+ *
+ * @param pos The position behind the class.
+ *
+ * @param tclass The class of the notification.
+ *
+ * @return The event.
+ */
+static MiEvent parse_breakpoint(char *pos, const int tclass)
+{
+	int number = 0;
+	if (!scan_results(pos, '\0',
+					  [&number](const MiKey key, char *&value)
+					  {
+						  if (MiKey::BKPT == key)
+						  {
+							  return scan_bkpt(value, number);
+						  }
+						  if (MiKey::ID == key)
+						  {
+							  string_view text;
+							  if (!scan_const(value, text))
+							  {
+								  return false;
+							  }
+							  number = to_int(text);
+							  return true;
+						  }
+						  return skip_value(value);
+					  }))
+	{
+		return std::monostate();
+	}
+	if (MI_CL_BREAKPOINT_CREATED == tclass)
+	{
+		return MiBreakpointCreated{number};
+	}
+	if (MI_CL_BREAKPOINT_MODIFIED == tclass)
+	{
+		return MiBreakpointModified{number};
+	}
+	return MiBreakpointDeleted{number};
+}
+
+/**
+ * This function parses a stream record.
+ *
+ * @param pos The position of the string.
+ *
+ * @param stream The stream, MI_SST_CONSOLE, MI_SST_TARGET or MI_SST_LOG.
+ *
+ * @return The event.
+ */
+static MiEvent parse_stream(char *pos, const int stream)
+{
+	MiStreamText text{stream, string_view()};
+	if (!scan_string(pos, &text.text))
+	{
+		return std::monostate();
+	}
+	return text;
+}
+
+/**
+ * This function parses a line of GDB/MI output into an event. The line is
+ * scanned once. Only the results needed for the event are extracted, the
+ * records no event exists for are not scanned beyond their class.
+ *
+ * Strings of the event point into the line, which is modified to unescape
+ * them. They are valid as long as the line.
+ *
+ * @param[in] line The line without the newline, terminated by '\0'.
+ *
+ * @return The event, or a std::monostate for records of no interest and
+ * malformed lines.
+ */
+MiEvent parse_mi_event(char *const line)
+{
+	char *pos = line + 1;
+	switch (line[0])
+	{
+	case '(':
+		if (0 == strncmp(line, "(gdb)", 5))
+		{
+			return MiPrompt();
+		}
+		return std::monostate();
+	case '~':
+		return parse_stream(pos, MI_SST_CONSOLE);
+	case '@':
+		return parse_stream(pos, MI_SST_TARGET);
+	case '&':
+		return parse_stream(pos, MI_SST_LOG);
+	case '^':
+	case '*':
+	case '=':
+		break;
+	default:
+		return std::monostate();
+	}
+	char *const start = pos;
+	while ('\0' != *pos && ',' != *pos)
+	{
+		++pos;
+	}
+	const string_view name(start, pos - start);
+	if ('^' == line[0])
+	{
+		const int tclass = s_result_classes.find(name);
+		if (MI_CL_UNKNOWN == tclass)
+		{
+			return std::monostate();
+		}
+		return parse_result(pos, tclass);
+	}
+	const int tclass = s_async_classes.find(name);
+	switch (tclass)
+	{
+	case MI_CL_STOPPED:
+		return '*' == line[0] ? parse_stopped(pos) : MiEvent();
+	case MI_CL_RUNNING:
+		return '*' == line[0] ? MiEvent(MiRunning()) : MiEvent();
+	case MI_CL_BREAKPOINT_CREATED:
+	case MI_CL_BREAKPOINT_MODIFIED:
+	case MI_CL_BREAKPOINT_DELETED:
+		return '=' == line[0] ? parse_breakpoint(pos, tclass) : MiEvent();
+	default:
+		return std::monostate();
+	}
+}
+
+/**
+ * This function extracts the location of a stop from the text of its frame,
+ * MiStopped::frame. The strings are unescaped in place.
+ *
+ * @param[in] frame A copy of the frame, terminated by '\0'.
+ *
+ * @param[out] location The location, pointing into @p frame.
+ *
+ * @return @c true on success, @c false if the frame is malformed.
+ */
+bool parse_mi_frame(char *const frame, MiFrame &location)
+{
+	location = MiFrame{string_view(), 0, string_view()};
+	char *pos = frame;
+	if ('{' != *pos)
+	{
+		return false;
+	}
+	++pos;
+	string_view text;
+	return scan_results(
+		pos, '}',
+		[&location, &text](const MiKey key, char *&value)
+		{
+			if (MiKey::FULLNAME == key)
+			{
+				return scan_const(value, location.fullname);
+			}
+			if (MiKey::FUNC == key)
+			{
+				return scan_const(value, location.func);
+			}
+			if (MiKey::LINE == key)
+			{
+				text = string_view();
+				if (!scan_const(value, text))
+				{
+					return false;
+				}
+				location.line = to_int(text);
+				return true;
+			}
+			return skip_value(value);
+		});
+}
+
+/// The text of the prompt.
+static constexpr string_view s_prompt("(gdb)");
+
+/**
+ * This is the default constructor for the MiEventParser class.
+ */
+MiEventParser::MiEventParser()
+	: m_pos(nullptr),
+	  m_end(nullptr),
+	  m_state(State::LINE_START),
+	  m_after_string(State::DISCARD),
+	  m_cr_from(State::DISCARD),
+	  m_capture(Capture::NONE),
+	  m_text_flushed(false),
+	  m_word_length(0),
+	  m_number(nullptr),
+	  m_number_started(false),
+	  m_number_negative(false),
+	  m_number_done(false),
+	  m_frame_from(nullptr)
+{
+	m_text.reserve(MI_EVENT_MAX_TEXT);
+	start_record();
+}
+
+/**
+ * This function sets the next chunk to be parsed. The chunk is neither
+ * modified nor copied, it must stay valid until @ref next returned @c false.
+ * All events of the previous chunk must have been fetched before.
+ *
+ * @param[in] data The received chunk.
+ *
+ * @param length The length of the chunk in bytes.
+ */
+void MiEventParser::feed(const char *const data, const size_t length)
+{
+	m_pos = data;
+	m_end = data + length;
+	m_frame_from = data;
+}
+
+/**
+ * This function forgets the record of the previous line.
+ */
+void MiEventParser::start_record()
+{
+	m_record = Record::NONE;
+	m_type = '\0';
+	m_tclass = MI_CL_UNKNOWN;
+	m_key = MiKey::UNKNOWN;
+	m_context = MiKey::UNKNOWN;
+	m_depth = 0;
+	m_capture = Capture::NONE;
+	m_text.clear();
+	m_frame.clear();
+	m_frame_copy = FrameCopy::NONE;
+	m_frame_overflow = false;
+	m_have_value = false;
+	m_have_bkpt = false;
+	m_have_bkptno = false;
+	m_have_exit_code = false;
+	m_have_frame = false;
+	m_reason = sr_unknown;
+	m_bkptno = 0;
+	m_exit_code = 0;
+	m_bkpt_number = 0;
+}
+
+/**
+ * This function returns whether the results at the current depth are looked
+ * at: those of the record and those of the tuple of a known key, like the
+ * frame of a stop. Their names are looked up and may be preceded by a
+ * meaningless string like in parse_mi_event. All other values are skipped.
+ *
+ * @return @c true if the results are looked at.
+ */
+bool MiEventParser::named() const
+{
+	return 0 == m_depth || (1 == m_depth && MiKey::UNKNOWN != m_context);
+}
+
+/**
+ * This function appends characters to the current word. Only the first
+ * @ref MI_EVENT_MAX_WORD characters are kept.
+ *
+ * @param[in] data The characters.
+ *
+ * @param length The number of characters.
+ */
+void MiEventParser::add_word(const char *const data, const size_t length)
+{
+	if (m_word_length < MI_EVENT_MAX_WORD)
+	{
+		const size_t space = MI_EVENT_MAX_WORD - m_word_length;
+		memcpy(m_word + m_word_length, data, length < space ? length : space);
+	}
+	m_word_length += length;
+}
+
+/**
+ * This function returns the current word. Words longer than
+ * @ref MI_EVENT_MAX_WORD are no keywords, they are returned as empty.
+ *
+ * @return The word.
+ */
+string_view MiEventParser::word() const
+{
+	return m_word_length <= MI_EVENT_MAX_WORD
+			   ? string_view(m_word, m_word_length)
+			   : string_view();
+}
+
+/**
+ * This function starts a c-string behind its opening quote.
+ *
+ * @param capture Where the bytes of the string go.
+ *
+ * @param after The state behind the closing quote.
+ */
+void MiEventParser::start_string(const Capture capture, const State after)
+{
+	m_capture = capture;
+	m_after_string = after;
+	m_state = State::STRING;
+	if (Capture::WORD == capture)
+	{
+		m_word_length = 0;
+	}
+}
+
+/**
+ * This function starts a c-string which is converted like @c atoi.
+ *
+ * @param[out] target The number, 0 until digits are found.
+ */
+void MiEventParser::start_number(int *const target)
+{
+	*target = 0;
+	m_number = target;
+	m_number_started = false;
+	m_number_negative = false;
+	m_number_done = false;
+	start_string(Capture::NUMBER, State::AFTER_VALUE);
+}
+
+/**
+ * This function passes unescaped bytes of a c-string to its capture. Text
+ * beyond @ref MI_EVENT_MAX_TEXT is dropped, except for stream text, which is
+ * left for the next event.
+ *
+ * @param[in] data The bytes.
+ *
+ * @param length The number of bytes.
+ *
+ * @return The number of bytes consumed.
+ */
+size_t MiEventParser::capture(const char *const data, const size_t length)
+{
+	switch (m_capture)
+	{
+	case Capture::NONE:
+		break;
+	case Capture::WORD:
+		add_word(data, length);
+		break;
+	case Capture::NUMBER:
+		for (size_t i = 0; i < length && !m_number_done; ++i)
+		{
+			const char c = data[i];
+			if ('0' <= c && c <= '9')
+			{
+				*m_number = *m_number * 10 + (c - '0');
+				m_number_started = true;
+			}
+			else if (m_number_started ||
+					 (' ' != c && '\t' != c && '-' != c && '+' != c))
+			{
+				m_number_done = true;
+			}
+			else if ('-' == c || '+' == c)
+			{
+				m_number_negative = '-' == c;
+				m_number_started = true;
+			}
+		}
+		break;
+	case Capture::TEXT:
+	{
+		const size_t space = MI_EVENT_MAX_TEXT - m_text.size();
+		const size_t taken = length < space ? length : space;
+		m_text.append(data, taken);
+		return Record::STREAM == m_record ? taken : length;
+	}
+	}
+	return length;
+}
+
+/**
+ * This function ends a c-string at its closing quote and continues with the
+ * state behind it.
+ */
+void MiEventParser::end_string()
+{
+	switch (m_capture)
+	{
+	case Capture::WORD:
+		// with more than one reason just the last, like libmigdb
+		m_reason = s_stop_reasons.find(word());
+		break;
+	case Capture::NUMBER:
+		if (m_number_negative)
+		{
+			*m_number = -*m_number;
+		}
+		break;
+	default:
+		break;
+	}
+	// the arguments of the frame end with their string
+	if (FrameCopy::SKIP == m_frame_copy && 1 == m_depth)
+	{
+		m_frame_copy = FrameCopy::COPY;
+		m_frame_from = m_pos;
+	}
+	m_capture = Capture::NONE;
+	m_state = m_after_string;
+}
+
+/**
+ * This function copies the bytes of the current chunk from where the copy
+ * stopped before up to a position into the frame of the stop, as long as the
+ * frame is copied at all. A frame longer than @ref MI_EVENT_MAX_TEXT is
+ * dropped.
+ *
+ * @param[in] end The position in the chunk behind the last byte to copy.
+ */
+void MiEventParser::copy_frame(const char *const end)
+{
+	if (FrameCopy::COPY == m_frame_copy && !m_frame_overflow)
+	{
+		const size_t length = end - m_frame_from;
+		if (MI_EVENT_MAX_TEXT < m_frame.size() + length)
+		{
+			m_frame_overflow = true;
+		}
+		else
+		{
+			m_frame.append(m_frame_from, length);
+		}
+	}
+	m_frame_from = end;
+}
+
+/**
+ * This function starts the value of the current result and decides whether
+ * it is captured, looked into or skipped, like parse_mi_event does.
+ *
+ * @param c The first character of the value, '"', '{' or '['.
+ */
+void MiEventParser::start_value(const char c)
+{
+	const bool top = 0 == m_depth;
+	const bool string = '"' == c;
+	const bool tuple = '{' == c;
+	Capture capture = Capture::NONE;
+	MiKey context = MiKey::UNKNOWN;
+	int *number = nullptr;
+	switch (m_record)
+	{
+	case Record::RESULT:
+		if (top && (MiKey::VALUE == m_key || MiKey::MSG == m_key) && string &&
+			!m_have_value)
+		{
+			m_have_value = true;
+			capture = Capture::TEXT;
+		}
+		else if (top && MiKey::BKPT == m_key && !m_have_bkpt &&
+				 MI_CL_DONE == m_tclass)
+		{
+			m_have_bkpt = true;
+			context = MiKey::BKPT;
+		}
+		else if (!top && MiKey::NUMBER == m_key)
+		{
+			number = &m_bkpt_number;
+		}
+		break;
+	case Record::STOPPED:
+		if (top && MiKey::REASON == m_key && string)
+		{
+			capture = Capture::WORD;
+		}
+		else if (top && MiKey::BKPTNO == m_key && string && !m_have_bkptno)
+		{
+			m_have_bkptno = true;
+			number = &m_bkptno;
+		}
+		else if (top && MiKey::EXIT_CODE == m_key && string &&
+				 !m_have_exit_code)
+		{
+			m_have_exit_code = true;
+			number = &m_exit_code;
+		}
+		else if (top && MiKey::FRAME == m_key && tuple)
+		{
+			// the last frame counts, copied from its opening brace on
+			m_frame.clear();
+			m_frame_overflow = false;
+			m_have_frame = false;
+			m_frame_copy = FrameCopy::COPY;
+			m_frame_from = m_pos - 1;
+			context = MiKey::FRAME;
+		}
+		else if (!top && MiKey::ARGS == m_key &&
+				 FrameCopy::COPY == m_frame_copy)
+		{
+			// the values of the arguments differ between the processes
+			copy_frame(m_pos - 1);
+			if (!m_frame_overflow)
+			{
+				m_frame += "[]";
+			}
+			m_frame_copy = FrameCopy::SKIP;
+		}
+		break;
+	case Record::BREAKPOINT:
+		if (top && MiKey::BKPT == m_key)
+		{
+			context = MiKey::BKPT;
+		}
+		else if ((top && MiKey::ID == m_key) ||
+				 (!top && MiKey::NUMBER == m_key))
+		{
+			number = &m_bkpt_number;
+		}
+		break;
+	default:
+		break;
+	}
+	if (nullptr != number)
+	{
+		if (string)
+		{
+			start_number(number);
+			return;
+		}
+		// like the number of an empty string
+		*number = 0;
+	}
+	if (string)
+	{
+		start_string(capture, State::AFTER_VALUE);
+		return;
+	}
+	push(tuple ? '}' : ']', tuple ? context : MiKey::UNKNOWN);
+}
+
+/**
+ * This function enters a tuple or list. Records nested too deeply are
+ * discarded.
+ *
+ * @param close The closing character, '}' or ']'.
+ *
+ * @param context The key whose results are looked at in a tuple of the
+ * record, MiKey::UNKNOWN to skip them.
+ */
+void MiEventParser::push(const char close, const MiKey context)
+{
+	if (MI_EVENT_MAX_DEPTH == m_depth)
+	{
+		m_state = State::DISCARD;
+		return;
+	}
+	if (0 == m_depth)
+	{
+		m_context = context;
+	}
+	m_stack[m_depth++] = close;
+	m_state = State::OPEN;
+}
+
+/**
+ * This function leaves a tuple or list behind its closing character.
+ */
+void MiEventParser::pop()
+{
+	if (0 == --m_depth)
+	{
+		m_context = MiKey::UNKNOWN;
+		if (FrameCopy::COPY == m_frame_copy)
+		{
+			copy_frame(m_pos);
+			m_frame_copy = FrameCopy::NONE;
+			m_have_frame = !m_frame_overflow;
+		}
+	}
+	// the arguments of the frame end with their list
+	else if (1 == m_depth && FrameCopy::SKIP == m_frame_copy)
+	{
+		m_frame_copy = FrameCopy::COPY;
+		m_frame_from = m_pos;
+	}
+	m_state = State::AFTER_VALUE;
+}
+
+/**
+ * This function turns the record of a completed line into an event.
+ *
+ * @param[out] event The event.
+ *
+ * @return @c true if there is an event, @c false for records of no interest.
+ */
+bool MiEventParser::end_line(MiEvent &event)
+{
+	m_state = State::LINE_START;
+	switch (m_record)
+	{
+	case Record::PROMPT:
+		event = MiPrompt();
+		return true;
+	case Record::STREAM:
+		event = MiStreamText{m_tclass, m_text};
+		return true;
+	case Record::RESULT:
+		event = MiResult{m_tclass,
+						 m_have_value ? string_view(m_text) : string_view(),
+						 m_bkpt_number};
+		return true;
+	case Record::STOPPED:
+		if (sr_exited_signalled == m_reason || sr_exited == m_reason ||
+			sr_exited_normally == m_reason)
+		{
+			event = MiExited{m_reason, m_exit_code};
+		}
+		else
+		{
+			event = MiStopped{m_reason, m_bkptno,
+							  m_have_frame ? string_view(m_frame)
+										   : string_view()};
+		}
+		return true;
+	case Record::RUNNING:
+		event = MiRunning();
+		return true;
+	case Record::BREAKPOINT:
+		if (MI_CL_BREAKPOINT_CREATED == m_tclass)
+		{
+			event = MiBreakpointCreated{m_bkpt_number};
+		}
+		else if (MI_CL_BREAKPOINT_MODIFIED == m_tclass)
+		{
+			event = MiBreakpointModified{m_bkpt_number};
+		}
+		else
+		{
+			event = MiBreakpointDeleted{m_bkpt_number};
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * This function parses the current chunk up to the next event. Every byte is
+ * looked at once; the runs of c-strings are found by mi_scan_chunk and the
+ * rest of lines of no interest by @c memchr, both vectorised. A carriage
+ * return before the line break is ignored, like the trailing one of a line
+ * is by parse_mi_event.
+ *
+ * The strings of the event point into the parser. They are valid until the
+ * next call of this function.
+ *
+ * @param[out] event The next event.
+ *
+ * @return @c true if an event was found, @c false if the chunk is used up.
+ */
+bool MiEventParser::next(MiEvent &event)
+{
+	if (m_text_flushed)
+	{
+		m_text.clear();
+		m_text_flushed = false;
+	}
+	while (m_pos < m_end)
+	{
+		// a step appends at most two bytes to the text
+		if (Record::STREAM == m_record && Capture::TEXT == m_capture &&
+			State::DISCARD != m_state &&
+			MI_EVENT_MAX_TEXT - 1 <= m_text.size())
+		{
+			event = MiStreamText{m_tclass, m_text};
+			m_text_flushed = true;
+			return true;
+		}
+		const char c = *m_pos;
+		switch (m_state)
+		{
+		case State::LINE_START:
+			++m_pos;
+			if ('\n' == c)
+			{
+				break;
+			}
+			start_record();
+			m_type = c;
+			switch (c)
+			{
+			case '(':
+				m_word_length = 1;
+				m_state = State::PROMPT;
+				break;
+			case '~':
+			case '@':
+			case '&':
+				m_record = Record::STREAM;
+				m_tclass = '~' == c   ? MI_SST_CONSOLE
+						   : '@' == c ? MI_SST_TARGET
+									  : MI_SST_LOG;
+				m_state = State::STREAM_OPEN;
+				break;
+			case '^':
+			case '*':
+			case '=':
+				m_word_length = 0;
+				m_state = State::CLASS;
+				break;
+			default:
+				--m_pos;
+				m_state = State::DISCARD;
+				break;
+			}
+			break;
+		case State::PROMPT:
+			if (s_prompt[m_word_length] != c)
+			{
+				m_state = State::DISCARD;
+				break;
+			}
+			++m_pos;
+			if (s_prompt.size() == ++m_word_length)
+			{
+				m_record = Record::PROMPT;
+				m_state = State::TRAILER;
+			}
+			break;
+		case State::CLASS:
+		{
+			const char *end = m_pos;
+			while (end < m_end && ',' != *end && '\n' != *end && '\r' != *end)
+			{
+				++end;
+			}
+			add_word(m_pos, end - m_pos);
+			m_pos = end;
+			if (m_end == end)
+			{
+				break;
+			}
+			if ('\r' == *end)
+			{
+				++m_pos;
+				m_cr_from = State::CLASS;
+				m_state = State::CR;
+				break;
+			}
+			const string_view name = word();
+			if ('^' == m_type)
+			{
+				m_tclass = s_result_classes.find(name);
+				if (MI_CL_UNKNOWN != m_tclass)
+				{
+					m_record = Record::RESULT;
+				}
+			}
+			else
+			{
+				m_tclass = s_async_classes.find(name);
+				if ('*' == m_type && MI_CL_STOPPED == m_tclass)
+				{
+					m_record = Record::STOPPED;
+				}
+				else if ('*' == m_type && MI_CL_RUNNING == m_tclass)
+				{
+					m_record = Record::RUNNING;
+				}
+				else if ('=' == m_type &&
+						 (MI_CL_BREAKPOINT_CREATED == m_tclass ||
+						  MI_CL_BREAKPOINT_MODIFIED == m_tclass ||
+						  MI_CL_BREAKPOINT_DELETED == m_tclass))
+				{
+					m_record = Record::BREAKPOINT;
+				}
+			}
+			// the separator is looked at again
+			m_state = Record::NONE == m_record	  ? State::DISCARD
+					  : Record::RUNNING == m_record ? State::TRAILER
+													: State::AFTER_VALUE;
+			break;
+		}
+		case State::STREAM_OPEN:
+			if ('"' != c)
+			{
+				m_state = State::DISCARD;
+				break;
+			}
+			++m_pos;
+			start_string(Capture::TEXT, State::TRAILER);
+			break;
+		case State::STRING:
+			// escapes and quotes followed by their next byte in the chunk are
+			// handled right here, the states are for those split by a chunk
+			while (State::STRING == m_state)
+			{
+				const char *const stop = mi_scan_chunk(m_pos, m_end);
+				m_pos = Capture::NONE == m_capture
+							? stop
+							: m_pos + capture(m_pos, stop - m_pos);
+				if (m_pos != stop || m_end == stop)
+				{
+					break;
+				}
+				if ('\n' == *stop)
+				{
+					m_state = State::DISCARD;
+				}
+				else if (m_end == stop + 1)
+				{
+					++m_pos;
+					m_state = '"' == *stop ? State::STRING_QUOTE
+										   : State::STRING_ESCAPE;
+				}
+				else if ('\\' == *stop)
+				{
+					const char next = stop[1];
+					const char unescaped =
+						'n' == next ? '\n' : 't' == next ? '\t' : next;
+					if ('\n' == next)
+					{
+						++m_pos;
+						m_state = State::DISCARD;
+					}
+					else if (0 != capture(&unescaped, 1))
+					{
+						m_pos += 2;
+					}
+					else
+					{
+						break;
+					}
+				}
+				else
+				{
+					const char next = stop[1];
+					if (',' == next || ']' == next || '}' == next ||
+						'\n' == next)
+					{
+						++m_pos;
+						end_string();
+					}
+					else if ('\r' == next)
+					{
+						++m_pos;
+						m_state = State::STRING_QUOTE;
+					}
+					else if (0 != capture("\"", 1))
+					{
+						++m_pos;
+					}
+					else
+					{
+						break;
+					}
+				}
+			}
+			// a value ended, like most strings do
+			if (State::AFTER_VALUE != m_state)
+			{
+				break;
+			}
+			[[fallthrough]];
+		case State::AFTER_VALUE:
+		{
+			const char separator = *m_pos;
+			if (',' != separator)
+			{
+				if (0 < m_depth && m_stack[m_depth - 1] == separator)
+				{
+					++m_pos;
+					pop();
+				}
+				else if (0 == m_depth && '\n' == separator)
+				{
+					++m_pos;
+					if (end_line(event))
+					{
+						return true;
+					}
+				}
+				else if (0 == m_depth && '\r' == separator)
+				{
+					++m_pos;
+					m_cr_from = State::AFTER_VALUE;
+					m_state = State::CR;
+				}
+				else
+				{
+					m_state = State::DISCARD;
+				}
+				break;
+			}
+			++m_pos;
+			if (!named())
+			{
+				m_state = State::ELEMENT;
+				break;
+			}
+			// the next result is parsed on while the chunk lasts
+			m_state = State::KEY_START;
+			if (m_end == m_pos)
+			{
+				break;
+			}
+		}
+			[[fallthrough]];
+		case State::KEY_START:
+			if ('"' == *m_pos)
+			{
+				++m_pos;
+				start_string(Capture::NONE, State::AFTER_PREFIX);
+				break;
+			}
+			m_word_length = 0;
+			m_state = State::KEY;
+			[[fallthrough]];
+		case State::KEY:
+		{
+			const char *end = m_pos;
+			while (end < m_end && is_name_char(*end))
+			{
+				++end;
+			}
+			add_word(m_pos, end - m_pos);
+			m_pos = end;
+			if (m_end == end)
+			{
+				break;
+			}
+			if ('=' != *end)
+			{
+				m_state = State::DISCARD;
+				break;
+			}
+			++m_pos;
+			m_key = named() ? s_keys.find(word()) : MiKey::UNKNOWN;
+			m_state = State::VALUE;
+			if (m_end == m_pos)
+			{
+				break;
+			}
+		}
+			[[fallthrough]];
+		case State::VALUE:
+		{
+			const char first = *m_pos;
+			if ('"' != first && '{' != first && '[' != first)
+			{
+				m_state = State::DISCARD;
+				break;
+			}
+			++m_pos;
+			start_value(first);
+			break;
+		}
+		case State::AFTER_PREFIX:
+			if (',' != c)
+			{
+				m_state = State::DISCARD;
+				break;
+			}
+			++m_pos;
+			m_word_length = 0;
+			m_state = State::KEY;
+			break;
+		case State::ELEMENT:
+			if ('"' == c || '{' == c || '[' == c)
+			{
+				m_key = MiKey::UNKNOWN;
+				m_state = State::VALUE;
+				break;
+			}
+			m_word_length = 0;
+			m_state = State::KEY;
+			break;
+		case State::OPEN:
+			if (m_stack[m_depth - 1] == c)
+			{
+				++m_pos;
+				pop();
+				break;
+			}
+			m_state = named() ? State::KEY_START : State::ELEMENT;
+			break;
+		case State::STRING_ESCAPE:
+		{
+			if ('\n' == c)
+			{
+				m_state = State::DISCARD;
+				break;
+			}
+			const char unescaped = 'n' == c ? '\n' : 't' == c ? '\t' : c;
+			capture(&unescaped, 1);
+			++m_pos;
+			m_state = State::STRING;
+			break;
+		}
+		case State::STRING_QUOTE:
+			// GDB does not always escape quotes, see scan_string
+			if (',' == c || ']' == c || '}' == c || '\n' == c)
+			{
+				end_string();
+			}
+			else if ('\r' == c)
+			{
+				++m_pos;
+				m_cr_from = State::STRING_QUOTE;
+				m_state = State::CR;
+			}
+			else
+			{
+				capture("\"", 1);
+				m_state = State::STRING;
+			}
+			break;
+		case State::CR:
+			if ('\n' == c)
+			{
+				m_state = m_cr_from;
+			}
+			else if (State::CLASS == m_cr_from)
+			{
+				add_word("\r", 1);
+				m_state = State::CLASS;
+			}
+			else if (State::STRING_QUOTE == m_cr_from)
+			{
+				capture("\"\r", 2);
+				m_state = State::STRING;
+			}
+			else
+			{
+				m_state = State::DISCARD;
+			}
+			break;
+		case State::TRAILER:
+		case State::DISCARD:
+		{
+			const char *const newline =
+				(const char *)memchr(m_pos, '\n', m_end - m_pos);
+			if (nullptr == newline)
+			{
+				m_pos = m_end;
+				break;
+			}
+			m_pos = newline + 1;
+			if (State::DISCARD == m_state)
+			{
+				m_state = State::LINE_START;
+			}
+			else if (end_line(event))
+			{
+				return true;
+			}
+			break;
+		}
+		}
+	}
+	// a frame continues in the next chunk
+	copy_frame(m_end);
+	return false;
+}
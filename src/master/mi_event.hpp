@@ -0,0 +1,410 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file mi_event.hpp
+ *
+ * @brief Header file for the typed GDB/MI events.
+ *
+ * This is the header file for the typed GDB/MI events, the KeywordTable class,
+ * the line-based event parser and the MiEventParser class.
+ */
+
+#ifndef MI_EVENT_HPP
+#define MI_EVENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "mi_gdb.h"
+
+/// A keyword and the value it maps to.
+template <typename Value>
+struct Keyword
+{
+	std::string_view word = std::string_view();
+	Value value = Value();
+};
+
+/// Maps keywords to values with a perfect hash built at compile time.
+/**
+ * This class maps a fixed set of keywords to values. The constructor searches
+ * a seed for which the hash of every keyword falls into its own slot, so a
+ * lookup hashes the word once and compares it with the single keyword of its
+ * slot. Constructed as a @c constexpr variable, the seed search runs at
+ * compile time and @c perfect can be checked by a @c static_assert.
+ *
+ * @tparam Value The type of the values.
+ *
+ * @tparam SIZE The number of slots, at least the number of keywords.
+ */
+template <typename Value, std::size_t SIZE>
+class KeywordTable
+{
+	Keyword<Value> m_slots[SIZE];
+	Value m_none;
+	std::uint32_t m_seed;
+	bool m_perfect;
+
+	/// Hashes a word. (FNV-1a)
+	static constexpr std::size_t hash(const std::string_view word,
+									  const std::uint32_t seed)
+	{
+		std::uint32_t value = 2166136261u ^ seed;
+		for (const char c : word)
+		{
+			value = (value ^ (unsigned char)c) * 16777619u;
+		}
+		return (value ^ (value >> 16)) % SIZE;
+	}
+
+public:
+	/// Default constructor.
+	/**
+	 * This constructor places the keywords in the slots.
+	 *
+	 * @param[in] keywords The keywords.
+	 *
+	 * @param none The value returned for unknown words.
+	 */
+	template <std::size_t N>
+	constexpr KeywordTable(const Keyword<Value> (&keywords)[N],
+						   const Value none)
+		: m_slots(), m_none(none), m_seed(0), m_perfect(false)
+	{
+		static_assert(N <= SIZE, "more keywords than slots");
+		for (std::uint32_t seed = 0; !m_perfect && seed < 1000; ++seed)
+		{
+			m_seed = seed;
+			for (Keyword<Value> &slot : m_slots)
+			{
+				slot = Keyword<Value>{std::string_view(), none};
+			}
+			m_perfect = true;
+			for (const Keyword<Value> &keyword : keywords)
+			{
+				Keyword<Value> &slot = m_slots[hash(keyword.word, m_seed)];
+				if (!slot.word.empty())
+				{
+					m_perfect = false;
+					break;
+				}
+				slot = keyword;
+			}
+		}
+	}
+
+	/// Returns the value of a word.
+	/**
+	 * This function returns the value of a word.
+	 *
+	 * @param word The word.
+	 *
+	 * @return The value of the word, or the value for unknown words.
+	 */
+	constexpr Value find(const std::string_view word) const
+	{
+		const Keyword<Value> &slot = m_slots[hash(word, m_seed)];
+		return slot.word == word ? slot.value : m_none;
+	}
+
+	/// Returns whether every keyword has its own slot.
+	constexpr bool perfect() const
+	{
+		return m_perfect;
+	}
+};
+
+/// A stop of the target, *stopped.
+struct MiStopped
+{
+	/** The reason of the stop. */
+	mi_stop_reason reason;
+	/** The number of the breakpoint hit, or 0 if none. */
+	int bkptno;
+	/** The text of the frame tuple, braces included, or empty if none. Its
+	 * location is extracted by parse_mi_frame. */
+	std::string_view frame;
+};
+
+/// The location of a stop, extracted from its frame.
+struct MiFrame
+{
+	/** The source file, or empty if unknown. */
+	std::string_view fullname;
+	/** The line. (one-based) */
+	int line;
+	/** The function, or empty if unknown. */
+	std::string_view func;
+};
+
+/// The exit of the target, *stopped with an exited reason.
+struct MiExited
+{
+	/** The reason of the exit. */
+	mi_stop_reason reason;
+	/** The exit code, 0 if the target was signalled or exited normally. */
+	int exit_code;
+};
+
+/// The target is running, *running.
+struct MiRunning
+{
+};
+
+/// A breakpoint was created, =breakpoint-created.
+struct MiBreakpointCreated
+{
+	/** The number of the breakpoint. */
+	int number;
+};
+
+/// A breakpoint was modified, e.g. hit, =breakpoint-modified.
+struct MiBreakpointModified
+{
+	/** The number of the breakpoint. */
+	int number;
+};
+
+/// A breakpoint was deleted, =breakpoint-deleted.
+struct MiBreakpointDeleted
+{
+	/** The number of the breakpoint. */
+	int number;
+};
+
+/// The text of a stream record, ~, @ or &.
+struct MiStreamText
+{
+	/** The stream, MI_SST_CONSOLE, MI_SST_TARGET or MI_SST_LOG. */
+	int stream;
+	/** The unescaped text. */
+	std::string_view text;
+};
+
+/// A result record, completing a command.
+struct MiResult
+{
+	/** The result class, MI_CL_DONE, MI_CL_RUNNING, MI_CL_ERROR, ... */
+	int tclass;
+	/** The value or error message, or empty if none. */
+	std::string_view value;
+	/** The number of the breakpoint inserted by the command, or 0. */
+	int bkpt_number;
+};
+
+/// The prompt, ending a response.
+struct MiPrompt
+{
+};
+
+/// A line of GDB/MI output. Lines of no interest are a std::monostate.
+typedef std::variant<std::monostate, MiPrompt, MiResult, MiRunning, MiStopped,
+					 MiExited, MiBreakpointCreated, MiBreakpointModified,
+					 MiBreakpointDeleted, MiStreamText>
+	MiEvent;
+
+/// Parses a line of GDB/MI output into an event.
+MiEvent parse_mi_event(char *const line);
+/// Extracts the location of a stop from the text of its frame.
+bool parse_mi_frame(char *const frame, MiFrame &location);
+
+/// The maximum length of the strings of an event in bytes.
+#define MI_EVENT_MAX_TEXT 16384
+/// The maximum nesting depth of tuples and lists.
+#define MI_EVENT_MAX_DEPTH 64
+/// The maximum length of result names, classes and stop reasons in bytes.
+#define MI_EVENT_MAX_WORD 32
+
+/// The keys of the results the events are built from.
+enum class MiKey : unsigned char
+{
+	UNKNOWN,
+	REASON,
+	BKPTNO,
+	EXIT_CODE,
+	FRAME,
+	ARGS,
+	FULLNAME,
+	LINE,
+	FUNC,
+	BKPT,
+	NUMBER,
+	ID,
+	VALUE,
+	MSG
+};
+
+/// Parses a stream of GDB/MI output into events, chunk by chunk.
+/**
+ * This class parses the GDB output of one process as it is received by
+ * @c read_some, in chunks which may end anywhere in a record. It is a state
+ * machine over the bytes of the stream: every byte is looked at once, the
+ * state is kept across chunks and a record is turned into an event as soon as
+ * its line is complete. Lines are neither framed nor copied, only the values
+ * needed for the events are, so memory use is bounded independently of the
+ * length of the lines.
+ *
+ * The frame of a stop is copied as it is, only its arguments are replaced by
+ * an empty list, as their values differ between processes. Its location is
+ * not extracted here, so a stop at a known frame costs no more than the copy,
+ * see FrameCache.
+ *
+ * The events equal those of parse_mi_event for the lines of the stream, the
+ * frames compared by their location, with three exceptions: values longer than @ref MI_EVENT_MAX_TEXT are truncated,
+ * frames longer than that are dropped, and stream text longer than that is
+ * split into several events, the first ones emitted before the end of the
+ * record. Records nested deeper than @ref MI_EVENT_MAX_DEPTH are dropped as
+ * malformed.
+ */
+class MiEventParser
+{
+	/// The states of the parser, what the next byte is expected to be.
+	enum class State : unsigned char
+	{
+		LINE_START,
+		PROMPT,
+		CLASS,
+		STREAM_OPEN,
+		KEY_START,
+		AFTER_PREFIX,
+		KEY,
+		VALUE,
+		ELEMENT,
+		OPEN,
+		AFTER_VALUE,
+		STRING,
+		STRING_ESCAPE,
+		STRING_QUOTE,
+		TRAILER,
+		CR,
+		DISCARD
+	};
+
+	/// The kinds of records.
+	enum class Record : unsigned char
+	{
+		NONE,
+		PROMPT,
+		STREAM,
+		RESULT,
+		STOPPED,
+		RUNNING,
+		BREAKPOINT
+	};
+
+	/// Where the bytes of the current string go.
+	enum class Capture : unsigned char
+	{
+		NONE,
+		WORD,
+		NUMBER,
+		TEXT
+	};
+
+	/// What happens to the bytes of the stream in the frame of a stop.
+	enum class FrameCopy : unsigned char
+	{
+		NONE,
+		COPY,
+		SKIP
+	};
+
+	const char *m_pos;
+	const char *m_end;
+	State m_state;
+	State m_after_string;
+	State m_cr_from;
+	Capture m_capture;
+	bool m_text_flushed;
+
+	// the record
+	Record m_record;
+	char m_type;
+	int m_tclass;
+	MiKey m_key;
+	MiKey m_context;
+	char m_stack[MI_EVENT_MAX_DEPTH];
+	int m_depth;
+
+	// the captured values
+	char m_word[MI_EVENT_MAX_WORD];
+	std::size_t m_word_length;
+	int *m_number;
+	bool m_number_started;
+	bool m_number_negative;
+	bool m_number_done;
+	std::string m_text;
+	std::string m_frame;
+	FrameCopy m_frame_copy;
+	const char *m_frame_from;
+	bool m_frame_overflow;
+
+	// the fields of the event
+	bool m_have_value;
+	bool m_have_bkpt;
+	bool m_have_bkptno;
+	bool m_have_exit_code;
+	bool m_have_frame;
+	mi_stop_reason m_reason;
+	int m_bkptno;
+	int m_exit_code;
+	int m_bkpt_number;
+
+	/// Forgets the previous record.
+	void start_record();
+	/// Returns whether the results at the current depth are looked at.
+	bool named() const;
+	/// Appends characters to the current word.
+	void add_word(const char *const data, const std::size_t length);
+	/// Returns the current word, empty if it is too long.
+	std::string_view word() const;
+	/// Starts a c-string.
+	void start_string(const Capture capture, const State after);
+	/// Starts a c-string holding a number.
+	void start_number(int *const target);
+	/// Passes bytes of a c-string to its capture.
+	std::size_t capture(const char *const data, const std::size_t length);
+	/// Ends a c-string.
+	void end_string();
+	/// Copies the bytes of the chunk up to a position into the frame.
+	void copy_frame(const char *const end);
+	/// Starts the value of a result.
+	void start_value(const char c);
+	/// Enters a tuple or list.
+	void push(const char close, const MiKey context);
+	/// Leaves a tuple or list.
+	void pop();
+	/// Turns the completed record into an event.
+	bool end_line(MiEvent &event);
+
+public:
+	/// Default constructor.
+	MiEventParser();
+
+	/// Sets the next chunk to be parsed.
+	void feed(const char *const data, const std::size_t length);
+	/// Returns the next event.
+	bool next(MiEvent &event);
+};
+
+#endif /* MI_EVENT_HPP */
@@ -0,0 +1,948 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file overview.cpp
+ *
+ * @brief Contains the implementation of the UIOverview class.
+ *
+ * This file contains the implementation of the UIOverview class.
+ */
+
+#include <gtkmm.h>
+#include <algorithm>
+#include <string>
+
+#include "overview.hpp"
+#include "canvas.hpp"
+#include "intern_table.hpp"
+
+using std::string;
+
+const int UIOverview::s_name_width = 100;
+const int UIOverview::s_row_height = 24;
+const int UIOverview::s_padding = 3;
+
+const int UIOverview::s_num_zoom_levels = 10;
+const int UIOverview::s_default_zoom_level = 8;
+const int UIOverview::s_cell_widths[] = {2, 3, 4, 6, 8, 12, 16, 24, 35, 48};
+
+/**
+ * This is the default constructor. No process is in a file yet and there are
+ * no rows for source files.
+ *
+ * @param num_processes The total number of processes.
+ *
+ * @param[in] strings The table of the interned file paths and function names.
+ *
+ * @param[in] source_line The function returning the text of a line in a source
+ * file, shown in the tooltips.
+ */
+UIOverview::UIOverview(
+	const int num_processes, InternTable *const strings,
+	const std::function<string(const int file, const int line)> &source_line)
+	: m_num_processes(num_processes),
+	  m_strings(strings),
+	  m_source_line(source_line),
+	  m_files(new int[m_num_processes]()),
+	  m_funcs(new int[m_num_processes]()),
+	  m_lines(new int[m_num_processes]()),
+	  m_states(new TargetState[m_num_processes]()),
+	  m_exit_codes(new int[m_num_processes]()),
+	  m_colored_files(new int[m_num_processes]()),
+	  m_colored_lines(new int[m_num_processes]()),
+	  m_dirty(new bool[m_num_processes]()),
+	  m_zoom_level(s_default_zoom_level),
+	  m_grouped(false),
+	  m_char_width(1),
+	  m_char_height(0)
+{
+	add_events(Gdk::SCROLL_MASK | Gdk::SMOOTH_SCROLL_MASK);
+	set_has_tooltip(true);
+	update_size();
+}
+
+/**
+ * This function deallocates the state of the processes.
+ */
+UIOverview::~UIOverview()
+{
+	delete[] m_files;
+	delete[] m_funcs;
+	delete[] m_lines;
+	delete[] m_states;
+	delete[] m_exit_codes;
+	delete[] m_colored_files;
+	delete[] m_colored_lines;
+	delete[] m_dirty;
+}
+
+/**
+ * This function returns the width of a process column for the current zoom
+ * level.
+ *
+ * @return The width in pixels.
+ */
+int UIOverview::cell_width() const
+{
+	return s_cell_widths[m_zoom_level];
+}
+
+/**
+ * This function returns the number of rows, the fixed ones included.
+ *
+ * @return The number of rows.
+ */
+int UIOverview::num_rows() const
+{
+	return FIRST_FILE_ROW + (int)m_row_files.size();
+}
+
+/**
+ * This function returns the row of a source file.
+ *
+ * @param file The interned full path of the source file.
+ *
+ * @return The row, or @c -1 if the file has no row.
+ */
+int UIOverview::file_row(const int file) const
+{
+	if (INTERN_NONE == file)
+	{
+		return -1;
+	}
+	for (std::size_t idx = 0; idx < m_row_files.size(); ++idx)
+	{
+		if (m_row_files[idx] == file)
+		{
+			return FIRST_FILE_ROW + (int)idx;
+		}
+	}
+	return -1;
+}
+
+/**
+ * This function gets the content of a cell. This is the line number in a
+ * source file row and the exit code in the exited row.
+ *
+ * @param row The row, not the row of the process ranks.
+ *
+ * @param rank The process rank.
+ *
+ * @param[out] value The content of the cell.
+ *
+ * @return @c true if the cell is not empty.
+ */
+bool UIOverview::cell(const int row, const int rank, int &value) const
+{
+	value = 0;
+	if (RUNNING_ROW == row)
+	{
+		return TargetState::RUNNING == m_states[rank];
+	}
+	if (EXITED_ROW == row)
+	{
+		value = m_exit_codes[rank];
+		return TargetState::EXITED == m_states[rank];
+	}
+	value = m_lines[rank];
+	return m_files[rank] == m_row_files[row - FIRST_FILE_ROW];
+}
+
+/**
+ * This function finds the range of adjacent processes around a process, whose
+ * cells in a row have the same content.
+ *
+ * @param row The row.
+ *
+ * @param rank The process rank, its cell must not be empty.
+ *
+ * @param value The content of the cell.
+ *
+ * @param[out] first The first process rank of the range.
+ *
+ * @param[out] last The last process rank of the range.
+ */
+void UIOverview::find_range(const int row, const int rank, const int value,
+							int &first, int &last) const
+{
+	int other;
+	first = rank;
+	while (first > 0 && cell(row, first - 1, other) && other == value)
+	{
+		--first;
+	}
+	last = rank;
+	while (last + 1 < m_num_processes && cell(row, last + 1, other) &&
+		   other == value)
+	{
+		++last;
+	}
+}
+
+/**
+ * This function returns the text of a cell, as shown in the cell.
+ *
+ * @param row The row.
+ *
+ * @param value The content of the cell.
+ *
+ * @return The text.
+ */
+string UIOverview::cell_text(const int row, const int value) const
+{
+	if (RUNNING_ROW == row)
+	{
+		return "R";
+	}
+	return std::to_string(value);
+}
+
+/**
+ * This function returns the text of a range of cells, for example
+ * "ranks 0-511: line 42".
+ *
+ * @param row The row.
+ *
+ * @param first The first process rank of the range.
+ *
+ * @param last The last process rank of the range.
+ *
+ * @param value The content of the cells.
+ *
+ * @return The text.
+ */
+string UIOverview::range_text(const int row, const int first, const int last,
+							  const int value) const
+{
+	string text;
+	if (first == last)
+	{
+		text = "rank " + std::to_string(first) + ": ";
+	}
+	else
+	{
+		text = "ranks " + std::to_string(first) + "-" + std::to_string(last) +
+			   ": ";
+	}
+	if (RUNNING_ROW == row)
+	{
+		return text + "running";
+	}
+	if (EXITED_ROW == row)
+	{
+		return text + "exit code " + std::to_string(value);
+	}
+	return text + "line " + std::to_string(value);
+}
+
+/**
+ * This function sets the color of a cell as the source of a Cairo context.
+ * Source file cells get the color of their line, see @ref color, lines
+ * without a color and running processes are gray. Exit codes other than zero
+ * are highlighted in red. A cell with text is filled lighter, so that the text
+ * stays readable.
+ *
+ * @param[in] c The Cairo context.
+ *
+ * @param row The row.
+ *
+ * @param value The content of the cell.
+ *
+ * @param has_text Whether the text is drawn on top of the cell.
+ */
+void UIOverview::set_cell_color(const Cairo::RefPtr<Cairo::Context> &c,
+								const int row, const int value,
+								const bool has_text) const
+{
+	const double alpha = has_text ? 0.35 : 1.0;
+	int slot = UIDrawingArea::NUM_COLORS;
+	if (EXITED_ROW == row && 0 != value)
+	{
+		slot = 0;
+	}
+	else if (row >= FIRST_FILE_ROW)
+	{
+		std::map<int, FileColors>::const_iterator file_it =
+			m_file_colors.find(m_row_files[row - FIRST_FILE_ROW]);
+		if (file_it != m_file_colors.end())
+		{
+			std::map<int, LineColor>::const_iterator line_it =
+				file_it->second.lines.find(value);
+			if (line_it != file_it->second.lines.end())
+			{
+				slot = line_it->second.slot;
+			}
+		}
+	}
+	if (slot < UIDrawingArea::NUM_COLORS)
+	{
+		const Gdk::RGBA &color = UIDrawingArea::s_colors[slot];
+		c->set_source_rgba(color.get_red(), color.get_green(),
+						   color.get_blue(), alpha);
+	}
+	else
+	{
+		c->set_source_rgba(0.5, 0.5, 0.5, alpha);
+	}
+}
+
+/**
+ * This function marks a process to be recolored and its column to be redrawn.
+ * The first process marked after a frame adds a tick callback, so that all
+ * changes until the next frame are handled together. See @ref recolor.
+ *
+ * @param rank The process rank.
+ */
+void UIOverview::mark_dirty(const int rank)
+{
+	if (m_dirty[rank])
+	{
+		return;
+	}
+	if (m_dirty_ranks.empty())
+	{
+		add_tick_callback(sigc::mem_fun(*this, &UIOverview::recolor));
+	}
+	m_dirty[rank] = true;
+	m_dirty_ranks.push_back(rank);
+}
+
+/**
+ * This function removes a process from the color of the line it was counted
+ * in. The color of a line is released when the last process leaves it.
+ *
+ * @param rank The process rank.
+ */
+void UIOverview::uncolor(const int rank)
+{
+	const int file = m_colored_files[rank];
+	if (INTERN_NONE == file)
+	{
+		return;
+	}
+	m_colored_files[rank] = INTERN_NONE;
+	FileColors &file_colors = m_file_colors[file];
+	std::map<int, LineColor>::iterator it =
+		file_colors.lines.find(m_colored_lines[rank]);
+	if (0 != --it->second.count)
+	{
+		return;
+	}
+	if (it->second.slot < UIDrawingArea::NUM_COLORS)
+	{
+		file_colors.used_slots &= ~(1u << it->second.slot);
+	}
+	file_colors.lines.erase(it);
+	if (file_colors.lines.empty())
+	{
+		m_file_colors.erase(file);
+	}
+}
+
+/**
+ * This function counts a process in the color of its current line. A line
+ * without processes gets the first free color of its file, or none if all
+ * colors are in use. A line keeps its color as long as processes are in it,
+ * so the colors of the other processes do not change when one moves.
+ *
+ * The coloring is independent from file to file (row to row).
+ *
+ * @param rank The process rank.
+ */
+void UIOverview::color(const int rank)
+{
+	const int file = m_files[rank];
+	if (INTERN_NONE == file)
+	{
+		return;
+	}
+	m_colored_files[rank] = file;
+	m_colored_lines[rank] = m_lines[rank];
+	FileColors &file_colors = m_file_colors[file];
+	std::map<int, LineColor>::iterator it =
+		file_colors.lines.find(m_lines[rank]);
+	if (it != file_colors.lines.end())
+	{
+		++it->second.count;
+		return;
+	}
+	int slot = 0;
+	while (slot < UIDrawingArea::NUM_COLORS &&
+		   (file_colors.used_slots & (1u << slot)))
+	{
+		++slot;
+	}
+	if (slot < UIDrawingArea::NUM_COLORS)
+	{
+		file_colors.used_slots |= 1u << slot;
+	}
+	file_colors.lines[m_lines[rank]] = LineColor{slot, 1};
+}
+
+/**
+ * This function recolors the processes marked dirty since the last frame and
+ * redraws their columns, adjacent columns as one area. In grouped mode a
+ * change affects the whole range around a process, so everything is redrawn.
+ * It is called by Gtk before the frame is drawn. See @ref mark_dirty.
+ *
+ * @return @c false, to remove the tick callback.
+ */
+bool UIOverview::recolor(const Glib::RefPtr<Gdk::FrameClock> &)
+{
+	std::sort(m_dirty_ranks.begin(), m_dirty_ranks.end());
+	const int width = cell_width();
+	const int height = num_rows() * s_row_height;
+	std::size_t idx = 0;
+	while (idx < m_dirty_ranks.size())
+	{
+		const int first = m_dirty_ranks[idx];
+		int last = first;
+		while (idx < m_dirty_ranks.size() && m_dirty_ranks[idx] <= last + 1)
+		{
+			const int rank = m_dirty_ranks[idx++];
+			uncolor(rank);
+			color(rank);
+			m_dirty[rank] = false;
+			last = rank;
+		}
+		if (!m_grouped)
+		{
+			queue_draw_area(s_name_width + first * width, 0,
+							(last - first + 1) * width, height);
+		}
+	}
+	m_dirty_ranks.clear();
+	if (m_grouped)
+	{
+		queue_draw();
+	}
+	return false;
+}
+
+/**
+ * This function requests the size needed for all columns and rows. The
+ * scrolled window containing the Overview scrolls to the rest.
+ */
+void UIOverview::update_size()
+{
+	set_size_request(s_name_width + m_num_processes * cell_width(),
+					 num_rows() * s_row_height);
+}
+
+/**
+ * This function checks whether a text fits into a width. The font is
+ * monospaced, so the width of a text follows from its length.
+ *
+ * @param[in] text The text.
+ *
+ * @param width The width in pixels.
+ *
+ * @return @c true if the text fits.
+ */
+bool UIOverview::fits(const string &text, const int width) const
+{
+	return (int)text.size() * m_char_width + 2 * s_padding <= width;
+}
+
+/**
+ * This function draws a text clipped to a rectangle in a row.
+ *
+ * @param[in] c The Cairo context.
+ *
+ * @param[in] layout The Pango layout to draw the text with.
+ *
+ * @param[in] text The text.
+ *
+ * @param x The left edge of the rectangle.
+ *
+ * @param y The top edge of the row.
+ *
+ * @param width The width of the rectangle.
+ *
+ * @param center Whether the text is centered in the rectangle, if it fits.
+ */
+void UIOverview::draw_text(const Cairo::RefPtr<Cairo::Context> &c,
+						   Glib::RefPtr<Pango::Layout> &layout,
+						   const string &text, const int x, const int y,
+						   const int width, const bool center)
+{
+	const int text_width = (int)text.size() * m_char_width;
+	int text_x = x + s_padding;
+	if (center && fits(text, width))
+	{
+		text_x = x + (width - text_width) / 2;
+	}
+	layout->set_text(text);
+	c->save();
+	c->rectangle(x, y, width, s_row_height);
+	c->clip();
+	Gdk::Cairo::set_source_rgba(c, m_text_color);
+	c->move_to(text_x, y + (s_row_height - m_char_height) / 2);
+	layout->show_in_cairo_context(c);
+	c->restore();
+}
+
+/**
+ * This function draws the names of the rows in the leftmost column. Source
+ * file rows show the basename of the file.
+ *
+ * @param[in] c The Cairo context.
+ *
+ * @param[in] layout The Pango layout to draw the text with.
+ *
+ * @param first_row The first row in the clip area.
+ *
+ * @param last_row The last row in the clip area.
+ */
+void UIOverview::draw_names(const Cairo::RefPtr<Cairo::Context> &c,
+							Glib::RefPtr<Pango::Layout> &layout,
+							const int first_row, const int last_row)
+{
+	for (int row = first_row; row <= last_row; ++row)
+	{
+		string name;
+		if (RANK_ROW == row)
+		{
+			name = "Process";
+		}
+		else if (RUNNING_ROW == row)
+		{
+			name = "Running";
+		}
+		else if (EXITED_ROW == row)
+		{
+			name = "Exited";
+		}
+		else
+		{
+			name = Glib::path_get_basename(
+				m_strings->str(m_row_files[row - FIRST_FILE_ROW]));
+		}
+		draw_text(c, layout, name, 0, row * s_row_height, s_name_width, false);
+	}
+}
+
+/**
+ * This function draws the process ranks. If the columns are too narrow for
+ * the ranks, only every n-th rank is drawn.
+ *
+ * @param[in] c The Cairo context.
+ *
+ * @param[in] layout The Pango layout to draw the text with.
+ *
+ * @param first_rank The first process rank in the clip area.
+ *
+ * @param last_rank The last process rank in the clip area.
+ */
+void UIOverview::draw_ranks(const Cairo::RefPtr<Cairo::Context> &c,
+							Glib::RefPtr<Pango::Layout> &layout,
+							const int first_rank, const int last_rank)
+{
+	const int width = cell_width();
+	const int label_width =
+		(int)std::to_string(m_num_processes - 1).size() * m_char_width +
+		2 * s_padding;
+	const int every = (label_width + width - 1) / width;
+	for (int rank = first_rank - first_rank % every; rank <= last_rank;
+		 rank += every)
+	{
+		draw_text(c, layout, std::to_string(rank), s_name_width + rank * width,
+				  RANK_ROW * s_row_height, every * width, 1 == every);
+	}
+}
+
+/**
+ * This function draws the cells of a row, one per process. The text of a cell
+ * is left out if it does not fit, then only the color remains.
+ *
+ * @param[in] c The Cairo context.
+ *
+ * @param[in] layout The Pango layout to draw the text with.
+ *
+ * @param row The row.
+ *
+ * @param first_rank The first process rank in the clip area.
+ *
+ * @param last_rank The last process rank in the clip area.
+ */
+void UIOverview::draw_cells(const Cairo::RefPtr<Cairo::Context> &c,
+							Glib::RefPtr<Pango::Layout> &layout,
+							const int row, const int first_rank,
+							const int last_rank)
+{
+	const int width = cell_width();
+	const int gap = width > 4 ? 1 : 0;
+	const int y = row * s_row_height;
+	for (int rank = first_rank; rank <= last_rank; ++rank)
+	{
+		int value;
+		if (!cell(row, rank, value))
+		{
+			continue;
+		}
+		const int x = s_name_width + rank * width;
+		const string text = cell_text(row, value);
+		const bool has_text = fits(text, width);
+		set_cell_color(c, row, value, has_text);
+		c->rectangle(x + gap, y + 1, width - gap, s_row_height - 1);
+		c->fill();
+		if (has_text)
+		{
+			draw_text(c, layout, text, x, y, width, true);
+		}
+	}
+}
+
+/**
+ * This function draws the cells of a row, one per range of adjacent processes
+ * with the same content. The ranges crossing the edges of the clip area are
+ * followed beyond them, to label them with their first and last rank. The
+ * label is centered in the visible part of the range.
+ *
+ * @param[in] c The Cairo context.
+ *
+ * @param[in] layout The Pango layout to draw the text with.
+ *
+ * @param row The row.
+ *
+ * @param first_rank The first process rank in the clip area.
+ *
+ * @param last_rank The last process rank in the clip area.
+ */
+void UIOverview::draw_ranges(const Cairo::RefPtr<Cairo::Context> &c,
+							 Glib::RefPtr<Pango::Layout> &layout,
+							 const int row, const int first_rank,
+							 const int last_rank)
+{
+	double clip_x1, clip_y1, clip_x2, clip_y2;
+	c->get_clip_extents(clip_x1, clip_y1, clip_x2, clip_y2);
+	const int width = cell_width();
+	const int y = row * s_row_height;
+	int rank = first_rank;
+	while (rank <= last_rank)
+	{
+		int value;
+		if (!cell(row, rank, value))
+		{
+			++rank;
+			continue;
+		}
+		int first, last;
+		find_range(row, rank, value, first, last);
+		const int x = s_name_width + first * width;
+		const int range_width = (last - first + 1) * width;
+		const int visible_x = std::max(x, (int)clip_x1);
+		const int visible_width =
+			std::min(x + range_width, (int)clip_x2 + 1) - visible_x;
+		const string text = range_text(row, first, last, value);
+		const bool has_text = fits(text, range_width);
+		set_cell_color(c, row, value, has_text);
+		c->rectangle(x + 1, y + 1, range_width - 1, s_row_height - 1);
+		c->fill();
+		if (has_text)
+		{
+			draw_text(c, layout, text, visible_x, y, visible_width, true);
+		}
+		rank = last + 1;
+	}
+}
+
+/**
+ * This function draws the cells in the clip area, the row names and the lines
+ * between the rows. Everything outside the clip area is skipped.
+ *
+ * @param[in] c The Cairo context.
+ *
+ * @return @c true. The return value is used to indicate whether the event is
+ * completely handled.
+ */
+bool UIOverview::on_draw(const Cairo::RefPtr<Cairo::Context> &c)
+{
+	double x1, y1, x2, y2;
+	c->get_clip_extents(x1, y1, x2, y2);
+	const int width = cell_width();
+	const int first_rank = std::max(0, ((int)x1 - s_name_width) / width);
+	const int last_rank =
+		std::min(m_num_processes - 1, ((int)x2 - s_name_width) / width);
+	const int first_row = std::max(0, (int)y1 / s_row_height);
+	const int last_row = std::min(num_rows() - 1, (int)y2 / s_row_height);
+
+	m_text_color = get_style_context()->get_color(get_state_flags());
+	Pango::FontDescription font;
+	font.set_family("Monospace");
+	Glib::RefPtr<Pango::Layout> layout = create_pango_layout("0");
+	layout->set_font_description(font);
+	layout->get_pixel_size(m_char_width, m_char_height);
+
+	if (x1 < s_name_width)
+	{
+		draw_names(c, layout, first_row, last_row);
+	}
+	if (x2 > s_name_width)
+	{
+		for (int row = first_row; row <= last_row; ++row)
+		{
+			if (RANK_ROW == row)
+			{
+				draw_ranks(c, layout, first_rank, last_rank);
+			}
+			else if (m_grouped)
+			{
+				draw_ranges(c, layout, row, first_rank, last_rank);
+			}
+			else
+			{
+				draw_cells(c, layout, row, first_rank, last_rank);
+			}
+		}
+	}
+
+	// lines between the rows and right of the row names
+	c->set_source_rgba(0.5, 0.5, 0.5, 0.5);
+	c->set_line_width(1.0);
+	for (int row = first_row + 1; row <= last_row + 1; ++row)
+	{
+		c->move_to(x1, row * s_row_height + 0.5);
+		c->line_to(x2, row * s_row_height + 0.5);
+	}
+	c->move_to(s_name_width - 0.5, y1);
+	c->line_to(s_name_width - 0.5, y2);
+	c->stroke();
+
+	return true;
+}
+
+/**
+ * This function zooms when the mouse wheel is turned while Ctrl is held. Other
+ * scroll events are passed on to the scrolled window.
+ *
+ * @param[in] event The scroll event.
+ *
+ * @return @c true if the event is handled.
+ */
+bool UIOverview::on_scroll_event(GdkEventScroll *event)
+{
+	if (!(event->state & GDK_CONTROL_MASK))
+	{
+		return false;
+	}
+	if (GDK_SCROLL_UP == event->direction ||
+		(GDK_SCROLL_SMOOTH == event->direction && event->delta_y < 0))
+	{
+		zoom(1);
+	}
+	else if (GDK_SCROLL_DOWN == event->direction ||
+			 (GDK_SCROLL_SMOOTH == event->direction && event->delta_y > 0))
+	{
+		zoom(-1);
+	}
+	return true;
+}
+
+/**
+ * This function sets the tooltip of the cell under the pointer. It shows the
+ * process rank, or the range in grouped mode, and for source file cells the
+ * function and the source code of the line.
+ *
+ * @param x The horizontal position of the pointer.
+ *
+ * @param y The vertical position of the pointer.
+ *
+ * @param[in] tooltip The tooltip.
+ *
+ * @return @c true if a tooltip is shown.
+ */
+bool UIOverview::on_query_tooltip(int x, int y, bool,
+								  const Glib::RefPtr<Gtk::Tooltip> &tooltip)
+{
+	const int row = y / s_row_height;
+	if (y < 0 || row >= num_rows())
+	{
+		return false;
+	}
+	if (x < s_name_width)
+	{
+		if (row < FIRST_FILE_ROW)
+		{
+			return false;
+		}
+		tooltip->set_text(m_strings->str(m_row_files[row - FIRST_FILE_ROW]));
+		tooltip->set_tip_area(Gdk::Rectangle(0, row * s_row_height,
+											 s_name_width, s_row_height));
+		return true;
+	}
+	const int width = cell_width();
+	const int rank = (x - s_name_width) / width;
+	if (rank >= m_num_processes)
+	{
+		return false;
+	}
+	if (RANK_ROW == row)
+	{
+		tooltip->set_text("Process " + std::to_string(rank));
+		tooltip->set_tip_area(Gdk::Rectangle(s_name_width + rank * width,
+											 row * s_row_height, width,
+											 s_row_height));
+		return true;
+	}
+	int value;
+	if (!cell(row, rank, value))
+	{
+		return false;
+	}
+	int first = rank;
+	int last = rank;
+	if (m_grouped)
+	{
+		find_range(row, rank, value, first, last);
+	}
+	string text = range_text(row, first, last, value);
+	if (row >= FIRST_FILE_ROW)
+	{
+		string source = m_source_line(m_files[rank], value);
+		if (INTERN_NONE != m_funcs[rank])
+		{
+			source = m_strings->str(m_funcs[rank]) + ": " + source;
+		}
+		text += "\n" + source;
+	}
+	tooltip->set_text(text);
+	tooltip->set_tip_area(Gdk::Rectangle(s_name_width + first * width,
+										 row * s_row_height,
+										 (last - first + 1) * width,
+										 s_row_height));
+	return true;
+}
+
+/**
+ * This function appends a row for a source file, if it has none yet.
+ *
+ * @param file The interned full path of the source file.
+ */
+void UIOverview::append_file(const int file)
+{
+	if (file_row(file) >= 0)
+	{
+		return;
+	}
+	m_row_files.push_back(file);
+	update_size();
+	queue_draw();
+}
+
+/**
+ * This function removes the row of a source file.
+ *
+ * @param file The interned full path of the source file.
+ */
+void UIOverview::remove_file(const int file)
+{
+	const int row = file_row(file);
+	if (row < 0)
+	{
+		return;
+	}
+	m_row_files.erase(m_row_files.begin() + (row - FIRST_FILE_ROW));
+	update_size();
+	queue_draw();
+}
+
+/**
+ * This function sets the location a process is stopped in.
+ *
+ * @param rank The process rank.
+ *
+ * @param file The interned full path of the source file.
+ *
+ * @param func The interned name of the function, or @ref INTERN_NONE if
+ * unknown.
+ *
+ * @param line The line number in the source file. (one-based)
+ */
+void UIOverview::set_position(const int rank, const int file, const int func,
+							  const int line)
+{
+	if (m_files[rank] == file && m_funcs[rank] == func &&
+		m_lines[rank] == line)
+	{
+		return;
+	}
+	m_files[rank] = file;
+	m_funcs[rank] = func;
+	m_lines[rank] = line;
+	mark_dirty(rank);
+}
+
+/**
+ * This function sets the state of a process. A running or exited process is in
+ * no source file.
+ *
+ * @param rank The process rank.
+ *
+ * @param state The state of the process.
+ *
+ * @param exit_code The exit code, if the process has exited.
+ */
+void UIOverview::set_state(const int rank, const TargetState state,
+						   const int exit_code)
+{
+	if (m_states[rank] == state && m_exit_codes[rank] == exit_code)
+	{
+		return;
+	}
+	m_states[rank] = state;
+	m_exit_codes[rank] = exit_code;
+	if (TargetState::RUNNING == state || TargetState::EXITED == state)
+	{
+		m_files[rank] = INTERN_NONE;
+	}
+	mark_dirty(rank);
+}
+
+/**
+ * This function widens or narrows the process columns. Narrow columns leave
+ * out the text of the cells, which makes the Overview a heatmap.
+ *
+ * @param steps The number of zoom levels to zoom in, negative to zoom out.
+ */
+void UIOverview::zoom(const int steps)
+{
+	const int zoom_level = std::max(
+		0, std::min(s_num_zoom_levels - 1, m_zoom_level + steps));
+	if (zoom_level == m_zoom_level)
+	{
+		return;
+	}
+	m_zoom_level = zoom_level;
+	update_size();
+	queue_draw();
+}
+
+/**
+ * This function switches between drawing a cell per process and a cell per
+ * range of adjacent processes with the same content.
+ *
+ * @param grouped Whether ranges are drawn.
+ */
+void UIOverview::set_grouped(const bool grouped)
+{
+	m_grouped = grouped;
+	queue_draw();
+}
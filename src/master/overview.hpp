@@ -0,0 +1,212 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file overview.hpp
+ *
+ * @brief Header file for the UIOverview class.
+ *
+ * This is the header file for the UIOverview class.
+ */
+
+#ifndef OVERVIEW_HPP
+#define OVERVIEW_HPP
+
+#include <gtkmm.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "target_state.hpp"
+
+class InternTable;
+
+/// Draws the Overview of all processes as a heatmap.
+/**
+ * This class draws the Overview, a table with a column for every process and
+ * a row for every open source file, plus the rows for the process ranks, the
+ * running and the exited processes. It replaces a grid of labels, which needed
+ * a widget for every cell. The state is kept per process, the file, function
+ * and line it is stopped in, as a process is in at most one file. Only the
+ * cells in the clip area are drawn, so the cost of a redraw depends on the
+ * visible pixels and not on the number of processes.
+ *
+ * The cells of processes in the same line of a file get the same color of
+ * @ref UIDrawingArea::s_colors. When zoomed out, the columns get too narrow
+ * for text and the Overview becomes a heatmap of these colors. In grouped
+ * mode, adjacent processes with the same content are drawn as one range.
+ *
+ * The colors are kept per line and counted incrementally. A change of a process
+ * only marks it dirty, once per frame the dirty processes are recolored and
+ * only their columns are redrawn.
+ */
+class UIOverview : public Gtk::DrawingArea
+{
+	static const int s_name_width;
+	static const int s_row_height;
+	static const int s_padding;
+	static const int s_cell_widths[];
+	static const int s_num_zoom_levels;
+	static const int s_default_zoom_level;
+
+	/// The fixed rows above the rows of the source files.
+	enum Row
+	{
+		/** The process ranks. */
+		RANK_ROW,
+		/** The running processes. */
+		RUNNING_ROW,
+		/** The exited processes and their exit codes. */
+		EXITED_ROW,
+		/** The first source file. */
+		FIRST_FILE_ROW
+	};
+
+	/// The color of a line in a source file.
+	struct LineColor
+	{
+		/** The index in @ref UIDrawingArea::s_colors, or
+		 * @ref UIDrawingArea::NUM_COLORS if the line is not colored. */
+		int slot;
+		/** The number of processes in the line. */
+		int count;
+	};
+
+	/// The colors of the lines of a source file.
+	struct FileColors
+	{
+		/** The colors of the lines with processes. */
+		std::map<int, LineColor> lines;
+		/** The bit mask of the colors in use. */
+		unsigned used_slots;
+	};
+
+	const int m_num_processes;
+	InternTable *const m_strings;
+	const std::function<std::string(const int file, const int line)>
+		m_source_line;
+
+	int *const m_files;
+	int *const m_funcs;
+	int *const m_lines;
+	TargetState *const m_states;
+	int *const m_exit_codes;
+
+	std::vector<int> m_row_files;
+	std::map<int, FileColors> m_file_colors;
+	int *const m_colored_files;
+	int *const m_colored_lines;
+	bool *const m_dirty;
+	std::vector<int> m_dirty_ranks;
+
+	int m_zoom_level;
+	bool m_grouped;
+
+	Gdk::RGBA m_text_color;
+	int m_char_width;
+	int m_char_height;
+
+	/// Returns the width of a process column in pixels.
+	int cell_width() const;
+	/// Returns the number of rows.
+	int num_rows() const;
+	/// Returns the row of a file.
+	int file_row(const int file) const;
+	/// Gets the content of a cell.
+	bool cell(const int row, const int rank, int &value) const;
+	/// Finds the range of adjacent processes with the same cell content.
+	void find_range(const int row, const int rank, const int value, int &first,
+					int &last) const;
+	/// Returns the text of a cell.
+	std::string cell_text(const int row, const int value) const;
+	/// Returns the text of a range of cells.
+	std::string range_text(const int row, const int first, const int last,
+						   const int value) const;
+	/// Sets the color of a cell as the source of a Cairo context.
+	void set_cell_color(const Cairo::RefPtr<Cairo::Context> &c, const int row,
+						const int value, const bool has_text) const;
+	/// Marks a process to be recolored and redrawn in the next frame.
+	void mark_dirty(const int rank);
+	/// Removes a process from the color of its previous line.
+	void uncolor(const int rank);
+	/// Adds a process to the color of its current line.
+	void color(const int rank);
+	/// Recolors and redraws the dirty processes.
+	bool recolor(const Glib::RefPtr<Gdk::FrameClock> &);
+	/// Requests the size needed for all columns and rows.
+	void update_size();
+	/// Draws the names of the rows.
+	void draw_names(const Cairo::RefPtr<Cairo::Context> &c,
+					Glib::RefPtr<Pango::Layout> &layout, const int first_row,
+					const int last_row);
+	/// Draws the process ranks.
+	void draw_ranks(const Cairo::RefPtr<Cairo::Context> &c,
+					Glib::RefPtr<Pango::Layout> &layout, const int first_rank,
+					const int last_rank);
+	/// Draws the cells of a row, one per process.
+	void draw_cells(const Cairo::RefPtr<Cairo::Context> &c,
+					Glib::RefPtr<Pango::Layout> &layout, const int row,
+					const int first_rank, const int last_rank);
+	/// Draws the cells of a row, one per range of processes.
+	void draw_ranges(const Cairo::RefPtr<Cairo::Context> &c,
+					 Glib::RefPtr<Pango::Layout> &layout, const int row,
+					 const int first_rank, const int last_rank);
+	/// Draws a text clipped to a rectangle.
+	void draw_text(const Cairo::RefPtr<Cairo::Context> &c,
+				   Glib::RefPtr<Pango::Layout> &layout, const std::string &text,
+				   const int x, const int y, const int width,
+				   const bool center);
+	/// Checks whether a text fits into a width.
+	bool fits(const std::string &text, const int width) const;
+
+protected:
+	/// Draws the cells in the clip area.
+	virtual bool on_draw(const Cairo::RefPtr<Cairo::Context> &c);
+	/// Zooms on Ctrl+Scroll.
+	virtual bool on_scroll_event(GdkEventScroll *event);
+	/// Sets the tooltip of the cell under the pointer.
+	virtual bool on_query_tooltip(int x, int y, bool keyboard_tooltip,
+								  const Glib::RefPtr<Gtk::Tooltip> &tooltip);
+
+public:
+	/// Default constructor.
+	UIOverview(const int num_processes, InternTable *const strings,
+			   const std::function<std::string(const int file,
+											   const int line)> &source_line);
+	/// Destructor.
+	virtual ~UIOverview();
+
+	/// Appends a row for a source file.
+	void append_file(const int file);
+	/// Removes the row of a source file.
+	void remove_file(const int file);
+	/// Sets the location a process is stopped in.
+	void set_position(const int rank, const int file, const int func,
+					  const int line);
+	/// Sets the state of a process.
+	void set_state(const int rank, const TargetState state,
+				   const int exit_code);
+	/// Widens or narrows the process columns.
+	void zoom(const int steps);
+	/// Switches between a cell per process and a cell per range of processes.
+	void set_grouped(const bool grouped);
+};
+
+#endif /* OVERVIEW_HPP */
@@ -0,0 +1,341 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file parse_pool.cpp
+ *
+ * @brief Contains the implementation of the ParsePool class.
+ *
+ * This file contains the implementation of the ParsePool class.
+ */
+
+#include <variant>
+
+#include "parse_pool.hpp"
+#include "buffer_pool.hpp"
+#include "frame_cache.hpp"
+#include "ingest_budget.hpp"
+#include "intern_table.hpp"
+#include "metrics.hpp"
+
+#include "mi_event.hpp"
+
+using std::size_t;
+
+/// Applies the events of a GDB response to its delta.
+/**
+ * This visitor extracts the state changes the GUI is interested in from the
+ * events of a GDB response: running/stopped records, stream output, stop
+ * records, breakpoint creation results and the outcome of the command. It
+ * returns whether the event ends the response.
+ */
+struct DeltaBuilder
+{
+	GdbDelta &delta;
+	InternTable &strings;
+	FrameCache &frames;
+	Metrics &metrics;
+
+	bool operator()(const std::monostate &) const
+	{
+		return false;
+	}
+
+	bool operator()(const MiPrompt &) const
+	{
+		return true;
+	}
+
+	bool operator()(const MiResult &result) const
+	{
+		if (MI_CL_RUNNING == result.tclass)
+		{
+			delta.state = TargetState::RUNNING;
+		}
+		delta.completed = true;
+		delta.failed = MI_CL_ERROR == result.tclass;
+		if (nullptr != result.value.data())
+		{
+			delta.result = result.value;
+		}
+		if (0 != result.bkpt_number)
+		{
+			delta.bkpt_number = result.bkpt_number;
+		}
+		// GDB exited, there won't be a prompt
+		return MI_CL_EXIT == result.tclass;
+	}
+
+	bool operator()(const MiRunning &) const
+	{
+		delta.state = TargetState::RUNNING;
+		return false;
+	}
+
+	bool operator()(const MiStopped &stopped) const
+	{
+		delta.state = TargetState::STOPPED;
+		if (0 != stopped.bkptno)
+		{
+			delta.bkptno = stopped.bkptno;
+		}
+		if (!stopped.frame.empty())
+		{
+			bool hit;
+			const StopFrame &frame =
+				frames.lookup(stopped.frame, strings, hit);
+			metrics.count_frame(hit);
+			if (INTERN_NONE != frame.file)
+			{
+				delta.file = frame.file;
+				delta.func = frame.func;
+				delta.line = frame.line;
+			}
+		}
+		return false;
+	}
+
+	bool operator()(const MiExited &exited) const
+	{
+		delta.state = TargetState::STOPPED;
+		delta.exited = true;
+		delta.exit_code = exited.exit_code;
+		return false;
+	}
+
+	bool operator()(const MiBreakpointCreated &) const
+	{
+		return false;
+	}
+
+	bool operator()(const MiBreakpointModified &) const
+	{
+		return false;
+	}
+
+	bool operator()(const MiBreakpointDeleted &) const
+	{
+		return false;
+	}
+
+	bool operator()(const MiStreamText &stream) const
+	{
+		delta.text.append(stream.text);
+		return false;
+	}
+};
+
+/**
+ * This is the default constructor for the ParsePool class. It allocates the
+ * responses of the processes and starts the worker threads.
+ *
+ * @param num_processes The number of processes.
+ *
+ * @param num_workers The number of worker threads.
+ *
+ * @param[in] buffer_pool The pool the received chunks are returned to after
+ * parsing. The port index of a GDB port equals the process rank.
+ *
+ * @param[in] ingest_budget The budget the received chunks are accounted in.
+ * They are released from it after parsing.
+ *
+ * @param[in] metrics The metrics the parse time per event and the hits of the
+ * frame caches are recorded in.
+ *
+ * @param[in] strings The table the files and functions of stops are interned
+ * in.
+ *
+ * @param on_ready The function to call when new deltas are available. It is
+ * called from a worker thread and must be thread-safe.
+ */
+ParsePool::ParsePool(const int num_processes, const int num_workers,
+					 BufferPool *const buffer_pool,
+					 IngestBudget *const ingest_budget,
+					 Metrics *const metrics, InternTable *const strings,
+					 std::function<void()> on_ready)
+	: m_num_processes(num_processes),
+	  m_num_workers(num_workers),
+	  m_buffer_pool(buffer_pool),
+	  m_ingest_budget(ingest_budget),
+	  m_metrics(metrics),
+	  m_strings(strings),
+	  m_on_ready(std::move(on_ready)),
+	  m_responses(new GdbDelta[num_processes]),
+	  m_parsers(new MiEventParser[num_processes]),
+	  m_workers(new Worker[num_workers]),
+	  m_wakeup_pending(false)
+{
+	for (int rank = 0; rank < m_num_processes; ++rank)
+	{
+		reset_response(rank);
+	}
+	for (int worker = 0; worker < m_num_workers; ++worker)
+	{
+		m_workers[worker].stop = false;
+		m_workers[worker].thread = std::thread(&ParsePool::work, this, worker);
+	}
+}
+
+/**
+ * This function stops the worker threads. Chunks which have not been parsed
+ * yet are dropped.
+ */
+ParsePool::~ParsePool()
+{
+	for (int worker = 0; worker < m_num_workers; ++worker)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_workers[worker].mutex);
+			m_workers[worker].stop = true;
+		}
+		m_workers[worker].cond.notify_one();
+		m_workers[worker].thread.join();
+	}
+	delete[] m_workers;
+	delete[] m_responses;
+	delete[] m_parsers;
+}
+
+/**
+ * This function queues a chunk of GDB output for the worker of the process.
+ *
+ * @param rank The process rank.
+ *
+ * @param[in] data The received GDB output, stored in a buffer taken from the
+ * buffer pool. The pool takes ownership of it and releases it after parsing.
+ *
+ * @param length The length of the received GDB output in bytes.
+ *
+ * @param received The time the GDB output was received. See Metrics::now.
+ */
+void ParsePool::push(const int rank, char *const data, const size_t length,
+					 const std::uint64_t received)
+{
+	Worker &worker = m_workers[rank % m_num_workers];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.jobs.push_back(Job{rank, data, length, received});
+	}
+	worker.cond.notify_one();
+}
+
+/**
+ * This function takes all deltas parsed so far. The following delta wakes up
+ * the GUI thread again.
+ *
+ * @return The deltas, in order per process. They are valid until the next
+ * call of this function.
+ */
+const std::vector<GdbDelta> &ParsePool::take_deltas()
+{
+	m_taken.clear();
+	std::lock_guard<std::mutex> lock(m_mutex_deltas);
+	m_taken.swap(m_deltas);
+	m_wakeup_pending = false;
+	return m_taken;
+}
+
+/**
+ * This function waits for jobs of a worker and parses them in order.
+ *
+ * @param worker The index of the worker.
+ */
+void ParsePool::work(const int worker)
+{
+	Worker &self = m_workers[worker];
+	std::unique_lock<std::mutex> lock(self.mutex);
+	for (;;)
+	{
+		self.cond.wait(lock, [&self]
+					   { return self.stop || !self.jobs.empty(); });
+		if (self.stop)
+		{
+			return;
+		}
+		const Job job = self.jobs.front();
+		self.jobs.pop_front();
+		lock.unlock();
+		parse_chunk(job);
+		lock.lock();
+	}
+}
+
+/**
+ * This function feeds a chunk of GDB output to the event parser of the process
+ * and applies the events to its response. Every complete response is reduced
+ * to a GdbDelta, which is then handed over to the GUI thread.
+ *
+ * @param[in] job The chunk to parse.
+ */
+void ParsePool::parse_chunk(const Job &job)
+{
+	GdbDelta &response = m_responses[job.rank];
+	MiEventParser &parser = m_parsers[job.rank];
+	FrameCache &frames = m_workers[job.rank % m_num_workers].frames;
+	parser.feed(job.data, job.length);
+	std::vector<GdbDelta> deltas;
+	MiEvent event;
+	std::uint64_t start = Metrics::now();
+	while (parser.next(event))
+	{
+		if (std::visit(DeltaBuilder{response, *m_strings, frames, *m_metrics}, event))
+		{
+			response.received = job.received;
+			deltas.push_back(std::move(response));
+			reset_response(job.rank);
+		}
+		// the time since the previous event, including the skipped lines
+		const std::uint64_t end = Metrics::now();
+		m_metrics->parse.record(end - start);
+		start = end;
+	}
+	m_buffer_pool->release(job.rank, job.data);
+	m_ingest_budget->release(job.rank, m_buffer_pool->buffer_size());
+	if (deltas.empty())
+	{
+		return;
+	}
+
+	bool wakeup;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_deltas);
+		for (GdbDelta &delta : deltas)
+		{
+			m_deltas.push_back(std::move(delta));
+		}
+		wakeup = !m_wakeup_pending;
+		m_wakeup_pending = true;
+	}
+	if (wakeup)
+	{
+		m_on_ready();
+	}
+}
+
+/**
+ * This function starts a new, empty response of a process.
+ *
+ * @param rank The process rank.
+ */
+void ParsePool::reset_response(const int rank)
+{
+	m_responses[rank] = GdbDelta{rank, TargetState::UNKNOWN, "", 0, false, 0,
+								 INTERN_NONE, INTERN_NONE, 0, 0, false, false,
+								 "", 0};
+}
@@ -0,0 +1,162 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file parse_pool.hpp
+ *
+ * @brief Header file for the ParsePool class.
+ *
+ * This is the header file for the ParsePool class.
+ */
+
+#ifndef PARSE_POOL_HPP
+#define PARSE_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_cache.hpp"
+#include "target_state.hpp"
+
+class BufferPool;
+class IngestBudget;
+class InternTable;
+class Metrics;
+class MiEventParser;
+
+/// The state changes extracted from one GDB response.
+struct GdbDelta
+{
+	/** The process rank. */
+	int rank;
+	/** The state of the last running/stopped record, or UNKNOWN if none. */
+	TargetState state;
+	/** The stream output of GDB. */
+	std::string text;
+	/** The number of the breakpoint hit, or 0 if none. */
+	int bkptno;
+	/** Whether the target has exited. */
+	bool exited;
+	/** The exit code of the target, if exited. */
+	int exit_code;
+	/** The source file of the stop location, or INTERN_NONE if unknown. */
+	int file;
+	/** The function of the stop location, or INTERN_NONE if unknown. */
+	int func;
+	/** The line of the stop location. (one-based) */
+	int line;
+	/** The number of a newly created breakpoint, or 0 if none. */
+	int bkpt_number;
+	/** Whether the response contains a result record, completing a command. */
+	bool completed;
+	/** Whether the command failed. */
+	bool failed;
+	/** The value or error message of the result record, or empty if none. */
+	std::string result;
+	/** The time the end of the response was received. See Metrics::now. */
+	std::uint64_t received;
+};
+
+/// Parses the GDB output of all processes on worker threads.
+/**
+ * This class parses the received GDB output off the GUI thread. Every process
+ * is assigned to one worker thread, so the output of a process is always
+ * parsed in order by the same thread, while different processes are parsed in
+ * parallel. Each process has its own MiEventParser and the delta of its
+ * incomplete response, both only ever touched by its worker.
+ *
+ * The chunks are parsed as they are received, without framing or copying
+ * lines, into typed MiEvent objects, which are applied to the delta of the
+ * response right away, so no tree of the response is built. The file and
+ * function of a stop are interned in the InternTable, the deltas carry their
+ * IDs. Every worker remembers the recent stop frames in a FrameCache, so the
+ * location of a frame is extracted and interned once for all the processes
+ * stopping there. The complete responses are reduced to GdbDelta objects.
+ * Only those are handed over to the GUI thread, which is woken up once via
+ * the ready callback until it takes the deltas.
+ */
+class ParsePool
+{
+	/// A received chunk of GDB output.
+	struct Job
+	{
+		int rank;
+		char *data;
+		std::size_t length;
+		std::uint64_t received;
+	};
+
+	/// A worker thread with its job queue.
+	struct Worker
+	{
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::deque<Job> jobs;
+		bool stop;
+		std::thread thread;
+		FrameCache frames;
+	};
+
+	const int m_num_processes;
+	const int m_num_workers;
+	BufferPool *const m_buffer_pool;
+	IngestBudget *const m_ingest_budget;
+	Metrics *const m_metrics;
+	InternTable *const m_strings;
+	const std::function<void()> m_on_ready;
+	GdbDelta *m_responses;
+	MiEventParser *m_parsers;
+	Worker *m_workers;
+
+	std::mutex m_mutex_deltas;
+	std::vector<GdbDelta> m_deltas;
+	std::vector<GdbDelta> m_taken;
+	bool m_wakeup_pending;
+
+	/// Processes the jobs of a worker. (worker thread)
+	void work(const int worker);
+	/// Parses a chunk of GDB output. (worker thread)
+	void parse_chunk(const Job &job);
+	/// Starts a new response of a process. (worker thread)
+	void reset_response(const int rank);
+
+public:
+	/// Default constructor.
+	ParsePool(const int num_processes, const int num_workers,
+			  BufferPool *const buffer_pool, IngestBudget *const ingest_budget,
+			  Metrics *const metrics, InternTable *const strings,
+			  std::function<void()> on_ready);
+	/// Destructor.
+	~ParsePool();
+
+	/// Queues a chunk of GDB output for parsing. (network thread)
+	void push(const int rank, char *const data, const std::size_t length,
+			  const std::uint64_t received);
+	/// Takes all deltas parsed so far. (GUI thread)
+	const std::vector<GdbDelta> &take_deltas();
+};
+
+#endif /* PARSE_POOL_HPP */
@@ -0,0 +1,233 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file send_queue.cpp
+ *
+ * @brief Contains the implementation of the SendQueue class.
+ *
+ * This file contains the implementation of the SendQueue class.
+ */
+
+#include <unistd.h>
+
+#include "send_queue.hpp"
+
+using asio::ip::tcp;
+using std::string;
+
+/**
+ * This is the default constructor for the SendQueue class. It starts the
+ * writer thread.
+ *
+ * @param num_ports The number of TCP ports (two per process).
+ *
+ * @param on_failure The function to call when a write failed. It is called
+ * from the writer thread and must be thread-safe.
+ */
+SendQueue::SendQueue(const int num_ports, std::function<void()> on_failure)
+	: m_num_ports(num_ports),
+	  m_channels(new Channel[num_ports]),
+	  m_on_failure(std::move(on_failure)),
+	  m_work(asio::make_work_guard(m_io_context))
+{
+	for (int idx = 0; idx < m_num_ports; ++idx)
+	{
+		m_channels[idx].writing = false;
+	}
+	m_writer = std::thread([this]
+						   { m_io_context.run(); });
+}
+
+/**
+ * This function closes the sockets of all ports and stops the writer thread.
+ * Data which has not been written yet is dropped. As closing a socket aborts
+ * its writes in flight, this never waits for a stalled slave.
+ */
+SendQueue::~SendQueue()
+{
+	for (int idx = 0; idx < m_num_ports; ++idx)
+	{
+		attach(idx, nullptr);
+	}
+	m_work.reset();
+	m_writer.join();
+	delete[] m_channels;
+}
+
+/**
+ * This function sets the TCP socket of a port. The socket descriptor is
+ * duplicated, the writes go to the duplicate only.
+ *
+ * Clearing the socket drops all pending data and closes the duplicate, which
+ * aborts a write in flight. The original socket is not used afterwards, so it
+ * can be destroyed right away.
+ *
+ * @param idx The port index (port - base port).
+ *
+ * @param[in] socket The TCP socket, or @c nullptr to detach the current one.
+ */
+void SendQueue::attach(const int idx, tcp::socket *const socket)
+{
+	Channel &channel = m_channels[idx];
+	std::shared_ptr<tcp::socket> duplicate;
+	if (nullptr != socket)
+	{
+		const int fd = dup(socket->native_handle());
+		if (-1 == fd)
+		{
+			return;
+		}
+		duplicate = std::make_shared<tcp::socket>(m_io_context);
+		asio::error_code error;
+		duplicate->assign(tcp::v4(), fd, error);
+		if (error)
+		{
+			::close(fd);
+			return;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(channel.mutex);
+		channel.socket.swap(duplicate);
+		channel.pending.clear();
+	}
+	// the previous socket, closed on the writer thread like all its operations
+	if (duplicate)
+	{
+		asio::post(m_io_context, [this, duplicate]
+				   { close_socket(duplicate); });
+	}
+}
+
+/**
+ * This function appends data to the write queue of a port and returns
+ * immediately. If no write is in flight, one is started on the writer thread.
+ *
+ * @param idx The port index (port - base port).
+ *
+ * @param[in] data The data to send.
+ *
+ * @return @c true if the data was queued, @c false if the port is not
+ * connected.
+ */
+bool SendQueue::enqueue(const int idx, const string &data)
+{
+	Channel &channel = m_channels[idx];
+	std::lock_guard<std::mutex> lock(channel.mutex);
+	if (!channel.socket)
+	{
+		return false;
+	}
+	channel.pending += data;
+	if (!channel.writing)
+	{
+		channel.writing = true;
+		asio::post(m_io_context, [this, idx]
+				   { write_next(idx); });
+	}
+	return true;
+}
+
+/**
+ * This function removes the next reported write failure.
+ *
+ * @param[out] idx The port index (port - base port) the write failed for.
+ *
+ * @param[out] message The error message.
+ *
+ * @return @c true if a failure was removed, @c false if there is none.
+ */
+bool SendQueue::pop_failure(int &idx, string &message)
+{
+	std::lock_guard<std::mutex> lock(m_mutex_failures);
+	if (m_failures.empty())
+	{
+		return false;
+	}
+	idx = m_failures.front().first;
+	message = std::move(m_failures.front().second);
+	m_failures.pop_front();
+	return true;
+}
+
+/**
+ * This function closes a socket, which is no longer attached to its port.
+ * A write in flight completes with asio::error::operation_aborted.
+ *
+ * @param[in] socket The socket.
+ */
+void SendQueue::close_socket(const std::shared_ptr<tcp::socket> &socket)
+{
+	asio::error_code error;
+	socket->close(error);
+}
+
+/**
+ * This function starts an asynchronous write of the pending data of a port.
+ * Everything queued since the last write is sent at once. Without pending
+ * data or socket, the port is marked as idle, so the next @ref enqueue starts
+ * a new write.
+ *
+ * @param idx The port index (port - base port).
+ */
+void SendQueue::write_next(const int idx)
+{
+	Channel &channel = m_channels[idx];
+	std::shared_ptr<tcp::socket> socket;
+	{
+		std::lock_guard<std::mutex> lock(channel.mutex);
+		if (!channel.socket || channel.pending.empty())
+		{
+			channel.writing = false;
+			return;
+		}
+		socket = channel.socket;
+		channel.sending.swap(channel.pending);
+		channel.pending.clear();
+	}
+	// the handler keeps the socket alive until the write has completed
+	asio::async_write(*socket, asio::buffer(channel.sending),
+					  [this, idx, socket](const asio::error_code &error,
+										  std::size_t)
+					  { on_written(idx, error); });
+}
+
+/**
+ * This function handles a completed write of a port. A failure is reported,
+ * unless the write was aborted because the socket was detached. Then the data
+ * queued in the meantime is written.
+ *
+ * @param idx The port index (port - base port).
+ *
+ * @param error The result of the write.
+ */
+void SendQueue::on_written(const int idx, const asio::error_code &error)
+{
+	m_channels[idx].sending.clear();
+	if (error && asio::error::operation_aborted != error)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex_failures);
+			m_failures.emplace_back(idx, error.message());
+		}
+		m_on_failure();
+	}
+	write_next(idx);
+}
@@ -0,0 +1,101 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file send_queue.hpp
+ *
+ * @brief Header file for the SendQueue class.
+ *
+ * This is the header file for the SendQueue class.
+ */
+
+#ifndef SEND_QUEUE_HPP
+#define SEND_QUEUE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "asio.hpp"
+
+/// Writes commands to the TCP sockets without blocking the caller.
+/**
+ * This class holds one write queue per TCP port. All queues are served by a
+ * single thread running asynchronous writes on its own io_context, so a slave
+ * with a full TCP window only delays the writes to its own port, never the
+ * GUI thread or the other ports. Data enqueued while a write is in flight is
+ * appended to a single pending buffer and sent with the next write.
+ *
+ * The writes go to a duplicate of the socket descriptor, which belongs to
+ * this class. So a reading thread can close its socket at any time, and the
+ * destructor closes the duplicates, which aborts the writes still in flight.
+ *
+ * Failed writes are collected and announced via the failure callback, which
+ * is called from the writer thread.
+ */
+class SendQueue
+{
+	/// The write queue of a single port.
+	struct Channel
+	{
+		std::mutex mutex;
+		std::shared_ptr<asio::ip::tcp::socket> socket;
+		std::string pending;
+		std::string sending;
+		bool writing;
+	};
+
+	const int m_num_ports;
+	Channel *const m_channels;
+	const std::function<void()> m_on_failure;
+
+	asio::io_context m_io_context;
+	asio::executor_work_guard<asio::io_context::executor_type> m_work;
+	std::thread m_writer;
+
+	std::mutex m_mutex_failures;
+	std::deque<std::pair<int, std::string>> m_failures;
+
+	/// Closes a detached socket. (writer thread)
+	void close_socket(const std::shared_ptr<asio::ip::tcp::socket> &socket);
+	/// Starts writing the pending data of a port. (writer thread)
+	void write_next(const int idx);
+	/// Handles a completed write of a port. (writer thread)
+	void on_written(const int idx, const asio::error_code &error);
+
+public:
+	/// Default constructor.
+	SendQueue(const int num_ports, std::function<void()> on_failure);
+	/// Destructor.
+	~SendQueue();
+
+	/// Sets or clears the TCP socket of a port. (network thread)
+	void attach(const int idx, asio::ip::tcp::socket *const socket);
+	/// Queues data to be written to a port.
+	bool enqueue(const int idx, const std::string &data);
+	/// Removes the next reported write failure.
+	bool pop_failure(int &idx, std::string &message);
+};
+
+#endif /* SEND_QUEUE_HPP */
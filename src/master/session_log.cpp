@@ -0,0 +1,224 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file session_log.cpp
+ *
+ * @brief Contains the implementation of the SessionRecorder and SessionReader
+ * classes.
+ *
+ * This file contains the implementation of the SessionRecorder and
+ * SessionReader classes.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <string.h>
+
+#include "session_log.hpp"
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+/// The magic at the start of a session log.
+#define SESSION_LOG_MAGIC "PGDBLOG1"
+/// The size of the magic in bytes.
+#define SESSION_LOG_MAGIC_SIZE 8
+
+/**
+ * This function returns the time of the monotonic clock in nanoseconds.
+ *
+ * @return The current time in nanoseconds.
+ */
+static uint64_t monotonic_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+/**
+ * This is the default constructor for the SessionRecorder class. It creates
+ * the log file and writes the header.
+ *
+ * @param[in] path The path of the log file.
+ *
+ * @param num_processes The number of processes.
+ *
+ * @param base_port The base port.
+ */
+SessionRecorder::SessionRecorder(const char *path, const int num_processes,
+								 const int base_port)
+	: m_file(fopen(path, "wb")),
+	  m_base_port(base_port),
+	  m_start(monotonic_ns())
+{
+	if (nullptr == m_file)
+	{
+		return;
+	}
+	const uint32_t header[2] = {(uint32_t)num_processes, (uint32_t)base_port};
+	if (1 != fwrite(SESSION_LOG_MAGIC, SESSION_LOG_MAGIC_SIZE, 1, m_file) ||
+		1 != fwrite(header, sizeof(header), 1, m_file))
+	{
+		fail();
+	}
+}
+
+/**
+ * This function flushes and closes the log file.
+ */
+SessionRecorder::~SessionRecorder()
+{
+	if (nullptr != m_file && 0 != fclose(m_file))
+	{
+		fprintf(stderr, "Error: Cannot write the session log: %s\n",
+				strerror(errno));
+	}
+}
+
+/**
+ * This function reports a failed write and closes the log file, so nothing is
+ * recorded anymore. The log keeps the records written completely so far.
+ */
+void SessionRecorder::fail()
+{
+	fprintf(stderr,
+			"Error: Cannot write the session log: %s. Recording stopped.\n",
+			strerror(errno));
+	fclose(m_file);
+	m_file = nullptr;
+}
+
+/**
+ * This function appends a received chunk to the log, together with its port
+ * and the time since the start of the recording. The time is taken under the
+ * mutex, so the records are in the order of their times. Recording stops at
+ * the first failed write, e.g. on a full disk.
+ *
+ * @param port The TCP port the chunk was received on.
+ *
+ * @param[in] data The received data.
+ *
+ * @param length The length of the data in bytes.
+ */
+void SessionRecorder::record(const int port, const char *const data,
+							 const size_t length)
+{
+	const uint32_t fields[2] = {(uint32_t)(port - m_base_port),
+								(uint32_t)length};
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (nullptr == m_file)
+	{
+		return;
+	}
+	const uint64_t time = monotonic_ns() - m_start;
+	if (1 != fwrite(&time, sizeof(time), 1, m_file) ||
+		1 != fwrite(fields, sizeof(fields), 1, m_file) ||
+		length != fwrite(data, 1, length, m_file))
+	{
+		fail();
+	}
+}
+
+/**
+ * This is the default constructor for the SessionReader class. It opens the
+ * log file and reads the header. If the file cannot be opened or has no valid
+ * header, @ref is_open returns @c false.
+ *
+ * @param[in] path The path of the log file.
+ */
+SessionReader::SessionReader(const char *path)
+	: m_file(fopen(path, "rb")),
+	  m_num_processes(0),
+	  m_base_port(0)
+{
+	if (nullptr == m_file)
+	{
+		return;
+	}
+	char magic[SESSION_LOG_MAGIC_SIZE];
+	uint32_t header[2];
+	if (1 != fread(magic, sizeof(magic), 1, m_file) ||
+		0 != memcmp(magic, SESSION_LOG_MAGIC, SESSION_LOG_MAGIC_SIZE) ||
+		1 != fread(header, sizeof(header), 1, m_file) || 0 == header[0])
+	{
+		fclose(m_file);
+		m_file = nullptr;
+		return;
+	}
+	m_num_processes = (int)header[0];
+	m_base_port = (int)header[1];
+}
+
+/**
+ * This function closes the log file.
+ */
+SessionReader::~SessionReader()
+{
+	if (nullptr != m_file)
+	{
+		fclose(m_file);
+	}
+}
+
+/**
+ * This function reads the header of the next record of the log. The data of
+ * the record must be read with @ref read before the next call.
+ *
+ * @param[out] time The time since the start of the recording in nanoseconds.
+ *
+ * @param[out] idx The port index, i.e. the port relative to the base port.
+ *
+ * @param[out] length The length of the data in bytes.
+ *
+ * @param max_length The largest valid length in bytes.
+ *
+ * @return @c true if a record was read, @c false at the end of the log or if
+ * the record is invalid.
+ */
+bool SessionReader::next(uint64_t &time, int &idx, size_t &length,
+						 const size_t max_length)
+{
+	uint32_t fields[2];
+	if (1 != fread(&time, sizeof(time), 1, m_file) ||
+		1 != fread(fields, sizeof(fields), 1, m_file) ||
+		fields[0] >= 2 * (uint32_t)m_num_processes || fields[1] > max_length)
+	{
+		return false;
+	}
+	idx = (int)fields[0];
+	length = fields[1];
+	return true;
+}
+
+/**
+ * This function reads the data of the record returned by @ref next.
+ *
+ * @param[out] data The buffer for the data.
+ *
+ * @param length The length of the data in bytes, as returned by @ref next.
+ *
+ * @return @c true on success, @c false if the log is truncated.
+ */
+bool SessionReader::read(char *const data, const size_t length)
+{
+	return length == fread(data, 1, length, m_file);
+}
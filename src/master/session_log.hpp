@@ -0,0 +1,141 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file session_log.hpp
+ *
+ * @brief Header file for the SessionRecorder and SessionReader classes.
+ *
+ * This is the header file for the SessionRecorder and SessionReader classes.
+ * A session log starts with a header, followed by one record per received
+ * chunk, all in host byte order:
+ *
+ * - header: the magic "PGDBLOG1", the number of processes and the base port
+ *   (both 32 bit)
+ * - record: the time since the start of the recording in nanoseconds (64 bit),
+ *   the port index (32 bit), the length (32 bit) and the received bytes
+ */
+
+#ifndef SESSION_LOG_HPP
+#define SESSION_LOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+/// Records the chunks received from the slaves into a session log.
+/**
+ * This class appends every chunk received by the master to a session log,
+ * which can later be replayed with the SessionReader. It is called from the
+ * threads reading from the TCP sockets, so the records are serialised by a
+ * mutex. Recording stops at the first failed write.
+ */
+class SessionRecorder
+{
+	std::FILE *m_file;
+	const int m_base_port;
+	const std::uint64_t m_start;
+	std::mutex m_mutex;
+
+	/// Reports a failed write and stops recording.
+	void fail();
+
+public:
+	/// Default constructor.
+	SessionRecorder(const char *path, const int num_processes,
+					const int base_port);
+	/// Destructor.
+	~SessionRecorder();
+
+	/// Appends a received chunk to the log. (network thread)
+	void record(const int port, const char *const data,
+				const std::size_t length);
+
+	/// Returns whether the log could be opened.
+	/**
+	 * This function returns whether the log could be opened.
+	 *
+	 * @return @c true if the log is open, @c false otherwise.
+	 */
+	inline bool is_open() const
+	{
+		return nullptr != m_file;
+	}
+};
+
+/// Reads the chunks of a session log.
+/**
+ * This class reads the records of a session log, as written by the
+ * SessionRecorder, in order.
+ */
+class SessionReader
+{
+	std::FILE *m_file;
+	int m_num_processes;
+	int m_base_port;
+
+public:
+	/// Default constructor.
+	SessionReader(const char *path);
+	/// Destructor.
+	~SessionReader();
+
+	/// Reads the header of the next record.
+	bool next(std::uint64_t &time, int &idx, std::size_t &length,
+			  const std::size_t max_length);
+	/// Reads the data of the record.
+	bool read(char *const data, const std::size_t length);
+
+	/// Returns whether the log could be opened.
+	/**
+	 * This function returns whether the log could be opened and has a valid
+	 * header.
+	 *
+	 * @return @c true if the log is valid, @c false otherwise.
+	 */
+	inline bool is_open() const
+	{
+		return nullptr != m_file;
+	}
+
+	/// Returns the number of processes of the recorded session.
+	/**
+	 * This function returns the number of processes of the recorded session.
+	 *
+	 * @return The number of processes.
+	 */
+	inline int num_processes() const
+	{
+		return m_num_processes;
+	}
+
+	/// Returns the base port of the recorded session.
+	/**
+	 * This function returns the base port of the recorded session.
+	 *
+	 * @return The base port.
+	 */
+	inline int base_port() const
+	{
+		return m_base_port;
+	}
+};
+
+#endif /* SESSION_LOG_HPP */
@@ -29,6 +29,8 @@
 #include <fstream>
 #include <string>
 #include <regex>
+#include <climits>
+#include <cstdio>
 
 #include "startup.hpp"
 #include "base64.hpp"
@@ -53,6 +55,36 @@ T *StartupDialog::get_widget(const std::string &widget_name)
 	return widget;
 }
 
+/**
+ * This function parses a decimal number from an entry or configuration file.
+ *
+ * @param[in] text The text to parse.
+ *
+ * @param min The smallest valid number.
+ *
+ * @param max The largest valid number.
+ *
+ * @return The parsed number on success, @c -1 if the text is not a number in
+ * the range from @p min to @p max.
+ */
+static int parse_number(const string &text, const int min, const int max)
+{
+	try
+	{
+		size_t pos;
+		const int number = std::stoi(text, &pos, 10);
+		if (pos != text.size() || number < min || number > max)
+		{
+			throw std::exception();
+		}
+		return number;
+	}
+	catch (const std::exception &)
+	{
+		return -1;
+	}
+}
+
 /**
  * This is the default constructor for the StartupDialog class. It will
  * parse the startup_dialog.glade file and renders the startup dialog.
@@ -77,7 +109,10 @@ StartupDialog::StartupDialog()
 	  m_ssh(false),
 	  m_ssh_address(""),
 	  m_ssh_user(""),
-	  m_ssh_password("")
+	  m_ssh_password(""),
+	  m_rank_budget(-1),
+	  m_total_budget(-1),
+	  m_drop_overflow(false)
 {
 	// parse the glade file
 	m_builder = Gtk::Builder::create_from_resource("/pgdb/ui/startup_dialog.glade");
@@ -109,6 +144,10 @@ StartupDialog::StartupDialog()
 	m_entry_ssh_address = get_widget<Gtk::Entry>("ssh-address-entry");
 	m_entry_ssh_user = get_widget<Gtk::Entry>("ssh-user-entry");
 	m_entry_ssh_password = get_widget<Gtk::Entry>("ssh-password-entry");
+	m_entry_rank_budget = get_widget<Gtk::Entry>("rank-budget-entry");
+	m_entry_total_budget = get_widget<Gtk::Entry>("total-budget-entry");
+	m_checkbutton_drop_overflow =
+		get_widget<Gtk::CheckButton>("drop-overflow-checkbutton");
 	m_config_file_chooser =
 		get_widget<Gtk::FileChooserButton>("config-file-chooser");
 	m_slave_file_chooser =
@@ -143,12 +182,73 @@ StartupDialog::StartupDialog()
 	m_dialog->signal_response().connect(
 		sigc::mem_fun(*this, &StartupDialog::on_dialog_response));
 
-	// set default value for base port
+	// set default values for base port and ingest budgets
 	m_entry_base_port->set_text("32768");
+	m_entry_rank_budget->set_text(std::to_string(DEFAULT_RANK_BUDGET_KIB));
+	m_entry_total_budget->set_text(std::to_string(DEFAULT_TOTAL_BUDGET_MIB));
 
 	m_dialog->show_all();
 }
 
+/**
+ * This constructor reads the configuration from a configuration file, as
+ * exported by the startup dialog, without creating the dialog. It is used by
+ * the headless mode, where no display is available. Missing values default to
+ * the ones of the empty dialog.
+ *
+ * @param[in] config_path The path of the configuration file.
+ */
+StartupDialog::StartupDialog(const std::string &config_path)
+	: m_is_valid(false),
+	  m_launcher_mpirun(true),
+	  m_launcher_srun(false),
+	  m_launcher_custom(false),
+	  m_launcher_args(""),
+	  m_number_of_processes(-1),
+	  m_processes_per_node(-1),
+	  m_num_nodes(-1),
+	  m_ip_address(""),
+	  m_base_port(32768),
+	  m_slave_path(""),
+	  m_target_path(""),
+	  m_target_args(""),
+	  m_ssh(false),
+	  m_ssh_address(""),
+	  m_ssh_user(""),
+	  m_ssh_password(""),
+	  m_rank_budget(DEFAULT_RANK_BUDGET_KIB),
+	  m_total_budget(DEFAULT_TOTAL_BUDGET_MIB),
+	  m_drop_overflow(false),
+	  m_dialog(nullptr)
+{
+	std::ifstream config_file(config_path);
+	if (!config_file)
+	{
+		fprintf(stderr, "Error: Cannot open %s.\n", config_path.c_str());
+		return;
+	}
+	string line;
+	while (std::getline(config_file, line))
+	{
+		std::istringstream is_line(line);
+		string key;
+		if (std::getline(is_line, key, '='))
+		{
+			string value;
+			std::getline(is_line, value);
+			load_value(key, value);
+		}
+	}
+
+	const char *const error = check_values();
+	if (nullptr != error)
+	{
+		fprintf(stderr, "Error: %s\n", error);
+		return;
+	}
+	m_is_valid = true;
+}
+
 /**
  * This function closes the startup dialog.
  */
@@ -192,6 +292,9 @@ void StartupDialog::clear_dialog()
 	m_entry_ssh_address->set_text("");
 	m_entry_ssh_user->set_text("");
 	m_entry_ssh_password->set_text("");
+	m_entry_rank_budget->set_text(std::to_string(DEFAULT_RANK_BUDGET_KIB));
+	m_entry_total_budget->set_text(std::to_string(DEFAULT_TOTAL_BUDGET_MIB));
+	m_checkbutton_drop_overflow->set_active(false);
 
 	set_sensitivity_ssh(false);
 }
@@ -242,6 +345,12 @@ void StartupDialog::set_value(const std::string &key, const std::string &value)
 		m_entry_ssh_user->set_text(value);
 	if ("ssh_password" == key)
 		m_entry_ssh_password->set_text(Base64::decode(value));
+	if ("rank_budget_kib" == key)
+		m_entry_rank_budget->set_text(value);
+	if ("total_budget_mib" == key)
+		m_entry_total_budget->set_text(value);
+	if ("drop_overflow" == key)
+		m_checkbutton_drop_overflow->set_active("true" == value);
 	if ("launcher" == key)
 	{
 		if ("mpirun" == value)
@@ -272,6 +381,57 @@ void StartupDialog::set_value(const std::string &key, const std::string &value)
 	}
 }
 
+/**
+ * This function sets a value of the configuration directly, without a widget.
+ * Numbers are parsed like in @ref read_values. If the identifier is unknown
+ * nothing is done.
+ *
+ * @param[in] key The identifier of the value.
+ *
+ * @param[in] value The value to be set.
+ */
+void StartupDialog::load_value(const std::string &key, const std::string &value)
+{
+	if ("launcher_args" == key)
+		m_launcher_args = value;
+	if ("number_of_processes" == key)
+		m_number_of_processes = parse_number(value, 1, INT_MAX);
+	if ("processes_per_node" == key)
+		m_processes_per_node = parse_number(value, 1, INT_MAX);
+	if ("num_nodes" == key)
+		m_num_nodes = parse_number(value, 1, INT_MAX);
+	if ("ip_address" == key)
+		m_ip_address = value;
+	if ("base_port" == key)
+		m_base_port = parse_number(value, 0, 0xFFFF);
+	if ("slave_path" == key)
+		m_slave_path = value;
+	if ("target_path" == key)
+		m_target_path = value;
+	if ("target_args" == key)
+		m_target_args = value;
+	if ("ssh" == key)
+		m_ssh = "true" == value;
+	if ("ssh_address" == key)
+		m_ssh_address = value;
+	if ("ssh_user" == key)
+		m_ssh_user = value;
+	if ("ssh_password" == key)
+		m_ssh_password = Base64::decode(value);
+	if ("rank_budget_kib" == key)
+		m_rank_budget = parse_number(value, 1, INT_MAX);
+	if ("total_budget_mib" == key)
+		m_total_budget = parse_number(value, 1, INT_MAX);
+	if ("drop_overflow" == key)
+		m_drop_overflow = "true" == value;
+	if ("launcher" == key)
+	{
+		m_launcher_mpirun = "mpirun" == value;
+		m_launcher_srun = "srun" == value;
+		m_launcher_custom = "custom" == value;
+	}
+}
+
 /**
  * This function opens a (configuration) file. The content is tokenized and
  * passed to the @ref set_value function.
@@ -390,6 +550,18 @@ void StartupDialog::on_save_dialog_response(const int response_id,
 	config += Base64::encode(m_ssh_password);
 	config += "\n";
 
+	config += "rank_budget_kib=";
+	config += m_rank_budget > 0 ? std::to_string(m_rank_budget) : "";
+	config += "\n";
+
+	config += "total_budget_mib=";
+	config += m_total_budget > 0 ? std::to_string(m_total_budget) : "";
+	config += "\n";
+
+	config += "drop_overflow=";
+	config += m_drop_overflow ? "true" : "false";
+	config += "\n";
+
 	string filename = file_chooser_dialog->get_filename();
 	std::ofstream file(filename);
 	file << config;
@@ -413,6 +585,7 @@ bool StartupDialog::read_values(const bool exporting)
 	m_launcher_srun = m_radiobutton_srun->get_active();
 	m_launcher_custom = m_radiobutton_custom->get_active();
 	m_ssh = m_checkbutton_ssh->get_active();
+	m_drop_overflow = m_checkbutton_drop_overflow->get_active();
 
 	// copy new configs
 	m_launcher_args = m_entry_launcher_args->get_text();
@@ -425,117 +598,75 @@ bool StartupDialog::read_values(const bool exporting)
 	m_ssh_password = m_entry_ssh_password->get_text();
 
 	// parse intergers
-	try
-	{
-		size_t pos;
-		string text = m_entry_number_of_processes->get_text();
-		m_number_of_processes = std::stoi(text, &pos, 10);
-		if (pos != text.size() || m_number_of_processes <= 0)
-		{
-			throw std::exception();
-		}
-	}
-	catch (const std::exception &)
-	{
-		m_number_of_processes = -1;
-	}
+	m_number_of_processes =
+		parse_number(m_entry_number_of_processes->get_text(), 1, INT_MAX);
+	m_processes_per_node =
+		parse_number(m_entry_processes_per_node->get_text(), 1, INT_MAX);
+	m_num_nodes = parse_number(m_entry_num_nodes->get_text(), 1, INT_MAX);
+	m_base_port = parse_number(m_entry_base_port->get_text(), 0, 0xFFFF);
+	m_rank_budget = parse_number(m_entry_rank_budget->get_text(), 1, INT_MAX);
+	m_total_budget = parse_number(m_entry_total_budget->get_text(), 1, INT_MAX);
 
-	try
-	{
-		size_t pos;
-		string text = m_entry_processes_per_node->get_text();
-		m_processes_per_node = std::stoi(text, &pos, 10);
-		if (pos != text.size() || m_processes_per_node <= 0)
-		{
-			throw std::exception();
-		}
-	}
-	catch (const std::exception &)
+	if (exporting)
 	{
-		m_processes_per_node = -1;
+		return true;
 	}
 
-	try
+	const char *const error = check_values();
+	if (nullptr != error)
 	{
-		size_t pos;
-		string text = m_entry_num_nodes->get_text();
-		m_num_nodes = std::stoi(text, &pos, 10);
-		if (pos != text.size() || m_num_nodes <= 0)
-		{
-			throw std::exception();
-		}
-	}
-	catch (const std::exception &)
-	{
-		m_num_nodes = -1;
+		Gtk::MessageDialog dialog(*dynamic_cast<Gtk::Window *>(m_dialog),
+								  error, false, Gtk::MESSAGE_INFO,
+								  Gtk::BUTTONS_OK);
+		dialog.run();
+		return false;
 	}
 
-	try
-	{
-		size_t pos;
-		string text = m_entry_base_port->get_text();
-		m_base_port = std::stoi(text, &pos, 10);
-		if (pos != text.size() || m_base_port < 0 || m_base_port > 0xFFFF)
-		{
-			throw std::exception();
-		}
-	}
-	catch (const std::exception &)
+	return true;
+}
+
+/**
+ * This function checks the parsed configuration for missing or invalid values.
+ *
+ * @return The description of the first error found, or @c nullptr if the
+ * configuration is valid.
+ */
+const char *StartupDialog::check_values() const
+{
+	if (-1 == m_number_of_processes)
 	{
-		m_base_port = -1;
+		return "Invalid Number of Processes.";
 	}
-
-	if (exporting)
+	if (-1 == m_base_port)
 	{
-		return true;
+		return "Invalid Base Port.";
 	}
-
-	if (-1 == m_number_of_processes)
+	if (-1 == m_rank_budget)
 	{
-		Gtk::MessageDialog dialog(*dynamic_cast<Gtk::Window *>(m_dialog),
-								  "Invalid Number of Processes.", false,
-								  Gtk::MESSAGE_INFO, Gtk::BUTTONS_OK);
-		dialog.run();
-		return false;
+		return "Invalid Per-Process Budget.";
 	}
-	if (-1 == m_base_port)
+	if (-1 == m_total_budget)
 	{
-		Gtk::MessageDialog dialog(*dynamic_cast<Gtk::Window *>(m_dialog),
-								  "Invalid Base Port.", false,
-								  Gtk::MESSAGE_INFO, Gtk::BUTTONS_OK);
-		dialog.run();
-		return false;
+		return "Invalid Total Budget.";
 	}
 
 	if (!m_launcher_custom)
 	{
 		if ("" == m_ip_address)
 		{
-			Gtk::MessageDialog dialog(*dynamic_cast<Gtk::Window *>(m_dialog),
-									  "Missing IP address.", false,
-									  Gtk::MESSAGE_INFO, Gtk::BUTTONS_OK);
-			dialog.run();
-			return false;
+			return "Missing IP address.";
 		}
 		if ("" == m_slave_path)
 		{
-			Gtk::MessageDialog dialog(*dynamic_cast<Gtk::Window *>(m_dialog),
-									  "Missing Slave Path.", false,
-									  Gtk::MESSAGE_INFO, Gtk::BUTTONS_OK);
-			dialog.run();
-			return false;
+			return "Missing Slave Path.";
 		}
 		if ("" == m_target_path)
 		{
-			Gtk::MessageDialog dialog(*dynamic_cast<Gtk::Window *>(m_dialog),
-									  "Missing Target Path.", false,
-									  Gtk::MESSAGE_INFO, Gtk::BUTTONS_OK);
-			dialog.run();
-			return false;
+			return "Missing Target Path.";
 		}
 	}
 
-	return true;
+	return nullptr;
 }
 
 /**
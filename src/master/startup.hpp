@@ -30,6 +30,13 @@
 
 #include <gtkmm.h>
 #include <iosfwd>
+#include <cstddef>
+#include <string>
+
+/// The default ingest budget of a single process in KiB.
+#define DEFAULT_RANK_BUDGET_KIB 1024
+/// The default ingest budget of all processes in MiB.
+#define DEFAULT_TOTAL_BUDGET_MIB 256
 
 /// Generates the startup dialog.
 /**
@@ -56,6 +63,9 @@ class StartupDialog
 	std::string m_ssh_address;
 	std::string m_ssh_user;
 	std::string m_ssh_password;
+	int m_rank_budget;
+	int m_total_budget;
+	bool m_drop_overflow;
 
 	Gtk::RadioButton *m_radiobutton_mpirun;
 	Gtk::RadioButton *m_radiobutton_srun;
@@ -73,6 +83,9 @@ class StartupDialog
 	Gtk::Entry *m_entry_ssh_address;
 	Gtk::Entry *m_entry_ssh_user;
 	Gtk::Entry *m_entry_ssh_password;
+	Gtk::Entry *m_entry_rank_budget;
+	Gtk::Entry *m_entry_total_budget;
+	Gtk::CheckButton *m_checkbutton_drop_overflow;
 	Gtk::FileChooserButton *m_config_file_chooser;
 	Gtk::FileChooserButton *m_slave_file_chooser;
 	Gtk::FileChooserButton *m_target_file_chooser;
@@ -92,12 +105,16 @@ class StartupDialog
 	void clear_dialog();
 	/// Set a value to an widget in the dialog.
 	void set_value(const std::string &key, const std::string &value);
+	/// Sets a value of the configuration without a widget.
+	void load_value(const std::string &key, const std::string &value);
 	/// Opens and tokenizes a (configuration) file.
 	void read_config();
 	/// Shows a save file dialog to export the current configuration as a file
 	void export_config();
 	/// Parses the current configuration.
 	bool read_values(const bool exporting);
+	/// Checks the parsed configuration.
+	const char *check_values() const;
 	/// Writes the current configuration as a file.
 	void on_save_dialog_response(const int response_id,
 								 Gtk::FileChooserDialog *file_chooser_dialog);
@@ -113,6 +130,8 @@ class StartupDialog
 public:
 	/// Default constructor.
 	StartupDialog();
+	/// Reads the configuration from a file without a dialog.
+	StartupDialog(const std::string &config_path);
 	/// Destructor.
 	~StartupDialog();
 
@@ -209,6 +228,42 @@ public:
 	{
 		return m_ssh_password.c_str();
 	}
+
+	/// Returns the ingest budget of a single process.
+	/**
+	 * This function returns the number of received bytes a single process may
+	 * have queued before the master stops reading from it.
+	 *
+	 * @return The ingest budget of a single process in bytes.
+	 */
+	inline std::size_t rank_budget() const
+	{
+		return (std::size_t)m_rank_budget << 10;
+	}
+
+	/// Returns the ingest budget of all processes.
+	/**
+	 * This function returns the number of received bytes all processes
+	 * together may have queued before the master stops reading.
+	 *
+	 * @return The ingest budget of all processes in bytes.
+	 */
+	inline std::size_t total_budget() const
+	{
+		return (std::size_t)m_total_budget << 20;
+	}
+
+	/// Returns whether target output is dropped when a budget is exceeded.
+	/**
+	 * This function returns whether the output of the target programs is
+	 * dropped instead of paused when a budget is exceeded.
+	 *
+	 * @return @c true for dropping, @c false for pausing.
+	 */
+	inline bool drop_overflow() const
+	{
+		return m_drop_overflow;
+	}
 };
 
 #endif /* STARTUP_HPP */
\ No newline at end of file
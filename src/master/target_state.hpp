@@ -0,0 +1,44 @@
+/*
+	This file is part of ParallelGDB.
+
+	Copyright (c) 2023 by Nicolas With
+
+	ParallelGDB is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	ParallelGDB is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with ParallelGDB.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file target_state.hpp
+ *
+ * @brief Header file for the TargetState enum.
+ *
+ * This is the header file for the TargetState enum.
+ */
+
+#ifndef TARGET_STATE_HPP
+#define TARGET_STATE_HPP
+
+/// The states a process can be in.
+enum TargetState
+{
+	/** The target state has not been detected yet. */
+	UNKNOWN,
+	/** The target is stopped. */
+	STOPPED,
+	/** The target is running. */
+	RUNNING,
+	/** The target has exited. */
+	EXITED
+};
+
+#endif /* TARGET_STATE_HPP */
@@ -29,6 +29,10 @@
 #include <tuple>
 #include <iterator>
 #include <string>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <fstream>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -41,12 +45,25 @@
 #include "breakpoint_dialog.hpp"
 #include "follow_dialog.hpp"
 #include "canvas.hpp"
-
-#include "mi_gdb.h"
+#include "overview.hpp"
+#include "ingest.hpp"
+#include "buffer_pool.hpp"
+#include "send_queue.hpp"
+#include "parse_pool.hpp"
+#include "ingest_budget.hpp"
+#include "intern_table.hpp"
+#include "metrics.hpp"
 
 using asio::ip::tcp;
 using std::string;
 
+/// The time in microseconds a single drain may occupy the GUI thread.
+#define INGEST_BUDGET_US 8000
+/// The maximum number of threads parsing GDB output.
+#define PARSE_MAX_WORKERS 8
+/// The number of processes listed on the metrics page.
+#define METRICS_MAX_RANKS 20
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 const char *const breakpoint_category = "breakpoint-category";
 const char *const line_number_id = "line-number";
@@ -60,21 +77,31 @@ const char *const open_file_id = "open-file";
  * @param num_processes The total number of processes.
  *
  * @param base_port The base port.
+ *
+ * @param rank_budget The number of received bytes a single process may have
+ * queued. See IngestBudget.
+ *
+ * @param total_budget The number of received bytes all processes together may
+ * have queued.
+ *
+ * @param drop_overflow Whether target output is dropped instead of paused when
+ * a budget is exceeded.
  */
-UIWindow::UIWindow(const int num_processes, const int base_port)
+UIWindow::UIWindow(const int num_processes, const int base_port,
+				   const std::size_t rank_budget,
+				   const std::size_t total_budget, const bool drop_overflow)
 	: m_num_processes(num_processes),
 	  m_follow_rank(FOLLOW_ALL),
 	  m_base_port(base_port)
 {
 	// allocate memory and zero-initialize values
 	m_current_line = new int[m_num_processes]();
-	m_current_file = new string[m_num_processes]();
+	m_current_file = new int[m_num_processes]();
+	m_current_func = new int[m_num_processes]();
 	m_target_state = new TargetState[m_num_processes]();
-	m_gdb_handle = new mi_h *[m_num_processes]();
 	m_exit_code = new int[m_num_processes]();
 	m_conns_gdb = new tcp::socket *[m_num_processes]();
 	m_conns_trgt = new tcp::socket *[m_num_processes]();
-	m_separators = new Gtk::Separator *[m_num_processes]();
 	m_text_buffers_gdb = new Gtk::TextBuffer *[m_num_processes]();
 	m_text_buffers_trgt = new Gtk::TextBuffer *[m_num_processes + 1]();
 	m_scrolled_windows_gdb = new Gtk::ScrolledWindow *[m_num_processes]();
@@ -84,11 +111,36 @@ UIWindow::UIWindow(const int num_processes, const int base_port)
 	m_scroll_connections_trgt = new sigc::connection[m_num_processes];
 	m_breakpoints = new Breakpoint *[m_num_processes]();
 	m_sent_stop = new bool[m_num_processes]();
-	// allocate GDB output parsers
-	for (int rank = 0; rank < m_num_processes; ++rank)
-	{
-		m_gdb_handle[rank] = mi_alloc_h();
-	}
+	m_marker_view = nullptr;
+	m_ingest_budget = new IngestBudget(m_num_processes, rank_budget,
+									   total_budget, drop_overflow);
+	// room for every buffer a port can have in flight within the budget, so
+	// the budget and not a full ring pauses or drops the target output
+	const std::size_t max_buffers = m_ingest_budget->max_buffers(MAX_LENGTH + 8);
+	m_ingest = new IngestQueue(2 * m_num_processes, max_buffers);
+	m_buffer_pool = new BufferPool(
+		2 * m_num_processes, MAX_LENGTH + 8, max_buffers,
+		m_ingest_budget->total_buffers(MAX_LENGTH + 8));
+	m_last_allocations = 0;
+	m_last_dropped = new std::uint64_t[m_num_processes]();
+	m_metrics = new Metrics(m_num_processes);
+	m_strings = new InternTable();
+	m_last_sample = Metrics::now();
+	m_ingest_dispatcher.connect(sigc::mem_fun(*this, &UIWindow::drain_data));
+	m_send_queue = new SendQueue(2 * m_num_processes,
+								 [this]
+								 { m_send_failure_dispatcher.emit(); });
+	m_send_failure_dispatcher.connect(
+		sigc::mem_fun(*this, &UIWindow::report_send_failures));
+	const int num_workers = std::max(
+		1, std::min({m_num_processes, PARSE_MAX_WORKERS,
+					 (int)std::thread::hardware_concurrency() - 1}));
+	m_parse_pool = new ParsePool(m_num_processes, num_workers, m_buffer_pool,
+								 m_ingest_budget, m_metrics, m_strings,
+								 [this]
+								 { m_parse_dispatcher.emit(); });
+	m_parse_dispatcher.connect(
+		sigc::mem_fun(*this, &UIWindow::handle_gdb_deltas));
 }
 
 /**
@@ -99,11 +151,11 @@ UIWindow::~UIWindow()
 {
 	delete[] m_current_line;
 	delete[] m_current_file;
+	delete[] m_current_func;
 	delete[] m_target_state;
 	delete[] m_exit_code;
 	delete[] m_conns_gdb;
 	delete[] m_conns_trgt;
-	delete[] m_separators;
 	delete[] m_text_buffers_gdb;
 	delete[] m_text_buffers_trgt;
 	delete[] m_scrolled_windows_gdb;
@@ -113,11 +165,14 @@ UIWindow::~UIWindow()
 	delete[] m_scroll_connections_trgt;
 	delete[] m_breakpoints;
 	delete[] m_sent_stop;
-	for (int rank = 0; rank < m_num_processes; ++rank)
-	{
-		mi_free_h(&m_gdb_handle[rank]);
-	}
-	delete[] m_gdb_handle;
+	delete m_send_queue;
+	delete m_parse_pool;
+	delete m_ingest;
+	delete m_buffer_pool;
+	delete m_ingest_budget;
+	delete[] m_last_dropped;
+	delete m_metrics;
+	delete m_strings;
 }
 
 /**
@@ -205,60 +260,30 @@ void UIWindow::init_all_page(Gtk::Notebook *notebook)
 }
 
 /**
- * This function initializes the table-like grid layout in the overview. It adds
- * a row for process rank, running and exited states. After that columns for
- * every process are added.
- *
- * The index of the first row to use for source files ( @ref m_first_row_idx)
- * and the index of the last row ( @ref m_last_row_idx) are saved for later use.
+ * This function creates the Overview, see @ref UIOverview, and connects its
+ * zoom and group buttons. It is not described in the glade file because it is
+ * a custom widget.
  */
 void UIWindow::init_overview()
 {
-	m_overview_grid = get_widget<Gtk::Grid>("overview-grid");
-
-	int row = 0;
-
-	Gtk::Label *label;
-	Gtk::Separator *separator;
-
-	label = Gtk::manage(new Gtk::Label("Process"));
-	label->set_size_request(100, -1);
-	m_overview_grid->attach(*label, row++, 0);
-
-	separator = Gtk::manage(new Gtk::Separator);
-	separator->set_size_request(-1, 2);
-	m_overview_grid->attach(*separator, 0, row++, 2 * m_num_processes + 1, 1);
-
-	label = Gtk::manage(new Gtk::Label("Running"));
-	m_overview_grid->attach(*label, 0, row++);
-
-	separator = Gtk::manage(new Gtk::Separator);
-	separator->set_size_request(-1, 2);
-	m_overview_grid->attach(*separator, 0, row++, 2 * m_num_processes + 1, 1);
-
-	label = Gtk::manage(new Gtk::Label("Exited"));
-	m_overview_grid->attach(*label, 0, row++);
-
-	for (int rank = 0; rank < m_num_processes; ++rank)
-	{
-		separator = Gtk::manage(new Gtk::Separator);
-		separator->set_size_request(2, -1);
-		m_overview_grid->attach(*separator, 2 * rank + 1, 0, 1, 5);
-		m_separators[rank] = separator;
-
-		label = Gtk::manage(new Gtk::Label(std::to_string(rank)));
-		label->set_size_request(35, -1);
-		m_overview_grid->attach(*label, 2 * rank + 2, 0);
-
-		label = Gtk::manage(new Gtk::Label());
-		m_overview_grid->attach(*label, 2 * rank + 2, 2);
-
-		label = Gtk::manage(new Gtk::Label());
-		m_overview_grid->attach(*label, 2 * rank + 2, 4);
-	}
-
-	m_first_row_idx = row;
-	m_last_row_idx = row;
+	m_overview = Gtk::manage(new UIOverview(
+		m_num_processes, m_strings,
+		[this](const int file, const int line)
+		{ return source_line(file, line); }));
+	get_widget<Gtk::ScrolledWindow>("overview-scrolled-window")
+		->add(*m_overview);
+
+	Gtk::ToggleButton *group_button =
+		get_widget<Gtk::ToggleButton>("overview-group-button");
+	group_button->signal_toggled().connect(
+		[this, group_button]
+		{ m_overview->set_grouped(group_button->get_active()); });
+	get_widget<Gtk::Button>("overview-zoom-in-button")
+		->signal_clicked()
+		.connect(sigc::bind(sigc::mem_fun(*m_overview, &UIOverview::zoom), 1));
+	get_widget<Gtk::Button>("overview-zoom-out-button")
+		->signal_clicked()
+		.connect(sigc::bind(sigc::mem_fun(*m_overview, &UIOverview::zoom), -1));
 }
 
 /**
@@ -320,6 +345,9 @@ bool UIWindow::init(Glib::RefPtr<Gtk::Application> app)
 		sigc::mem_fun(*this, &UIWindow::on_key_press), false);
 	m_root_window->signal_delete_event().connect(
 		sigc::mem_fun(*this, &UIWindow::on_delete));
+	get_widget<Gtk::Button>("metrics-dump-button")
+		->signal_clicked()
+		.connect(sigc::mem_fun(*this, &UIWindow::dump_metrics));
 	get_widget<Gtk::Button>("follow-process-button")
 		->signal_clicked()
 		.connect(
@@ -378,8 +406,14 @@ bool UIWindow::init(Glib::RefPtr<Gtk::Application> app)
 		->add(*m_drawing_area);
 
 	m_files_notebook = get_widget<Gtk::Notebook>("files-notebook");
+	m_files_notebook->signal_switch_page().connect(
+		sigc::mem_fun(*this, &UIWindow::on_switch_page));
+	Glib::signal_timeout().connect(
+		sigc::mem_fun(*this, &UIWindow::update_allocations_timeout), 1000);
+	Glib::signal_timeout().connect(
+		sigc::mem_fun(*this, &UIWindow::update_budget_timeout), 1000);
 	Glib::signal_timeout().connect(
-		sigc::mem_fun(*this, &UIWindow::update_markers_timeout), 10);
+		sigc::mem_fun(*this, &UIWindow::update_metrics_timeout), 1000);
 
 	Gtk::Notebook *notebook_gdb =
 		get_widget<Gtk::Notebook>("gdb-output-notebook");
@@ -502,23 +536,77 @@ void UIWindow::scroll_bottom(Gtk::Allocation &,
 }
 
 /**
- * This function writes data to the TCP socket.
+ * This function queues data to be written to the TCP socket of a process. It
+ * returns immediately, the data is written by the writer thread of the
+ * SendQueue. A failed write is reported later on in the I/O text view of the
+ * process. See @ref report_send_failures.
  *
- * @param[in] socket The TCP socket.
+ * @param is_gdb Whether to send to the socat instance connected to GDB or to
+ * the target program.
+ *
+ * @param rank The process rank.
  *
  * @param[in] data The data to send.
  *
- * @return @c true if all data was sent, @c false otherwise.
+ * @return @c true if the data was queued, @c false if the process is not
+ * connected.
  */
-bool UIWindow::send_data(tcp::socket *const socket, const string &data)
+bool UIWindow::send_data(const bool is_gdb, const int rank, const string &data)
 {
-	if (nullptr == socket)
+	return m_send_queue->enqueue(is_gdb ? rank : m_num_processes + rank, data);
+}
+
+/**
+ * This function sets the TCP socket associated to a process, which is
+ * connected to the socat instance, handling the communication with GDB. The
+ * socket is also handed to the SendQueue, so commands can be queued for it.
+ *
+ * @param rank The process rank.
+ *
+ * @param[in] socket The TCP socket, or @c nullptr when the connection is
+ * closed.
+ */
+void UIWindow::set_conns_gdb(const int rank, tcp::socket *const socket)
+{
+	m_send_queue->attach(rank, socket);
+	m_conns_gdb[rank] = socket;
+}
+
+/**
+ * This function sets the TCP socket associated to a process, which is
+ * connected to the socat instance, handling the communication with the target
+ * program. The socket is also handed to the SendQueue, so commands can be
+ * queued for it.
+ *
+ * @param rank The process rank.
+ *
+ * @param[in] socket The TCP socket, or @c nullptr when the connection is
+ * closed.
+ */
+void UIWindow::set_conns_trgt(const int rank, tcp::socket *const socket)
+{
+	m_send_queue->attach(m_num_processes + rank, socket);
+	m_conns_trgt[rank] = socket;
+}
+
+/**
+ * This function appends the write failures reported by the SendQueue to the
+ * GDB or target I/O text view of the affected process.
+ */
+void UIWindow::report_send_failures()
+{
+	int idx;
+	string message;
+	m_mutex_gui.lock();
+	while (m_send_queue->pop_failure(idx, message))
 	{
-		return false;
+		const int rank = idx % m_num_processes;
+		Gtk::TextBuffer *buffer = idx < m_num_processes
+									  ? m_text_buffers_gdb[rank]
+									  : m_text_buffers_trgt[rank];
+		buffer->insert(buffer->end(), "[pgdb] Send failed: " + message + "\n");
 	}
-	std::size_t bytes_sent =
-		asio::write(*socket, asio::buffer(data, data.length()));
-	return bytes_sent == data.length();
+	m_mutex_gui.unlock();
 }
 
 /**
@@ -526,7 +614,8 @@ bool UIWindow::send_data(tcp::socket *const socket, const string &data)
  * GDB I/O section is checked. If no checkbutton is active a error message is
  * displayed.
  *
- * @param[in] socket The TCP socket.
+ * @param is_gdb Whether to send to the socat instances connected to GDB or to
+ * the target programs.
  *
  * @param[in] cmd The command to send.
  *
@@ -535,8 +624,7 @@ bool UIWindow::send_data(tcp::socket *const socket, const string &data)
  * command the states of the GDB checkbuttons are examined instead of the target
  * checkbuttons.
  */
-void UIWindow::send_data_to_active(tcp::socket *const *const socket,
-								   const string &cmd)
+void UIWindow::send_data_to_active(const bool is_gdb, const string &cmd)
 {
 	Gtk::Grid *grid = get_widget<Gtk::Grid>("gdb-send-select-grid");
 	bool one_selected = false;
@@ -550,10 +638,9 @@ void UIWindow::send_data_to_active(tcp::socket *const *const socket,
 			continue;
 		}
 		one_selected = true;
-		if (socket == m_conns_trgt ||
-			m_target_state[rank] != TargetState::RUNNING)
+		if (!is_gdb || m_target_state[rank] != TargetState::RUNNING)
 		{
-			send_data(socket[rank], cmd);
+			send_data(is_gdb, rank, cmd);
 		}
 	}
 	if (!one_selected)
@@ -574,7 +661,7 @@ void UIWindow::send_data_to_active(tcp::socket *const *const socket,
 void UIWindow::interact_with_gdb(const int key_value)
 {
 	string cmd;
-	tcp::socket **socket;
+	bool is_gdb = true;
 	switch (key_value)
 	{
 	case GDK_KEY_F4:
@@ -582,34 +669,29 @@ void UIWindow::interact_with_gdb(const int key_value)
 		return;
 	case GDK_KEY_F5:
 		cmd = "next\n";
-		socket = m_conns_gdb;
 		break;
 	case GDK_KEY_F6:
 		cmd = "step\n";
-		socket = m_conns_gdb;
 		break;
 	case GDK_KEY_F7:
 		cmd = "finish\n";
-		socket = m_conns_gdb;
 		break;
 	case GDK_KEY_F8:
 		cmd = "continue\n";
-		socket = m_conns_gdb;
 		break;
 	case GDK_KEY_F9:
 		cmd = "\3"; // Stop: ^C
-		socket = m_conns_trgt;
+		is_gdb = false;
 		break;
 	case GDK_KEY_F12:
 		cmd = "run\n";
-		socket = m_conns_gdb;
 		break;
 
 	default:
 		return;
 	}
 
-	send_data_to_active(socket, cmd);
+	send_data_to_active(is_gdb, cmd);
 }
 
 /**
@@ -639,18 +721,19 @@ bool UIWindow::on_key_press(GdkEventKey *event)
 
 /**
  * This function sends the text written in an entry ( @p entry_name ) to all
- * TCP sockets ( @p socket ), for which the corresponding checkbuttons in the
- * grid ( @p grid_name ) are active. If no checkbutton is active a error
- * message is displayed.
+ * GDB or target TCP sockets ( @p is_gdb ), for which the corresponding
+ * checkbuttons in the grid ( @p grid_name ) are active. If no checkbutton is
+ * active a error message is displayed.
  *
  * @param[in] entry_name The name of the entry to read the text from.
  *
  * @param[in] grid_name The name of the grid where the checkbuttons are stored.
  *
- * @param[in] socket A pointer to the TCP sockets array. (GDB / target)
+ * @param is_gdb Whether to send to the socat instances connected to GDB or to
+ * the target programs.
  */
 void UIWindow::send_input(const string &entry_name, const string &grid_name,
-						  tcp::socket *const *const socket)
+						  const bool is_gdb)
 {
 	Gtk::Entry *entry = get_widget<Gtk::Entry>(entry_name);
 	string cmd = string(entry->get_text()) + string("\n");
@@ -664,7 +747,7 @@ void UIWindow::send_input(const string &entry_name, const string &grid_name,
 		if (check_button->get_active())
 		{
 			one_selected = true;
-			send_data(socket[rank], cmd);
+			send_data(is_gdb, rank, cmd);
 		}
 	}
 	if (one_selected)
@@ -685,7 +768,7 @@ void UIWindow::send_input(const string &entry_name, const string &grid_name,
  */
 void UIWindow::send_input_gdb()
 {
-	send_input("gdb-send-entry", "gdb-send-select-grid", m_conns_gdb);
+	send_input("gdb-send-entry", "gdb-send-select-grid", true);
 }
 
 /**
@@ -694,7 +777,7 @@ void UIWindow::send_input_gdb()
  */
 void UIWindow::send_input_trgt()
 {
-	send_input("target-send-entry", "target-send-select-grid", m_conns_trgt);
+	send_input("target-send-entry", "target-send-select-grid", false);
 }
 
 /**
@@ -710,7 +793,7 @@ void UIWindow::stop_all(Breakpoint *breakpoint)
 		{
 			continue;
 		}
-		if (send_data(m_conns_trgt[rank], "\3"))
+		if (send_data(false, rank, "\3"))
 		{
 			m_sent_stop[rank] = true;
 		}
@@ -938,212 +1021,43 @@ void UIWindow::on_line_mark_clicked(Gtk::TextIter &iter, GdkEvent *const event,
 	}
 }
 
-/**
- * This function sets the color for the line numbers in the Overview. It uses
- * the colors specified in @ref UIDrawingArea::s_colors to highlight processes
- * that are in the same line. If there are more lines than colors, all excess
- * lines are not colored.
- *
- * The coloring is independent from file to file (row to row).
- */
-void UIWindow::color_overview()
-{
-	for (std::pair<const string, int> &pair : m_path_2_row)
-	{
-		const string &path = pair.first;
-		const int row = pair.second;
-
-		std::map<int, int> line_2_offset;
-		int color_offset = 0;
-		for (int rank = 0; rank < m_num_processes; ++rank)
-		{
-			Gtk::Label *label = dynamic_cast<Gtk::Label *>(
-				m_overview_grid->get_child_at(2 * rank + 2, row));
-			label->unset_color();
-
-			if (m_current_file[rank] != path)
-			{
-				continue;
-			}
-			if (line_2_offset.find(m_current_line[rank]) == line_2_offset.end())
-			{
-				line_2_offset[m_current_line[rank]] = color_offset++;
-			}
-			if (color_offset <= UIDrawingArea::NUM_COLORS)
-			{
-				label->override_color(
-					UIDrawingArea::s_colors[line_2_offset[m_current_line[rank]]]);
-			}
-		}
-	}
-}
-
-/**
- * This function clears all columns of a process in the Overview. This is used
- * when a process goes to the running or exited state. These have separate rows
- * where this information is displayed.
- *
- * @param rank The process rank.
- */
-void UIWindow::clear_labels_overview(const int rank)
-{
-	for (std::pair<const string, int> &pair : m_path_2_row)
-	{
-		const int row = pair.second;
-		Gtk::Label *label = dynamic_cast<Gtk::Label *>(
-			m_overview_grid->get_child_at(2 * rank + 2, row));
-		if (label)
-		{
-			label->set_text("");
-			label->set_tooltip_text("");
-		}
-	}
-}
-
 /**
  * This function updates the running and exited row for a processes. If the
  * exit code is non-zero (error) it is highlighted in red.
  *
- * It is called after a GDB response has been parsed. See @ref handle_data_gdb.
+ * It is called after a GDB response has been parsed. See @ref handle_gdb_deltas.
  */
 void UIWindow::check_overview(const int rank)
 {
-	// clear running label
-	Gtk::Label *label = dynamic_cast<Gtk::Label *>(
-		m_overview_grid->get_child_at(2 * rank + 2, 2));
-	label->set_text("");
-	label->set_tooltip_text("");
-	// clear exited label
-	label = dynamic_cast<Gtk::Label *>(
-		m_overview_grid->get_child_at(2 * rank + 2, 4));
-	label->set_text("");
-	label->set_tooltip_text("");
-	if (m_target_state[rank] == TargetState::RUNNING)
-	{
-		clear_labels_overview(rank);
-		Gtk::Label *label = dynamic_cast<Gtk::Label *>(
-			m_overview_grid->get_child_at(2 * rank + 2, 2));
-		label->set_text("R");
-		label->set_tooltip_text("Running");
-	}
-	else if (m_target_state[rank] == TargetState::EXITED)
-	{
-		clear_labels_overview(rank);
-		Gtk::Label *label = dynamic_cast<Gtk::Label *>(
-			m_overview_grid->get_child_at(2 * rank + 2, 4));
-		const string exit_code = std::to_string(m_exit_code[rank]);
-		label->set_text(exit_code);
-		label->set_tooltip_text("Exited with code: " + exit_code);
-		// highlight error exit code
-		if (0 != m_exit_code[rank])
-		{
-			label->override_color(UIDrawingArea::s_colors[0]);
-		}
-		else
-		{
-			label->unset_color();
-		}
-	}
+	m_overview->set_state(rank, m_target_state[rank], m_exit_code[rank]);
 }
 
 /**
- * This function updates all labels and their tooltip for a process.
+ * This function returns the text of a line in a source file. It is shown in
+ * the tooltips of the Overview.
  *
- * It is called after a GDB response has been parsed and a change in location
- * has been detected. See @ref handle_data_gdb.
+ * @param file The interned full path of the source file.
  *
- * @param rank The process rank.
+ * @param line The line number. This NEEDS to be a one-based index!
  *
- * @param[in] fullpath The full path of the file the process is currently
- * stopped in.
- *
- * @param line The line number in the file the process is currently
- * stopped in. This NEEDS to be a one-based index!
+ * @return The text of the line, or a notice if the file is not open.
  */
-void UIWindow::update_overview(const int rank, const string &fullpath,
-							   const int line)
+string UIWindow::source_line(const int file, const int line)
 {
-	for (std::pair<const string, int> &pair : m_path_2_row)
+	std::map<string, Gsv::View *>::iterator it =
+		m_path_2_view.find(m_strings->str(file));
+	if (it == m_path_2_view.end())
 	{
-		const string &path = pair.first;
-		const int row = pair.second;
-
-		Gtk::Label *label = dynamic_cast<Gtk::Label *>(
-			m_overview_grid->get_child_at(2 * rank + 2, row));
-		if (!label)
-		{
-			throw std::invalid_argument("Invalid row.");
-		}
-
-		// clear label and tooltip if process is not in this file
-		if (fullpath != path)
-		{
-			label->set_text("");
-			label->set_tooltip_text("");
-			continue;
-		}
-
-		// get source code from source file at line
-		string tooltip = "File not found.";
-		if (m_path_2_view.find(fullpath) != m_path_2_view.end())
-		{
-			Gtk::TextIter iter = m_path_2_view[fullpath]
-									 ->get_buffer()
-									 ->get_iter_at_line(line - 1);
-			if (iter)
-			{
-				Gtk::TextIter end = m_path_2_view[fullpath]
-										->get_buffer()
-										->get_iter_at_line(line - 1);
-				end.forward_to_line_end();
-				tooltip = iter.get_text(end);
-			}
-		}
-		label->set_tooltip_text(tooltip);
-		label->set_text(std::to_string(line));
+		return "File not found.";
 	}
-
-	color_overview();
-}
-
-/**
- * This function appends a new row for a source file to the Overview.
- *
- * @param[in] basename The basename of the source file.
- *
- * @param[in] fullpath The fullpath of the source file.
- */
-void UIWindow::append_overview_row(const string &basename,
-								   const string &fullpath)
-{
-	// append a separator line
-	Gtk::Separator *separator = Gtk::manage(new Gtk::Separator);
-	separator->set_size_request(-1, 2);
-	m_overview_grid->attach(*separator, 0, m_last_row_idx++,
-							2 * m_num_processes + 1, 1);
-	// append the file basename to the very left
-	Gtk::Label *basename_label = Gtk::manage(new Gtk::Label(basename));
-	basename_label->set_tooltip_text(fullpath);
-	m_overview_grid->attach(*basename_label, 0, m_last_row_idx);
-	// append the process column labels and separators
-	for (int rank = 0; rank < m_num_processes; ++rank)
+	Gtk::TextIter iter = it->second->get_buffer()->get_iter_at_line(line - 1);
+	if (!iter)
 	{
-		m_path_2_row[fullpath] = m_last_row_idx;
-		string text = "";
-		if (fullpath == m_current_file[rank])
-		{
-			text = std::to_string(m_current_line[rank]);
-		}
-		Gtk::Label *line_num = Gtk::manage(new Gtk::Label(text));
-		m_overview_grid->attach(*line_num, 2 * rank + 2, m_last_row_idx);
-		// prolong the vertical separators
-		m_overview_grid->remove(*dynamic_cast<Gtk::Widget *>(m_separators[rank]));
-		m_overview_grid->attach(*m_separators[rank], 2 * rank + 1, 0, 1,
-								m_last_row_idx + 1);
+		return "File not found.";
 	}
-	m_last_row_idx++;
-	m_overview_grid->show_all();
-	color_overview();
+	Gtk::TextIter end = iter;
+	end.forward_to_line_end();
+	return iter.get_text(end);
 }
 
 /**
@@ -1178,6 +1092,15 @@ void UIWindow::append_source_file(const string &fullpath, const int rank)
 	source_view->set_show_line_marks(true);
 	source_view->set_bottom_margin(30);
 	scrolled_window->add(*source_view);
+	// move the dots along when scrolling, the line positions change with the
+	// size of the view and its text
+	Glib::RefPtr<Gtk::Adjustment> adjustment = scrolled_window->get_vadjustment();
+	adjustment->signal_value_changed().connect(
+		sigc::mem_fun(*this, &UIWindow::refresh_markers));
+	adjustment->signal_changed().connect(
+		sigc::mem_fun(*this, &UIWindow::invalidate_markers));
+	source_view->signal_size_allocate().connect(
+		sigc::hide(sigc::mem_fun(*this, &UIWindow::invalidate_markers)));
 	// prepare breakpoint icon to be used on click events
 	Glib::RefPtr<Gsv::MarkAttributes> attributes =
 		Gsv::MarkAttributes::create();
@@ -1215,14 +1138,16 @@ void UIWindow::append_source_file(const string &fullpath, const int rank)
 	}
 	scrolled_window->show_all();
 	int page_num = m_files_notebook->append_page(*scrolled_window, *label);
+	// the maps must be filled before switching, on_switch_page reads them
+	const int file = m_strings->intern(fullpath);
+	m_path_2_pagenum[fullpath] = page_num;
+	m_pagenum_2_file[page_num] = file;
+	m_path_2_view[fullpath] = source_view;
+	m_overview->append_file(file);
 	if (rank == m_follow_rank || FOLLOW_ALL == m_follow_rank)
 	{
 		m_files_notebook->set_current_page(page_num);
 	}
-	m_path_2_pagenum[fullpath] = page_num;
-	m_pagenum_2_path[page_num] = fullpath;
-	m_path_2_view[fullpath] = source_view;
-	append_overview_row(basename, fullpath);
 }
 
 /**
@@ -1269,10 +1194,6 @@ void UIWindow::open_missing(Gtk::TextIter &, GdkEvent *, const string &fullpath)
 		source_view->signal_line_mark_activated().connect(sigc::bind(
 			sigc::mem_fun(*this, &UIWindow::on_line_mark_clicked), fullpath));
 		source_buffer->set_text(content);
-		for (int rank = 0; rank < m_num_processes; ++rank)
-		{
-			update_overview(rank, m_current_file[rank], m_current_line[rank]);
-		}
 	}
 }
 
@@ -1305,11 +1226,11 @@ void UIWindow::close_unused_tabs()
 	for (int page_num = 0; page_num < num_pages; ++page_num)
 	{
 		bool is_used = false;
-		string fullpath = m_pagenum_2_path[page_num];
+		const int file = m_pagenum_2_file[page_num];
 		// check if the source file contains a process
 		for (int rank = 0; rank < m_num_processes; ++rank)
 		{
-			if (m_current_file[rank] == fullpath)
+			if (m_current_file[rank] == file)
 			{
 				is_used = true;
 				break;
@@ -1349,15 +1270,11 @@ void UIWindow::close_unused_tabs()
 	{
 		const int page_num = *rit;
 		m_files_notebook->remove_page(page_num);
-		const string fullpath = m_pagenum_2_path[page_num];
-		m_overview_grid->remove_row(m_path_2_row[fullpath]);
-		m_overview_grid->remove_row(m_path_2_row[fullpath] - 1);
-		m_last_row_idx -= 2;
+		m_overview->remove_file(m_pagenum_2_file[page_num]);
 	}
 	// clear lookup maps
 	m_path_2_pagenum.clear();
-	m_path_2_row.clear();
-	m_pagenum_2_path.clear();
+	m_pagenum_2_file.clear();
 	m_path_2_view.clear();
 	m_opened_files.clear();
 	// rebuild lookup maps
@@ -1374,11 +1291,13 @@ void UIWindow::close_unused_tabs()
 		string fullpath = label->get_tooltip_text();
 
 		m_path_2_pagenum[fullpath] = page_num;
-		m_path_2_row[fullpath] = m_first_row_idx + (2 * page_num) + 1;
-		m_pagenum_2_path[page_num] = fullpath;
+		m_pagenum_2_file[page_num] = m_strings->intern(fullpath);
 		m_path_2_view[fullpath] = source_view;
 		m_opened_files.insert(fullpath);
 	}
+	// the cached line positions may belong to a closed view
+	m_marker_view = nullptr;
+	refresh_markers();
 }
 
 /**
@@ -1386,6 +1305,10 @@ void UIWindow::close_unused_tabs()
  * process. If the process is currently not in this file or running/exited the
  * dots position is set out of the visible area.
  *
+ * The positions of the lines in the source view are cached in
+ * @ref m_line_2_y, they do not change with scrolling. The drawing area is only
+ * redrawn if a dot moved.
+ *
  * @param page_num The page number of the currently open notebook page.
  */
 void UIWindow::update_markers(const int page_num)
@@ -1394,45 +1317,95 @@ void UIWindow::update_markers(const int page_num)
 		m_files_notebook->get_nth_page(page_num));
 	Gsv::View *source_view =
 		dynamic_cast<Gsv::View *>(scrolled_window->get_child());
+	std::map<int, int>::const_iterator file_it = m_pagenum_2_file.find(page_num);
+	// a new page before it is registered, or a view without a layout, the
+	// size allocation of the view invalidates the markers again
+	if (file_it == m_pagenum_2_file.end() ||
+		source_view->get_allocated_height() <= 1)
+	{
+		return;
+	}
+	if (source_view != m_marker_view)
+	{
+		m_line_2_y.clear();
+		m_marker_view = source_view;
+	}
 	Glib::RefPtr<Gsv::Buffer> source_buffer = source_view->get_source_buffer();
 	Glib::RefPtr<Gtk::Adjustment> adjustment = scrolled_window->get_vadjustment();
-	string page_path = m_pagenum_2_path[page_num];
-	int offset = m_files_notebook->get_height() - scrolled_window->get_height();
+	const int page_file = file_it->second;
+	int offset = m_files_notebook->get_height() - scrolled_window->get_height() -
+				 int(adjustment->get_value());
+	bool moved = false;
 	for (int rank = 0; rank < m_num_processes; ++rank)
 	{
-		Gtk::TextIter line_iter =
-			source_buffer->get_iter_at_line(m_current_line[rank] - 1);
-		if (!line_iter || page_path != m_current_file[rank] ||
-			m_target_state[rank] != TargetState::STOPPED)
+		// out of visible area
+		int draw_pos = -3 * UIDrawingArea::radius();
+		if (page_file == m_current_file[rank] &&
+			m_target_state[rank] == TargetState::STOPPED)
 		{
-			// set out of visible area
-			m_drawing_area->set_y_offset(
-				rank, -3 * UIDrawingArea::radius());
-			continue;
+			const int line = m_current_line[rank];
+			std::map<int, int>::iterator it = m_line_2_y.find(line);
+			if (it == m_line_2_y.end())
+			{
+				// -1 if the line is not in the buffer
+				int line_y = -1;
+				Gtk::TextIter line_iter = source_buffer->get_iter_at_line(line - 1);
+				if (line_iter)
+				{
+					Gdk::Rectangle rect;
+					source_view->get_iter_location(line_iter, rect);
+					line_y = rect.get_y();
+				}
+				it = m_line_2_y.emplace(line, line_y).first;
+			}
+			if (it->second >= 0)
+			{
+				draw_pos = offset + it->second;
+			}
 		}
-		Gdk::Rectangle rect;
-		source_view->get_iter_location(line_iter, rect);
-		int draw_pos = offset + rect.get_y() - int(adjustment->get_value());
-		m_drawing_area->set_y_offset(rank, draw_pos);
+		moved |= m_drawing_area->set_y_offset(rank, draw_pos);
+	}
+	if (moved)
+	{
+		m_drawing_area->queue_draw();
 	}
-	m_drawing_area->queue_draw();
 }
 
 /**
- * This function checks if the source file notebook has pages and if so
- * updates the dots position. It is called periodically by Gtk. See @ref init.
- *
- * @return @c true. The return value is used to indicate whether the event is
- * completely handled.
+ * This function updates the dots for the current page of the source file
+ * notebook, if it has pages. It is called when the processes stopped or
+ * started running and when the source view is scrolled, there is no periodic
+ * update.
  */
-bool UIWindow::update_markers_timeout()
+void UIWindow::refresh_markers()
 {
 	int page_num = m_files_notebook->get_current_page();
 	if (page_num >= 0)
 	{
 		update_markers(page_num);
 	}
-	return true;
+}
+
+/**
+ * This function drops the cached positions of the lines and updates the dots.
+ * It is called when the size of a source view or the height of its text
+ * changes.
+ */
+void UIWindow::invalidate_markers()
+{
+	m_line_2_y.clear();
+	refresh_markers();
+}
+
+/**
+ * This function updates the dots for the page the source file notebook
+ * switches to.
+ *
+ * @param page_num The page number of the new page.
+ */
+void UIWindow::on_switch_page(Gtk::Widget *, guint page_num)
+{
+	update_markers(page_num);
 }
 
 /**
@@ -1442,7 +1415,8 @@ bool UIWindow::update_markers_timeout()
  */
 void UIWindow::do_scroll(const int rank) const
 {
-	Gsv::View *source_view = m_path_2_view.at(m_current_file[rank]);
+	Gsv::View *source_view =
+		m_path_2_view.at(m_strings->str(m_current_file[rank]));
 	Gtk::TextIter iter =
 		source_view->get_buffer()->get_iter_at_line(m_current_line[rank] - 1);
 	if (!iter)
@@ -1471,165 +1445,132 @@ void UIWindow::scroll_to_line(const int rank) const
  * This function updates the current line and file for a process.
  *
  * It is called after a GDB response has been parsed and a change in location
- * has been detected. See @ref handle_data_gdb.
+ * has been detected. See @ref handle_gdb_deltas.
  *
  * @param rank The process rank.
  *
- * @param[in] fullpath The full path of the file the process is currently
+ * @param file The interned full path of the file the process is currently
  * stopped in.
  *
+ * @param func The interned name of the function the process is currently
+ * stopped in, or @ref INTERN_NONE if unknown.
+ *
  * @param line The line number in the file the process is currently
  * stopped in. This NEEDS to be a one-based index!
  */
-void UIWindow::set_position(const int rank, const string &fullpath,
+void UIWindow::set_position(const int rank, const int file, const int func,
 							const int line)
 {
-	m_current_file[rank] = fullpath;
+	m_current_file[rank] = file;
+	m_current_func[rank] = func;
 	m_current_line[rank] = line;
-	update_overview(rank, fullpath, line);
+	m_overview->set_position(rank, file, func, line);
 }
 
 /**
- * This function parses the GDB output for printable output and state changes of
- * the target program.
- *
- * @param[in] first_output A pointer to the first output in the list of outputs
- * sent by GDB.
+ * This function applies printable GDB output and state changes of the target
+ * program.
  *
- * @param rank The process rank the GDB output originates from.
+ * @param[in] delta The state changes parsed from a GDB response.
  */
-void UIWindow::parse_target_state(mi_output *first_output, const int rank)
+void UIWindow::apply_target_state(const GdbDelta &delta)
 {
-	Gtk::TextBuffer *buffer = m_text_buffers_gdb[rank];
-	mi_output *current_output = first_output;
-	while (nullptr != current_output)
+	const int rank = delta.rank;
+	if (TargetState::RUNNING == delta.state)
 	{
-		if (MI_CL_RUNNING == current_output->tclass)
-		{
-			m_target_state[rank] = TargetState::RUNNING;
-			m_current_file[rank] = "";
-		}
-		else if (MI_CL_STOPPED == current_output->tclass)
-		{
-			m_target_state[rank] = TargetState::STOPPED;
-			m_sent_stop[rank] = false;
-		}
-		if (current_output->type == MI_T_OUT_OF_BAND &&
-			current_output->stype == MI_ST_STREAM)
+		m_target_state[rank] = TargetState::RUNNING;
+		m_current_file[rank] = INTERN_NONE;
+	}
+	else if (TargetState::STOPPED == delta.state)
+	{
+		m_target_state[rank] = TargetState::STOPPED;
+		m_sent_stop[rank] = false;
+	}
+	if (!delta.text.empty())
+	{
+		Gtk::TextBuffer *buffer = m_text_buffers_gdb[rank];
+		const std::uint64_t start = Metrics::now();
+		buffer->insert(buffer->end(), delta.text);
+		m_metrics->insert.record(Metrics::now() - start);
+		Gtk::ScrolledWindow *scrolled_window = m_scrolled_windows_gdb[rank];
+		if (m_scroll_connections_gdb[rank].empty())
 		{
-			char *text = get_cstr(current_output);
-			if (text)
-			{
-				buffer->insert(buffer->end(), text);
-			}
+			m_scroll_connections_gdb[rank] =
+				scrolled_window->signal_size_allocate().connect(
+					sigc::bind(sigc::mem_fun(*this, &UIWindow::scroll_bottom),
+							   scrolled_window, true, rank));
 		}
-		current_output = current_output->next;
 	}
 }
 
 /**
- * This function searches for a breakpoint record in the GDB output. When
- * found, the number (ID) of the breakpoint is saved. It is needed to delete the
- * breakpoint later on.
- *
- * @param[in] first_output A pointer to the first output in the list of outputs
- * sent by GDB.
+ * This function stores the number (ID) of a created breakpoint, if a
+ * breakpoint is waiting for it. It is needed to delete the breakpoint later
+ * on.
  *
- * @param rank The process rank the GDB output originates from.
+ * @param[in] delta The state changes parsed from a GDB response.
  */
-void UIWindow::parse_breakpoint(mi_output *first_output, const int rank)
+void UIWindow::apply_breakpoint(const GdbDelta &delta)
 {
-	if (nullptr == m_breakpoints[rank])
+	const int rank = delta.rank;
+	if (nullptr == m_breakpoints[rank] || 0 == delta.bkpt_number)
 	{
 		return;
 	}
-	mi_bkpt *breakpoint = mi_res_bkpt(first_output);
-	if (breakpoint)
-	{
-		m_breakpoints[rank]->set_number(rank, breakpoint->number);
-		m_bkptno_2_bkpt[rank][breakpoint->number] = m_breakpoints[rank];
-		m_breakpoints[rank] = nullptr;
-	}
-	mi_free_bkpt(breakpoint);
+	m_breakpoints[rank]->set_number(rank, delta.bkpt_number);
+	m_bkptno_2_bkpt[rank][delta.bkpt_number] = m_breakpoints[rank];
+	m_breakpoints[rank] = nullptr;
 }
 
 /**
- * This function searches for a stop record and extracts information from it.
- * This includes current file, line and when exited, the exit code.
- *
- * @param[in] first_output A pointer to the first output in the list of outputs
- * sent by GDB.
+ * This function applies the information extracted from a stop record. This
+ * includes current file, line and when exited, the exit code.
  *
- * @param rank The process rank the GDB output originates from.
+ * @param[in] delta The state changes parsed from a GDB response.
  */
-void UIWindow::parse_stop_record(mi_output *first_output, const int rank)
+void UIWindow::apply_stop_record(const GdbDelta &delta)
 {
-	mi_stop *stop_record = mi_res_stop(first_output);
-	if (stop_record)
+	const int rank = delta.rank;
+	if (delta.bkptno > 1 &&
+		m_bkptno_2_bkpt[rank].find(delta.bkptno) !=
+			m_bkptno_2_bkpt[rank].end() &&
+		m_bkptno_2_bkpt[rank][delta.bkptno]->get_stop_all())
 	{
-		if (stop_record->have_bkptno && stop_record->bkptno > 1 &&
-			m_bkptno_2_bkpt[rank].find(stop_record->bkptno) !=
-				m_bkptno_2_bkpt[rank].end() &&
-			m_bkptno_2_bkpt[rank][stop_record->bkptno]->get_stop_all())
-		{
-			stop_all(m_bkptno_2_bkpt[rank][stop_record->bkptno]);
-		}
-		if (mi_stop_reason::sr_exited_signalled == stop_record->reason ||
-			mi_stop_reason::sr_exited == stop_record->reason ||
-			mi_stop_reason::sr_exited_normally == stop_record->reason)
-		{
-			m_target_state[rank] = TargetState::EXITED;
-			m_current_file[rank] = "";
-			m_exit_code[rank] = stop_record->exit_code;
-			clear_labels_overview(rank);
-		}
-		if (stop_record->frame && stop_record->frame->fullname)
-		{
-			const string fullpath = stop_record->frame->fullname;
-			// this index is one-based!
-			const int line = stop_record->frame->line;
-			set_position(rank, fullpath, line);
-			append_source_file(fullpath, rank);
-			scroll_to_line(rank);
-		}
+		stop_all(m_bkptno_2_bkpt[rank][delta.bkptno]);
+	}
+	if (delta.exited)
+	{
+		m_target_state[rank] = TargetState::EXITED;
+		m_current_file[rank] = INTERN_NONE;
+		m_exit_code[rank] = delta.exit_code;
+	}
+	if (INTERN_NONE != delta.file)
+	{
+		set_position(rank, delta.file, delta.func, delta.line);
+		append_source_file(m_strings->str(delta.file), rank);
+		scroll_to_line(rank);
 	}
-	mi_free_stop(stop_record);
 }
 
 /**
- * This function tokenizes the received GDB output and feeds it to the output
- * parser. The resulting response objects are then analyzed and based on that
- * states are updated.
- *
- * @param[in] data The received GDB output.
- *
- * @param rank The process rank.
+ * This function applies the state changes which the ParsePool extracted from
+ * the GDB output since the last call. The GDB output itself is framed and
+ * parsed on the worker threads, so only the resulting deltas are handled on
+ * the GUI thread.
  */
-void UIWindow::handle_data_gdb(const char *const data, const int rank)
+void UIWindow::handle_gdb_deltas()
 {
-	char *token = strtok((char *)data, "\n");
-	while (nullptr != token)
+	m_mutex_gui.lock();
+	for (const GdbDelta &delta : m_parse_pool->take_deltas())
 	{
-		int token_length = strlen(token);
-		// token[token_length]: '\n', replaced with '\0' by strtok
-		if (token[token_length - 1] == '\r')
-		{
-			token[token_length - 1] = '\0';
-		}
-		m_gdb_handle[rank]->line = token;
-		int response = mi_get_response(m_gdb_handle[rank]);
-		if (0 != response)
-		{
-			mi_output *first_output = mi_retire_response(m_gdb_handle[rank]);
-			parse_target_state(first_output, rank);
-			parse_stop_record(first_output, rank);
-			parse_breakpoint(first_output, rank);
-			mi_free_output(first_output);
-		}
-		token = strtok(nullptr, "\n");
+		apply_target_state(delta);
+		apply_stop_record(delta);
+		apply_breakpoint(delta);
+		check_overview(delta.rank);
+		m_metrics->read_to_ui.record(Metrics::now() - delta.received);
 	}
-	m_gdb_handle[rank]->line = nullptr;
-	check_overview(rank);
+	refresh_markers();
+	m_mutex_gui.unlock();
 }
 
 /**
@@ -1641,56 +1582,305 @@ void UIWindow::handle_data_gdb(const char *const data, const int rank)
  */
 void UIWindow::handle_data_trgt(const char *const data, const int rank)
 {
+	const std::uint64_t start = Metrics::now();
 	Gtk::TextBuffer *buffer = m_text_buffers_trgt[rank];
 	buffer->insert(buffer->end(), data);
 	buffer = m_text_buffers_trgt[m_num_processes];
 	buffer->insert(buffer->end(), "-----" + std::to_string(rank) + "-----\n");
 	buffer->insert(buffer->end(), data);
+	m_metrics->insert.record(Metrics::now() - start);
 }
 
 /**
- * This function forwards the received data to the corresponding data handler.
- * When the data has been handled it is freed.
+ * This function appends received target output to its text view and makes
+ * sure the view is scrolled to the bottom.
  *
  * @param[in] data The received text.
  *
+ * @param length The length of the received text in bytes.
+ *
  * @param port The originating TCP port.
  */
-void UIWindow::handle_data(const char *const data, const int port)
+void UIWindow::handle_data(char *const data, const std::size_t,
+						   const int port)
 {
 	const int rank = get_rank(port);
-	const bool is_gdb = src_is_gdb(port);
 
 	m_mutex_gui.lock();
 
-	if (is_gdb)
+	handle_data_trgt(data, rank);
+	Gtk::ScrolledWindow *scrolled_window = m_scrolled_windows_trgt[rank];
+	if (m_scroll_connections_trgt[rank].empty())
 	{
-		handle_data_gdb(data, rank);
-		Gtk::ScrolledWindow *scrolled_window = m_scrolled_windows_gdb[rank];
-		if (m_scroll_connections_gdb[rank].empty())
+		m_scroll_connections_trgt[rank] =
+			scrolled_window->signal_size_allocate().connect(
+				sigc::bind(sigc::mem_fun(*this, &UIWindow::scroll_bottom),
+						   scrolled_window, false, rank));
+	}
+
+	m_mutex_gui.unlock();
+}
+
+/**
+ * This function queues received data. It is called from the threads reading
+ * from the TCP sockets. GDB output goes to the ParsePool, target output is
+ * queued for the GUI thread. Only the first chunk after a drain wakes up the
+ * GUI thread, all following chunks are picked up by the same drain.
+ *
+ * The buffer is accounted in the IngestBudget until it is released again.
+ * If target output is dropped on overflow and the budget is exceeded, the
+ * buffer is not taken and the reading thread reads into it again. So only the
+ * threads handling the data return buffers to the pool.
+ *
+ * @param[in] data The received text, stored in a buffer taken from
+ * @ref acquire_buffer.
+ *
+ * @param length The length of the received text in bytes.
+ *
+ * @param port The originating TCP port.
+ *
+ * @return @c true if the queue took ownership of the buffer, @c false if the
+ * data was dropped or the ingest is stopped and the buffer stays with the
+ * caller.
+ */
+bool UIWindow::push_data(char *const data, const std::size_t length,
+						 const int port)
+{
+	const int rank = get_rank(port);
+	const std::uint64_t received = Metrics::now();
+	m_metrics->count_read(rank, length);
+	const std::size_t buffer_size = m_buffer_pool->buffer_size();
+	if (src_is_gdb(port))
+	{
+		m_ingest_budget->charge(rank, buffer_size);
+		m_parse_pool->push(rank, data, length, received);
+		return true;
+	}
+	if (!m_ingest_budget->drop_overflow())
+	{
+		m_ingest_budget->charge(rank, buffer_size);
+	}
+	else if (!m_ingest_budget->try_charge(rank, buffer_size, length))
+	{
+		return false;
+	}
+	bool wakeup;
+	if (!m_ingest->push(port - m_base_port,
+						IngestChunk{data, length, port, received}, wakeup))
+	{
+		// the GUI thread stopped, see stop_ingest
+		m_ingest_budget->release(rank, buffer_size);
+		return false;
+	}
+	if (wakeup)
+	{
+		m_ingest_dispatcher.emit();
+	}
+	return true;
+}
+
+/**
+ * This function hands all pending received data to @ref handle_data. To keep
+ * the GUI responsive a drain stops after @ref INGEST_BUDGET_US microseconds.
+ * The remaining data is then handled in an idle callback, which runs after
+ * Gtk had the chance to redraw the window. So the main loop is woken up at
+ * most once per frame, independent of the number of received chunks.
+ */
+void UIWindow::drain_data()
+{
+	const std::chrono::steady_clock::time_point deadline =
+		std::chrono::steady_clock::now() +
+		std::chrono::microseconds(INGEST_BUDGET_US);
+	IngestChunk chunk;
+	while (m_ingest->pop(chunk))
+	{
+		handle_data(chunk.data, chunk.length, chunk.port);
+		release_buffer(chunk.data, chunk.port);
+		m_ingest_budget->release(get_rank(chunk.port),
+								 m_buffer_pool->buffer_size());
+		m_metrics->read_to_ui.record(Metrics::now() - chunk.received);
+		if (std::chrono::steady_clock::now() >= deadline)
 		{
-			m_scroll_connections_gdb[rank] =
-				scrolled_window->signal_size_allocate().connect(
-					sigc::bind(sigc::mem_fun(*this, &UIWindow::scroll_bottom),
-							   scrolled_window, is_gdb, rank));
+			break;
 		}
 	}
-	else
+	if (m_ingest->rearm())
+	{
+		m_metrics->idle_scheduled();
+		Glib::signal_idle().connect_once(
+			sigc::mem_fun(*this, &UIWindow::drain_data_idle));
+	}
+}
+
+/**
+ * This function continues a drain, which ran out of time, from an idle
+ * callback. See @ref drain_data.
+ */
+void UIWindow::drain_data_idle()
+{
+	m_metrics->idle_ran();
+	drain_data();
+}
+
+/**
+ * This function takes a receive buffer for a TCP port from the buffer pool.
+ * It is called from the thread reading from the TCP socket before each read.
+ * As long as the process exceeds its ingest budget, this function blocks, so
+ * no more data is read from the socket. Target output which is dropped on
+ * overflow is never blocked.
+ *
+ * @param port The TCP port.
+ *
+ * @return A buffer of @ref MAX_LENGTH + 8 bytes.
+ */
+char *UIWindow::acquire_buffer(const int port)
+{
+	if (src_is_gdb(port) || !m_ingest_budget->drop_overflow())
+	{
+		m_ingest_budget->wait_for_room(get_rank(port));
+	}
+	return m_buffer_pool->acquire(port - m_base_port);
+}
+
+/**
+ * This function returns a receive buffer of a TCP port to the buffer pool,
+ * after its content has been handled. It is only called by the thread handling
+ * the data of the port, see BufferPool::release.
+ *
+ * @param[in] buffer The buffer, previously taken with @ref acquire_buffer.
+ *
+ * @param port The TCP port.
+ */
+void UIWindow::release_buffer(char *const buffer, const int port)
+{
+	m_buffer_pool->release(port - m_base_port, buffer);
+}
+
+/**
+ * This function deallocates a receive buffer, which a reading thread no longer
+ * needs, e.g. when the connection is closed. Unlike @ref release_buffer it is
+ * safe to call from the reading thread.
+ *
+ * @param[in] buffer The buffer, previously taken with @ref acquire_buffer.
+ */
+void UIWindow::discard_buffer(char *const buffer)
+{
+	m_buffer_pool->discard(buffer);
+}
+
+/**
+ * This function wakes up the reading threads paused by the ingest budget or a
+ * full IngestQueue and stops pausing them, the received target output is
+ * dropped from now on. It is called once the GUI thread no longer processes
+ * the received data, so these threads cannot wait forever.
+ */
+void UIWindow::stop_ingest()
+{
+	m_ingest->close();
+	m_ingest_budget->close();
+}
+
+/**
+ * This function displays the number of receive buffers allocated during the
+ * last second. Once every port has its buffers, this drops to zero. It is
+ * called periodically by Gtk. See @ref init.
+ *
+ * @return @c true. The return value is used to indicate whether the event is
+ * completely handled.
+ */
+bool UIWindow::update_allocations_timeout()
+{
+	const std::uint64_t allocations = m_buffer_pool->allocations();
+	get_widget<Gtk::Label>("receive-allocations-label")
+		->set_text("Receive Allocations: " +
+				   std::to_string(allocations - m_last_allocations) + "/s");
+	m_last_allocations = allocations;
+	return true;
+}
+
+/**
+ * This function displays the amount of received data waiting to be processed
+ * and the number of paused connections. Target output dropped since the last
+ * call is summarised in the target I/O text view of the process. It is called
+ * periodically by Gtk. See @ref init.
+ *
+ * @return @c true. The return value is used to indicate whether the event is
+ * completely handled.
+ */
+bool UIWindow::update_budget_timeout()
+{
+	std::uint64_t dropped_total = 0;
+	for (int rank = 0; rank < m_num_processes; ++rank)
 	{
-		handle_data_trgt(data, rank);
-		Gtk::ScrolledWindow *scrolled_window = m_scrolled_windows_trgt[rank];
-		if (m_scroll_connections_trgt[rank].empty())
+		const std::uint64_t dropped = m_ingest_budget->dropped(rank);
+		dropped_total += dropped;
+		if (dropped == m_last_dropped[rank])
 		{
-			m_scroll_connections_trgt[rank] =
-				scrolled_window->signal_size_allocate().connect(
-					sigc::bind(sigc::mem_fun(*this, &UIWindow::scroll_bottom),
-							   scrolled_window, is_gdb, rank));
+			continue;
 		}
+		Gtk::TextBuffer *buffer = m_text_buffers_trgt[rank];
+		buffer->insert(buffer->end(),
+					   "[pgdb] Output exceeded the budget, " +
+						   std::to_string(dropped - m_last_dropped[rank]) +
+						   " bytes dropped.\n");
+		m_last_dropped[rank] = dropped;
 	}
+	string text =
+		"Queued: " + std::to_string(m_ingest_budget->total() >> 10) + " KiB";
+	const int num_throttled = m_ingest_budget->num_throttled();
+	if (num_throttled > 0)
+	{
+		text += ", Paused: " + std::to_string(num_throttled);
+	}
+	if (dropped_total > 0)
+	{
+		text += ", Dropped: " + std::to_string(dropped_total >> 10) + " KiB";
+	}
+	get_widget<Gtk::Label>("ingest-budget-label")->set_text(text);
+	return true;
+}
 
-	free((void *)data);
+/**
+ * This function samples the metrics of the receive pipeline. If the metrics
+ * page is visible, it is updated with the busiest processes. It is called
+ * periodically by Gtk. See @ref init.
+ *
+ * @return @c true. The return value is used to indicate whether the event is
+ * completely handled.
+ */
+bool UIWindow::update_metrics_timeout()
+{
+	const std::uint64_t now = Metrics::now();
+	m_metrics->sample((now - m_last_sample) / 1e9);
+	m_last_sample = now;
+	Gtk::Stack *stack = get_widget<Gtk::Stack>("view-stack");
+	if ("metrics" == stack->get_visible_child_name())
+	{
+		get_widget<Gtk::TextView>("metrics-text-view")
+			->get_buffer()
+			->set_text(m_metrics->report(METRICS_MAX_RANKS));
+	}
+	return true;
+}
 
-	m_mutex_gui.unlock();
+/**
+ * This function shows a save file dialog and writes the metrics of all
+ * processes to the selected file.
+ */
+void UIWindow::dump_metrics()
+{
+	Gtk::FileChooserDialog dialog(*m_root_window, "Select Save Location",
+								  Gtk::FILE_CHOOSER_ACTION_SAVE);
+	dialog.add_button("Cancel", Gtk::RESPONSE_CANCEL);
+	dialog.add_button("Save", Gtk::RESPONSE_OK);
+	if (Gtk::RESPONSE_OK != dialog.run())
+	{
+		return;
+	}
+	std::ofstream file(dialog.get_filename());
+	file << m_metrics->report(m_num_processes);
+	file << "\nReceive Buffers Allocated: " << m_buffer_pool->allocations()
+		 << "\nQueued Bytes: " << m_ingest_budget->total() << "\n";
 }
 
 /**
@@ -32,14 +32,23 @@
 #include <set>
 #include <map>
 #include <iosfwd>
+#include <cstdint>
 
 #include "asio.hpp"
+#include "target_state.hpp"
+#include "buffer_pool.hpp"
 
 class Breakpoint;
 class UIDrawingArea;
+class UIOverview;
+class IngestQueue;
+class SendQueue;
+class ParsePool;
+class IngestBudget;
+class Metrics;
+class InternTable;
+struct GdbDelta;
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-typedef struct mi_h_struct mi_h;
-typedef struct mi_output_struct mi_output;
 namespace Gsv
 {
 	class View;
@@ -47,19 +56,6 @@ namespace Gsv
 }
 #endif /* DOXYGEN_SHOULD_SKIP_THIS */
 
-/// The states a process can be in.
-enum TargetState
-{
-	/** The target state has not been detected yet. */
-	UNKNOWN,
-	/** The target is stopped. */
-	STOPPED,
-	/** The target is running. */
-	RUNNING,
-	/** The target has exited. */
-	EXITED
-};
-
 /// Wrapper class for the GUI window.
 /**
  * This is the wrapper class for the GUI window. It contains the functionality
@@ -73,12 +69,11 @@ class UIWindow
 	const int m_base_port;
 
 	int *m_current_line;
-	std::string *m_current_file;
+	int *m_current_file;
+	int *m_current_func;
 	TargetState *m_target_state;
 	int *m_exit_code;
 
-	mi_h **m_gdb_handle;
-
 	Glib::RefPtr<Gtk::Builder> m_builder;
 	Gtk::Window *m_root_window;
 	Glib::RefPtr<Gtk::Application> m_app;
@@ -86,10 +81,7 @@ class UIWindow
 	Gtk::Notebook *m_files_notebook;
 	UIDrawingArea *m_drawing_area;
 
-	Gtk::Grid *m_overview_grid;
-	Gtk::Separator **m_separators;
-	int m_first_row_idx;
-	int m_last_row_idx;
+	UIOverview *m_overview;
 
 	Gtk::TextBuffer **m_text_buffers_gdb;
 	Gtk::TextBuffer **m_text_buffers_trgt;
@@ -98,9 +90,10 @@ class UIWindow
 
 	std::set<std::string> m_opened_files;
 	std::map<std::string, int> m_path_2_pagenum;
-	std::map<int, std::string> m_pagenum_2_path;
+	std::map<int, int> m_pagenum_2_file;
 	std::map<std::string, Gsv::View *> m_path_2_view;
-	std::map<std::string, int> m_path_2_row;
+	Gsv::View *m_marker_view;
+	std::map<int, int> m_line_2_y;
 	std::map<int, Breakpoint *> *m_bkptno_2_bkpt;
 	std::map<std::string, sigc::connection> m_path_2_connection;
 
@@ -109,13 +102,27 @@ class UIWindow
 
 	std::mutex m_mutex_gui;
 
+	IngestQueue *m_ingest;
+	Glib::Dispatcher m_ingest_dispatcher;
+	BufferPool *m_buffer_pool;
+	std::uint64_t m_last_allocations;
+	IngestBudget *m_ingest_budget;
+	std::uint64_t *m_last_dropped;
+	Metrics *m_metrics;
+	InternTable *m_strings;
+	std::uint64_t m_last_sample;
+	SendQueue *m_send_queue;
+	Glib::Dispatcher m_send_failure_dispatcher;
+	ParsePool *m_parse_pool;
+	Glib::Dispatcher m_parse_dispatcher;
+
 	asio::ip::tcp::socket **m_conns_gdb;
 	asio::ip::tcp::socket **m_conns_trgt;
 
 	Breakpoint **m_breakpoints;
 	bool *m_sent_stop;
 
-	/// Initializes the table-like grid layout in the overview.
+	/// Creates the Overview and connects its buttons.
 	void init_overview();
 	/// Attaches checkbuttons in a grid layout.
 	void init_grid(Gtk::Grid *grid);
@@ -129,27 +136,41 @@ class UIWindow
 	void do_scroll(const int rank) const;
 	/// Appends scrolling a scrolled window to the Gdk idle handler.
 	void scroll_to_line(const int rank) const;
-	/// Appends a new row for a source file to the Overview.
-	void append_overview_row(const std::string &basename,
-							 const std::string &fullpath);
 	/// Appends a source file page to the source view notebook.
 	void append_source_file(const std::string &fullpath, const int rank);
-	/// Tokenizes, parses and analyzes the received GDB output.
-	void handle_data_gdb(const char *const data, const int rank);
+	/// Applies the state changes parsed from the GDB output.
+	void handle_gdb_deltas();
 	/// Appends text to the target I/O text view.
 	void handle_data_trgt(const char *const data, const int rank);
+	/// Hands all pending received data to the data handler.
+	void drain_data();
+	/// Continues a drain from an idle callback.
+	void drain_data_idle();
+	/// Displays the number of receive buffer allocations per second.
+	bool update_allocations_timeout();
+	/// Displays the ingest budget state and summarises dropped output.
+	bool update_budget_timeout();
+	/// Samples the metrics and updates the metrics page.
+	bool update_metrics_timeout();
+	/// Writes the metrics of all processes to a file.
+	void dump_metrics();
+	/// Appends the reported write failures to the I/O text views.
+	void report_send_failures();
 	/// Sets the positions of the dots in the drawing area.
 	void update_markers(const int page_num);
-	/// Checks if the source file notebook has pages and updates the dots if so.
-	bool update_markers_timeout();
+	/// Updates the dots for the current page of the source file notebook.
+	void refresh_markers();
+	/// Drops the cached line positions and updates the dots.
+	void invalidate_markers();
+	/// Signal handler for switching the page of the source file notebook.
+	void on_switch_page(Gtk::Widget *, guint page_num);
 	/// Scrolls a scrolled window to the bottom.
 	void scroll_bottom(Gtk::Allocation &,
 					   Gtk::ScrolledWindow *const scrolled_window,
 					   const bool is_gdb, const int rank);
 	/// Writes the text in an entry to a TCP socket.
 	void send_input(const std::string &entry_name,
-					const std::string &grid_name,
-					asio::ip::tcp::socket *const *const socket);
+					const std::string &grid_name, const bool is_gdb);
 	/// Sends text to the socat instances connected to GDB.
 	void send_input_gdb();
 	/// Sends text to the socat instances connected to the target program.
@@ -180,8 +201,7 @@ class UIWindow
 	void on_line_mark_clicked(Gtk::TextIter &iter, GdkEvent *const event,
 							  const std::string &fullpath);
 	/// Sends data to all selected processes.
-	void send_data_to_active(asio::ip::tcp::socket *const *const socket,
-							 const std::string &cmd);
+	void send_data_to_active(const bool is_gdb, const std::string &cmd);
 	/// Maps the buttons/hot-keys to the corresponding action.
 	void interact_with_gdb(const int key_value);
 	/// Displays the about dialog.
@@ -194,15 +214,10 @@ class UIWindow
 	void on_interaction_button_clicked(const int key_value);
 	/// Signal handler for key-press events.
 	bool on_key_press(GdkEventKey *event);
-	/// Clears all columns of a process in the Overview.
-	void clear_labels_overview(const int rank);
-	/// Sets the color for the line numbers in the Overview.
-	void color_overview();
-	/// Updates all labels and their tooltip for a process.
-	void update_overview(const int rank, const std::string &fullpath,
-						 const int line);
+	/// Returns the text of a line in a source file.
+	std::string source_line(const int file, const int line);
 	/// Updates the current line and file for a process.
-	void set_position(const int rank, const std::string &fullpath,
+	void set_position(const int rank, const int file, const int func,
 					  const int line);
 	/// Open a source file in the source view notebook.
 	void open_file();
@@ -212,12 +227,12 @@ class UIWindow
 	void check_overview(const int rank);
 	/// Opens a file for a source file which was not found.
 	void open_missing(Gtk::TextIter &, GdkEvent *, const std::string &fullpath);
-	/// Parses the GDB output for printable output and state changes of the target program.
-	void parse_target_state(mi_output *first_output, const int rank);
-	/// Searches for a breakpoint record in the GDB output.
-	void parse_breakpoint(mi_output *first_output, const int rank);
-	/// Searches for a stop record and extracts information from it.
-	void parse_stop_record(mi_output *first_output, const int rank);
+	/// Applies printable GDB output and state changes of the target program.
+	void apply_target_state(const GdbDelta &delta);
+	/// Stores the number of a created breakpoint.
+	void apply_breakpoint(const GdbDelta &delta);
+	/// Applies the information of a stop record.
+	void apply_stop_record(const GdbDelta &delta);
 	/// Checks how many slaves are connected.
 	bool wait_slaves_timeout(Gtk::MessageDialog *dialog);
 
@@ -227,7 +242,9 @@ class UIWindow
 
 public:
 	/// Default constructor.
-	UIWindow(const int num_processes, const int base_port);
+	UIWindow(const int num_processes, const int base_port,
+			 const std::size_t rank_budget, const std::size_t total_budget,
+			 const bool drop_overflow);
 	/// Destructor.
 	~UIWindow();
 
@@ -235,11 +252,22 @@ public:
 	bool init(Glib::RefPtr<Gtk::Application> app);
 	/// Closes the GDB TCP sockets and thus the slaves.
 	bool on_delete(GdkEventAny *);
-	/// Forwards the received data to the corresponding data handler.
-	void handle_data(const char *const data, const int port);
-	/// Writes data to the TCP socket.
-	bool send_data(asio::ip::tcp::socket *const socket,
-				   const std::string &data);
+	/// Appends received target output and scrolls its text view.
+	void handle_data(char *const data, const std::size_t length,
+					 const int port);
+	/// Queues received data for the GUI thread.
+	bool push_data(char *const data, const std::size_t length,
+				   const int port);
+	/// Takes a receive buffer for a TCP port from the buffer pool.
+	char *acquire_buffer(const int port);
+	/// Returns a receive buffer of a TCP port to the buffer pool.
+	void release_buffer(char *const buffer, const int port);
+	/// Deallocates a receive buffer no longer needed. (network thread)
+	void discard_buffer(char *const buffer);
+	/// Wakes up the reading threads paused by the ingest budget or queue.
+	void stop_ingest();
+	/// Queues data to be written to the TCP socket of a process.
+	bool send_data(const bool is_gdb, const int rank, const std::string &data);
 	/// Waits for the slaves to connect to the master.
 	bool wait_slaves();
 
@@ -293,19 +321,7 @@ public:
 	}
 
 	/// Sets the TCP socket associated to a process. (GDB)
-	/**
-	 * This function sets the TCP socket associated to a process, which is
-	 * connected to the socat instance, handling the communication with GDB.
-	 *
-	 * @param rank The process rank.
-	 *
-	 * @param[in] socket The TCP socket.
-	 */
-	inline void set_conns_gdb(const int rank,
-							  asio::ip::tcp::socket *const socket)
-	{
-		m_conns_gdb[rank] = socket;
-	}
+	void set_conns_gdb(const int rank, asio::ip::tcp::socket *const socket);
 
 	/// Gets the TCP socket associated to a process. (target)
 	/**
@@ -323,20 +339,7 @@ public:
 	}
 
 	/// Sets the TCP socket associated to a process. (target)
-	/**
-	 * This function sets the TCP socket associated to a process, which is
-	 * connected to the socat instance, handling the communication with the
-	 * target program.
-	 *
-	 * @param rank The process rank.
-	 *
-	 * @param[in] socket The TCP socket.
-	 */
-	inline void set_conns_trgt(const int rank,
-							   asio::ip::tcp::socket *const socket)
-	{
-		m_conns_trgt[rank] = socket;
-	}
+	void set_conns_trgt(const int rank, asio::ip::tcp::socket *const socket);
 
 	/// Stores a pointer to a Breakpoint object.
 	/**